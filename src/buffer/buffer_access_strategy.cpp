@@ -0,0 +1,42 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_access_strategy.cpp
+//
+// Identification: src/buffer/buffer_access_strategy.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/buffer_access_strategy.h"
+
+#include <algorithm>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+BufferAccessStrategy::BufferAccessStrategy(BufferAccessType type, size_t ring_size, size_t activation_threshold)
+    : type_(type), ring_size_(ring_size), activation_threshold_(activation_threshold) {
+  BUSTUB_ASSERT(ring_size > 0, "a ring needs at least one frame");
+}
+
+auto BufferAccessStrategy::Access(page_id_t page_id) -> bool {
+  if (page_id != last_page_id_) {
+    last_page_id_ = page_id;
+    pages_accessed_++;
+  }
+  return IsActive();
+}
+
+auto BufferAccessStrategy::GetRing(uint32_t instance_index, size_t pool_size) -> Ring & {
+  Ring &ring = rings_[instance_index];
+  if (ring.page_ids_.empty()) {
+    ring.page_ids_.resize(std::min(ring_size_, std::max<size_t>(1, pool_size / 8)), INVALID_PAGE_ID);
+  }
+  return ring;
+}
+
+}  // namespace bustub
@@ -12,29 +12,62 @@
 
 #include "buffer/buffer_pool_manager_instance.h"
 
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstring>
+#include <future>  // NOLINT
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "buffer/clock_replacer.h"
+#include "buffer/lru_k_replacer.h"
 #include "common/macros.h"
 
 namespace bustub {
 
 BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager,
-                                                     LogManager *log_manager)
-    : BufferPoolManagerInstance(pool_size, 1, 0, disk_manager, log_manager) {}
+                                                     LogManager *log_manager, ReplacerType replacer_type,
+                                                     size_t replacer_k, size_t max_pool_size)
+    : BufferPoolManagerInstance(pool_size, 1, 0, disk_manager, log_manager, replacer_type, replacer_k, max_pool_size) {
+}
 
 BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
-                                                     DiskManager *disk_manager, LogManager *log_manager)
+                                                     DiskManager *disk_manager, LogManager *log_manager,
+                                                     ReplacerType replacer_type, size_t replacer_k,
+                                                     size_t max_pool_size)
     : pool_size_(pool_size),
+      max_pool_size_(std::max(pool_size, max_pool_size != 0 ? max_pool_size : pool_size * BUFFER_POOL_MAX_GROWTH)),
       num_instances_(num_instances),
       instance_index_(instance_index),
-      next_page_id_(instance_index),
       disk_manager_(disk_manager),
-      log_manager_(log_manager) {
+      log_manager_(log_manager),
+      page_table_(max_pool_size_) {
   BUSTUB_ASSERT(num_instances > 0, "If BPI is not part of a pool, then the pool size should just be 1");
   BUSTUB_ASSERT(
       instance_index < num_instances,
       "BPI index cannot be greater than the number of BPIs in the pool. In non-parallel case, index should just be 1.");
-  // We allocate a consecutive memory space for the buffer pool.
-  pages_ = new Page[pool_size_];
-  replacer_ = new LRUReplacer(pool_size);
+  // We allocate a consecutive memory space for the buffer pool. Everything else is sized for the largest pool, so
+  // that growing only has to allocate pages.
+  blocks_.push_back(NewFrameBlock(0, pool_size_));
+  pages_ = blocks_.back().pages_;
+  frames_ = new std::atomic<Page *>[max_pool_size_];
+  for (size_t i = 0; i < max_pool_size_; ++i) {
+    frames_[i].store(i < pool_size_ ? &pages_[i] : nullptr, std::memory_order_relaxed);
+  }
+  io_cv_ = new std::condition_variable[max_pool_size_];
+  switch (replacer_type) {
+    case ReplacerType::LRU_K:
+      replacer_ = new LRUKReplacer(max_pool_size_, replacer_k);
+      break;
+    case ReplacerType::CLOCK:
+      replacer_ = new ClockReplacer(max_pool_size_);
+      break;
+    case ReplacerType::LRU:
+    default:
+      replacer_ = new LRUReplacer(max_pool_size_);
+      break;
+  }
 
   // Initially, every page is in the free list.
   for (size_t i = 0; i < pool_size_; ++i) {
@@ -43,76 +76,219 @@ BufferPoolManagerInstance::BufferPoolManagerInstance(size_t pool_size, uint32_t
 }
 
 BufferPoolManagerInstance::~BufferPoolManagerInstance() {
-  delete[] pages_;
+  StopBackgroundFlusher();
+  {
+    auto guard = AcquireLatch();
+    stop_prefetch_thread_ = true;
+    prefetch_cv_.notify_all();
+  }
+  if (prefetch_thread_ != nullptr) {
+    prefetch_thread_->join();
+    delete prefetch_thread_;
+  }
+  for (const auto &block : blocks_) {
+    DeleteFrameBlock(block);
+  }
+  delete[] frames_;
+  delete[] io_cv_;
   delete replacer_;
+  delete compressed_tier_;
+}
+
+void BufferPoolManagerInstance::StartBackgroundFlusher(double clean_target) {
+  BUSTUB_ASSERT(clean_target > 0 && clean_target <= 1, "clean target must be a fraction of the pool");
+  auto guard = AcquireLatch();
+  if (flush_thread_ != nullptr) {
+    return;
+  }
+  clean_target_ = clean_target;
+  stop_flush_thread_ = false;
+  flush_thread_ = new std::thread(&BufferPoolManagerInstance::BackgroundFlush, this);
+}
+
+void BufferPoolManagerInstance::EnableCompressedTier(size_t capacity) {
+  auto guard = AcquireLatch();
+  if (compressed_tier_ == nullptr) {
+    compressed_tier_ = new CompressedPageCache(capacity);
+  }
+}
+
+void BufferPoolManagerInstance::StopBackgroundFlusher() {
+  std::thread *flush_thread;
+  {
+    auto guard = AcquireLatch();
+    if (flush_thread_ == nullptr) {
+      return;
+    }
+    flush_thread = flush_thread_;
+    stop_flush_thread_ = true;
+    flush_cv_.notify_all();
+  }
+  flush_thread->join();
+  auto guard = AcquireLatch();
+  flush_thread_ = nullptr;
+  delete flush_thread;
 }
 
 auto BufferPoolManagerInstance::FlushPgImp(page_id_t page_id) -> bool {
   // Make sure you call DiskManager::WritePage!
 
-  latch_.lock();
-  if (page_table_.find(page_id) == page_table_.end()) {
-    latch_.unlock();
+  auto guard = AcquireLatch();
+  frame_id_t fid;
+  if (!page_table_.Find(page_id, &fid)) {
     return false;
   }
 
-  frame_id_t fid = page_table_[page_id];
+  // Pin the frame so that it cannot be evicted while the latch is dropped for the write.
+  Frame(fid).pin_count_++;
+  replacer_->Pin(fid);
+  WaitForIo(&guard, fid);
+  // An older image of the page that the background flusher is still writing must not land after this one.
+  WaitForWriteBack(&guard, page_id);
 
-  disk_manager_->WritePage(page_id, pages_[fid].GetData());
-  pages_[fid].is_dirty_ = false;
-  latch_.unlock();
+  Frame(fid).is_dirty_ = false;
+  guard.unlock();
+  disk_manager_->WritePage(page_id, Frame(fid).GetData());
+  DropPin(fid);
   return true;
 }
 
 void BufferPoolManagerInstance::FlushAllPgsImp() {
   // You can do it!
-  latch_.lock();
-  for (auto &it : page_table_) {
-    disk_manager_->WritePage(it.first, pages_[it.second].GetData());
-    pages_[it.second].is_dirty_ = false;
+  std::vector<std::pair<page_id_t, const char *>> pages;
+  std::vector<frame_id_t> dirty = CollectDirtyPages(&pages);
+  // One batch, so that adjacent pages go out together, and the pages are durable before the free page map that may
+  // mention them.
+  disk_manager_->WritePages(std::move(pages));
+  disk_manager_->FlushFreePageMap();
+  ReleaseFlushedPages(dirty);
+}
+
+auto BufferPoolManagerInstance::CollectDirtyPages(std::vector<std::pair<page_id_t, const char *>> *pages)
+    -> std::vector<frame_id_t> {
+  auto guard = AcquireLatch();
+  // Only dirty pages need writing. They are pinned behind the replacer's back, like the background flusher does, so
+  // that they cannot be evicted while the latch is dropped for the writes but keep their place in the eviction order.
+  // Claimed frames are being evicted, and their write-back is the eviction's business.
+  std::vector<frame_id_t> dirty;
+  for (size_t i = 0; i < pool_size_; ++i) {
+    Page &page = Frame(i);
+    if (page.page_id_ == INVALID_PAGE_ID || !page.is_dirty_ || page.pin_count_ < 0) {
+      continue;
+    }
+    page.pin_count_++;
+    dirty.push_back(i);
+  }
+
+  for (frame_id_t fid : dirty) {
+    Page &page = Frame(fid);
+    // An older image of the page that the background flusher is still writing must not land after this one.
+    WaitForIo(&guard, fid);
+    WaitForWriteBack(&guard, page.page_id_);
+    if (page.is_dirty_) {
+      page.is_dirty_ = false;
+      pages->emplace_back(page.page_id_, page.GetData());
+    }
   }
-  latch_.unlock();
+  return dirty;
 }
 
-auto BufferPoolManagerInstance::NewPgImp(page_id_t *page_id) -> Page * {
+void BufferPoolManagerInstance::ReleaseFlushedPages(const std::vector<frame_id_t> &frames) {
+  for (frame_id_t fid : frames) {
+    DropPin(fid);
+  }
+}
+
+auto BufferPoolManagerInstance::NewPgImp(page_id_t *page_id) -> Page * { return NewPageWithStrategy(page_id, nullptr); }
+
+auto BufferPoolManagerInstance::NewPageWithStrategy(page_id_t *page_id, BufferAccessStrategy *strategy,
+                                                    tablespace_id_t tablespace) -> Page * {
   // 0.   Make sure you call AllocatePage!
   // 1.   If all the pages in the buffer pool are pinned, return nullptr.
   // 2.   Pick a victim page P from either the free list or the replacer. Always pick from the free list first.
   // 3.   Update P's metadata, zero out memory and add P to the page table.
   // 4.   Set the page ID output parameter. Return a pointer to P.
 
-  latch_.lock();
-  *page_id = AllocatePage();
+  auto guard = AcquireLatch();
+  *page_id = AllocatePage(tablespace);
+  return NewPageLocked(*page_id, strategy, &guard);
+}
 
-  frame_id_t fid = INVALID_PAGE_ID;
-  if (!free_list_.empty()) {
-    // if the free list is not empty
-    fid = free_list_.front();
-    free_list_.pop_front();
-  } else if (replacer_->Victim(&fid)) {
-    // if there is no free frame, get one from the replacer
-    page_id_t pid = pages_[fid].page_id_;
-    if (pages_[fid].IsDirty()) {
-      disk_manager_->WritePage(pid, pages_[fid].GetData());
-    }
-    page_table_.erase(pid);
+auto BufferPoolManagerInstance::NewPageInExtent(page_id_t *page_id, Extent *extent, BufferAccessStrategy *strategy)
+    -> Page * {
+  if (num_instances_ != 1) {
+    return NewPageWithStrategy(page_id, strategy, extent->GetTablespace());
   }
+  *page_id = extent->NextPageId(disk_manager_);
+  return NewPageWithId(*page_id, strategy);
+}
 
-  if (fid != INVALID_PAGE_ID) {
-    pages_[fid].ResetMemory();
-    page_table_[*page_id] = fid;
-    pages_[fid].page_id_ = *page_id;
-    pages_[fid].pin_count_ = 1;
-    pages_[fid].is_dirty_ = false;
-    latch_.unlock();
-    return &pages_[fid];
+auto BufferPoolManagerInstance::NewPageWithId(page_id_t page_id, BufferAccessStrategy *strategy) -> Page * {
+  ValidatePageId(page_id);
+  auto guard = AcquireLatch();
+  return NewPageLocked(page_id, strategy, &guard);
+}
+
+auto BufferPoolManagerInstance::NewPageLocked(page_id_t page_id, BufferAccessStrategy *strategy,
+                                              std::unique_lock<std::mutex> *guard) -> Page * {
+  if (strategy != nullptr && !strategy->Access(page_id)) {
+    strategy = nullptr;
+  }
+  frame_id_t fid;
+  if (page_table_.Find(page_id, &fid)) {
+    // The pages of an extent count as allocated as soon as the extent is, so a scan may have read this one ahead
+    // before it was handed out. Take over that frame, so that the page is not in two frames at once.
+    Frame(fid).pin_count_++;
+    replacer_->Pin(fid);
+    WaitForIo(guard, fid);
+    Frame(fid).ResetMemory();
+    Frame(fid).is_dirty_ = false;
+    return &Frame(fid);
+  }
+  if (!AcquireFrame(&fid, strategy)) {
+    DeallocatePage(page_id);
+    num_no_free_frame_failures_.Add();
+    return nullptr;
+  }
+  page_id_t write_back_page_id = EvictFrame(fid);
+  if (strategy != nullptr) {
+    AddToRing(strategy, page_id);
+  }
+
+  // Everything about the new page must be in place before the pin count lets lock-free fetchers in.
+  Frame(fid).page_id_ = page_id;
+  Frame(fid).is_dirty_ = false;
+  if (write_back_page_id == INVALID_PAGE_ID) {
+    // Frames that were never written to are still zeroed from the arena.
+    if (!Frame(fid).is_zeroed_) {
+      Frame(fid).ResetMemory();
+    }
+  } else {
+    Frame(fid).io_in_progress_ = true;
+  }
+  Frame(fid).is_zeroed_ = false;
+  Frame(fid).pin_count_ = 1;
+  page_table_.Insert(page_id, fid);
+  replacer_->SetPageId(fid, page_id);
+  replacer_->Pin(fid);
+  if (write_back_page_id == INVALID_PAGE_ID) {
+    return &Frame(fid);
   }
 
-  latch_.unlock();
-  return nullptr;
+  // The victim must reach the disk before its frame is reused, but nobody else has to wait for that.
+  guard->unlock();
+  disk_manager_->WritePage(write_back_page_id, Frame(fid).GetData());
+  Frame(fid).ResetMemory();
+  RelockLatch(guard);
+  FinishIo(fid, write_back_page_id);
+  return &Frame(fid);
 }
 
 auto BufferPoolManagerInstance::FetchPgImp(page_id_t page_id) -> Page * {
+  return FetchPageWithStrategy(page_id, nullptr);
+}
+
+auto BufferPoolManagerInstance::FetchPageWithStrategy(page_id_t page_id, BufferAccessStrategy *strategy) -> Page * {
   // 1.     Search the page table for the requested page (P).
   // 1.1    If P exists, pin it and return it immediately.
   // 1.2    If P does not exist, find a replacement page (R) from either the free list or the replacer.
@@ -121,41 +297,105 @@ auto BufferPoolManagerInstance::FetchPgImp(page_id_t page_id) -> Page * {
   // 3.     Delete R from the page table and insert P.
   // 4.     Update P's metadata, read in the page content from disk, and then return a pointer to P.
 
-  latch_.lock();
-  if (page_table_.find(page_id) != page_table_.end()) {
-    // if already exists in the page table, update the pin count and return it
-    frame_id_t frame_id = page_table_[page_id];
-    replacer_->Pin(frame_id);
-    pages_[frame_id].pin_count_++;
-    latch_.unlock();
-    return &pages_[frame_id];
+  if (strategy != nullptr && !strategy->Access(page_id)) {
+    strategy = nullptr;
   }
 
-  frame_id_t frame_id = INVALID_PAGE_ID;
-  if (!free_list_.empty()) {
-    // if the free list is not empty
-    frame_id = *free_list_.begin();
-    free_list_.pop_front();
-  } else if (replacer_->Victim(&frame_id)) {
-    // if there is no free frame, get one from the replacer
-    page_id_t pid = pages_[frame_id].page_id_;
-    if (pages_[frame_id].IsDirty()) {
-      disk_manager_->WritePage(pid, pages_[frame_id].GetData());
+  // Hits never take the latch: pin the frame the page table points to, then check that it still holds P. Once pinned,
+  // the frame cannot be removed by Resize either.
+  frame_id_t frame_id;
+  optimistic_readers_.Enter();
+  bool pinned = page_table_.Find(page_id, &frame_id) && TryPin(frame_id);
+  optimistic_readers_.Exit();
+  if (pinned && CompleteHit(frame_id, page_id)) {
+    return &Frame(frame_id);
+  }
+
+  auto guard = AcquireLatch();
+  return FetchWithLatch(&guard, page_id, strategy);
+}
+
+auto BufferPoolManagerInstance::FetchWithLatch(std::unique_lock<std::mutex> *guard, page_id_t page_id,
+                                               BufferAccessStrategy *strategy) -> Page * {
+  frame_id_t frame_id;
+  while (true) {
+    if (page_table_.Find(page_id, &frame_id)) {
+      // if already exists in the page table, update the pin count and return it once any read in flight is done.
+      // Frames are only taken over under the latch, so a mapped frame is never claimed here.
+      Frame(frame_id).pin_count_++;
+      num_hits_.Add();
+      replacer_->Pin(frame_id);
+      WaitForIo(guard, frame_id);
+      return &Frame(frame_id);
     }
-    page_table_.erase(pid);
-  } else {
-    latch_.unlock();
+    if (write_back_table_.count(page_id) == 0) {
+      break;
+    }
+    // P was just evicted and is still being written back; reading it now would return stale data.
+    WaitForWriteBack(guard, page_id);
+  }
+
+  if (!AcquireFrame(&frame_id, strategy)) {
+    num_no_free_frame_failures_.Add();
     return nullptr;
   }
+  num_misses_.Add();
+  if (strategy != nullptr) {
+    AddToRing(strategy, page_id);
+  }
+  ReadPageIntoFrame(guard, frame_id, page_id, true);
+  return &Frame(frame_id);
+}
+
+auto BufferPoolManagerInstance::FetchPages(const std::vector<page_id_t> &page_ids) -> std::vector<Page *> {
+  std::vector<Page *> pages(page_ids.size(), nullptr);
+  std::vector<frame_id_t> frame_ids(page_ids.size(), -1);
+  optimistic_readers_.Enter();
+  for (size_t i = 0; i < page_ids.size(); ++i) {
+    frame_id_t frame_id;
+    if (page_table_.Find(page_ids[i], &frame_id) && TryPin(frame_id)) {
+      frame_ids[i] = frame_id;
+    }
+  }
+  optimistic_readers_.Exit();
+
+  bool missed = false;
+  for (size_t i = 0; i < page_ids.size(); ++i) {
+    if (frame_ids[i] != -1 && CompleteHit(frame_ids[i], page_ids[i])) {
+      pages[i] = &Frame(frame_ids[i]);
+    } else {
+      missed = true;
+    }
+  }
+  if (!missed) {
+    return pages;
+  }
 
-  page_table_[page_id] = frame_id;
-  pages_[frame_id].ResetMemory();
-  disk_manager_->ReadPage(page_id, pages_[frame_id].data_);
-  pages_[frame_id].page_id_ = page_id;
-  pages_[frame_id].pin_count_ = 1;
-  pages_[frame_id].is_dirty_ = false;
-  latch_.unlock();
-  return &pages_[frame_id];
+  auto guard = AcquireLatch();
+  for (size_t i = 0; i < page_ids.size(); ++i) {
+    if (pages[i] == nullptr) {
+      pages[i] = FetchWithLatch(&guard, page_ids[i], nullptr);
+    }
+  }
+  return pages;
+}
+
+auto BufferPoolManagerInstance::FetchPageWithHint(page_id_t page_id, frame_id_t *frame_id) -> Page * {
+  if (*frame_id >= 0 && static_cast<size_t>(*frame_id) < max_pool_size_) {
+    optimistic_readers_.Enter();
+    bool pinned = TryPin(*frame_id);
+    optimistic_readers_.Exit();
+    if (pinned && CompleteHit(*frame_id, page_id)) {
+      return &Frame(*frame_id);
+    }
+  }
+  Page *page = FetchPgImp(page_id);
+  // The pin keeps the page in its frame, so the page table cannot point elsewhere; it can only miss while an entry is
+  // being shifted, which merely loses the hint.
+  if (page == nullptr || !page_table_.Find(page_id, frame_id)) {
+    *frame_id = -1;
+  }
+  return page;
 }
 
 auto BufferPoolManagerInstance::DeletePgImp(page_id_t page_id) -> bool {
@@ -165,53 +405,794 @@ auto BufferPoolManagerInstance::DeletePgImp(page_id_t page_id) -> bool {
   // 2.   If P exists, but has a non-zero pin-count, return false. Someone is using the page.
   // 3.   Otherwise, P can be deleted. Remove P from the page table, reset its metadata and return it to the free list.
 
-  latch_.lock();
-  if (page_table_.find(page_id) == page_table_.end()) {
-    latch_.unlock();
+  auto guard = AcquireLatch();
+  // A page whose old image is still being written back would be overwritten by it if it were reused right away.
+  if (write_back_table_.count(page_id) != 0) {
+    return false;
+  }
+  frame_id_t fid;
+  if (compressed_tier_ != nullptr) {
+    compressed_tier_->Erase(page_id);
+  }
+  if (!page_table_.Find(page_id, &fid)) {
+    DeallocatePage(page_id);
     return true;
   }
-  frame_id_t fid = page_table_[page_id];
-  if (pages_[fid].pin_count_ != 0) {
-    latch_.unlock();
+  // Frames with I/O in flight are always pinned by the thread doing the I/O.
+  if (!ClaimFrame(fid)) {
     return false;
   }
   DeallocatePage(page_id);
-  pages_[fid].ResetMemory();
-  pages_[fid].page_id_ = INVALID_PAGE_ID;
-  pages_[fid].is_dirty_ = false;
-  pages_[fid].pin_count_ = 0;
-  free_list_.push_back(fid);
-  page_table_.erase(page_id);
+  page_table_.Remove(page_id);
   replacer_->Pin(fid);
-  latch_.unlock();
+  Frame(fid).ReleaseChildFrames();
+  Frame(fid).page_id_ = INVALID_PAGE_ID;
+  Frame(fid).is_dirty_ = false;
+  free_list_.push_back(fid);
   return true;
 }
 
 auto BufferPoolManagerInstance::UnpinPgImp(page_id_t page_id, bool is_dirty) -> bool {
-  latch_.lock();
-  if (page_table_.find(page_id) == page_table_.end()) {
-    latch_.unlock();
+  return ReleasePins(page_id, 1, is_dirty);
+}
+
+void BufferPoolManagerInstance::UnpinPages(const std::vector<page_id_t> &page_ids, bool is_dirty) {
+  // Sort a copy so that all the pins of a page come together and go in one step.
+  std::vector<page_id_t> sorted(page_ids);
+  std::sort(sorted.begin(), sorted.end());
+  for (size_t i = 0; i < sorted.size();) {
+    size_t end = i + 1;
+    while (end < sorted.size() && sorted[end] == sorted[i]) {
+      ++end;
+    }
+    ReleasePins(sorted[i], static_cast<int>(end - i), is_dirty);
+    i = end;
+  }
+}
+
+auto BufferPoolManagerInstance::ReleasePins(page_id_t page_id, int count, bool is_dirty) -> bool {
+  // The caller's pin keeps the page in its frame, so only the lookup can race, with an entry being shifted in the
+  // page table. Look again under the latch if it misses.
+  frame_id_t fid;
+  optimistic_readers_.Enter();
+  Page *page = page_table_.Find(page_id, &fid) ? frames_[fid].load() : nullptr;
+  if (page == nullptr || page->page_id_ != page_id) {
+    auto guard = AcquireLatch();
+    if (!page_table_.Find(page_id, &fid)) {
+      optimistic_readers_.Exit();
+      return false;
+    }
+    page = &Frame(fid);
+  }
+  // Mark the page dirty before the pin goes, so that whoever evicts it next sees the flag.
+  if (is_dirty) {
+    page->is_dirty_ = true;
+  }
+  int pins = page->pin_count_;
+  while (pins > 0) {
+    int remaining = std::max(pins - count, 0);
+    if (page->pin_count_.compare_exchange_weak(pins, remaining)) {
+      if (remaining == 0) {
+        replacer_->Unpin(fid);
+      }
+      break;
+    }
+  }
+  optimistic_readers_.Exit();
+  return true;
+}
+
+auto BufferPoolManagerInstance::TryPin(frame_id_t frame_id) -> bool {
+  // A stale page table entry may point at a frame that Resize has just removed.
+  Page *page = frames_[frame_id].load(std::memory_order_acquire);
+  if (page == nullptr) {
+    return false;
+  }
+  int pins = page->pin_count_;
+  while (pins >= 0) {
+    if (page->pin_count_.compare_exchange_weak(pins, pins + 1)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+auto BufferPoolManagerInstance::CompleteHit(frame_id_t frame_id, page_id_t page_id) -> bool {
+  if (Frame(frame_id).page_id_ != page_id) {
+    // The frame was handed to another page after the lookup, or freed. A free frame must not go into the replacer.
+    if (--Frame(frame_id).pin_count_ == 0 && Frame(frame_id).page_id_ != INVALID_PAGE_ID) {
+      replacer_->Unpin(frame_id);
+    }
+    return false;
+  }
+  num_hits_.Add();
+  replacer_->Pin(frame_id);
+  if (Frame(frame_id).io_in_progress_) {
+    // The page is still being read in; the pin keeps it here while we wait.
+    auto guard = AcquireLatch();
+    WaitForIo(&guard, frame_id);
+  }
+  return true;
+}
+
+void BufferPoolManagerInstance::DropPin(frame_id_t frame_id) {
+  if (--Frame(frame_id).pin_count_ == 0) {
+    replacer_->Unpin(frame_id);
+  }
+}
+
+auto BufferPoolManagerInstance::ClaimFrame(frame_id_t frame_id) -> bool {
+  int unpinned = 0;
+  return Frame(frame_id).pin_count_.compare_exchange_strong(unpinned, -1);
+}
+
+auto BufferPoolManagerInstance::AcquireFrame(frame_id_t *frame_id, BufferAccessStrategy *strategy) -> bool {
+  if (strategy != nullptr && AcquireRingFrame(strategy, frame_id)) {
+    return true;
+  }
+  if (!free_list_.empty()) {
+    *frame_id = free_list_.front();
+    free_list_.pop_front();
+    return true;
+  }
+  auto is_clean = [&](frame_id_t fid) { return !Frame(fid).is_dirty_; };
+  while (flush_thread_ == nullptr ? replacer_->Victim(frame_id)
+                                  : replacer_->VictimPreferring(frame_id, is_clean, CleanWindow())) {
+    // Lock-free fetchers and the background flusher pin frames without taking them out of the replacer first. Such
+    // a frame goes back into the replacer with its last unpin, which may come after Shrink has removed the frame.
+    if (static_cast<size_t>(*frame_id) >= pool_size_ || !ClaimFrame(*frame_id)) {
+      continue;
+    }
+    if (flush_thread_ != nullptr && Frame(*frame_id).is_dirty_) {
+      // The flusher is falling behind.
+      flush_requested_ = true;
+      flush_cv_.notify_one();
+    }
+    return true;
+  }
+  return false;
+}
+
+auto BufferPoolManagerInstance::AcquireRingFrame(BufferAccessStrategy *strategy, frame_id_t *frame_id) -> bool {
+  BufferAccessStrategy::Ring &ring = strategy->GetRing(instance_index_, pool_size_);
+  for (size_t i = 0; i < ring.page_ids_.size(); ++i) {
+    size_t slot = (ring.current_ + i) % ring.page_ids_.size();
+    page_id_t page_id = ring.page_ids_[slot];
+    frame_id_t fid;
+    if (page_id == INVALID_PAGE_ID || !page_table_.Find(page_id, &fid)) {
+      ring.current_ = slot;
+      return false;
+    }
+    if (!ClaimFrame(fid)) {
+      continue;
+    }
+    // Pages that someone else is using stay in the shared pool. A bulk read does not write back on anyone's behalf
+    // either: a page dirtied since it was read is evidently in use.
+    if (Frame(fid).is_dirty_ && strategy->GetType() == BufferAccessType::BULK_READ) {
+      Frame(fid).pin_count_ = 0;
+      continue;
+    }
+    ring.current_ = slot;
+    *frame_id = fid;
+    replacer_->Pin(fid);
+    return true;
+  }
+  return false;
+}
+
+void BufferPoolManagerInstance::AddToRing(BufferAccessStrategy *strategy, page_id_t page_id) {
+  BufferAccessStrategy::Ring &ring = strategy->GetRing(instance_index_, pool_size_);
+  ring.page_ids_[ring.current_] = page_id;
+  ring.current_ = (ring.current_ + 1) % ring.page_ids_.size();
+}
+
+auto BufferPoolManagerInstance::EvictFrame(frame_id_t frame_id) -> page_id_t {
+  page_id_t victim_page_id = Frame(frame_id).page_id_;
+  // Hints about where the victim's children live mean nothing to the next page.
+  Frame(frame_id).ReleaseChildFrames();
+  if (victim_page_id == INVALID_PAGE_ID) {
+    return INVALID_PAGE_ID;
+  }
+  page_table_.Remove(victim_page_id);
+  num_evictions_.Add();
+  // The tier is filled under the latch, so that it can never take a copy of a page that was read back in meanwhile.
+  if (!Frame(frame_id).IsDirty()) {
+    if (compressed_tier_ != nullptr) {
+      compressed_tier_->Insert(victim_page_id, Frame(frame_id).GetData());
+    }
+    return INVALID_PAGE_ID;
+  }
+  if (compressed_tier_ != nullptr) {
+    compressed_tier_->Erase(victim_page_id);
+  }
+  num_dirty_write_backs_.Add();
+  write_back_table_[victim_page_id] = frame_id;
+  return victim_page_id;
+}
+
+void BufferPoolManagerInstance::ReadPageIntoFrame(std::unique_lock<std::mutex> *guard, frame_id_t frame_id,
+                                                  page_id_t page_id, bool record_access) {
+  page_id_t write_back_page_id = PublishFrame(frame_id, page_id, record_access);
+  guard->unlock();
+
+  if (write_back_page_id != INVALID_PAGE_ID) {
+    disk_manager_->WritePage(write_back_page_id, Frame(frame_id).GetData());
+  }
+  // The read overwrites the whole frame, so there is no need to clear it first.
+  LoadPage(page_id, frame_id);
+
+  RelockLatch(guard);
+  FinishIo(frame_id, write_back_page_id);
+}
+
+auto BufferPoolManagerInstance::PublishFrame(frame_id_t frame_id, page_id_t page_id, bool record_access)
+    -> page_id_t {
+  page_id_t write_back_page_id = EvictFrame(frame_id);
+
+  // Publish the page before reading it, so that concurrent fetchers wait on this frame instead of reading it twice.
+  // The pin count goes last: it is what lets lock-free fetchers in.
+  Frame(frame_id).page_id_ = page_id;
+  Frame(frame_id).is_dirty_ = false;
+  Frame(frame_id).is_zeroed_ = false;
+  Frame(frame_id).io_in_progress_ = true;
+  Frame(frame_id).pin_count_ = 1;
+  page_table_.Insert(page_id, frame_id);
+  replacer_->SetPageId(frame_id, page_id);
+  if (record_access) {
+    replacer_->Pin(frame_id);
+  }
+  return write_back_page_id;
+}
+
+auto BufferPoolManagerInstance::GetStats() -> BufferPoolStats {
+  BufferPoolStats stats;
+  stats.hits_ = num_hits_.Get();
+  stats.misses_ = num_misses_.Get();
+  stats.evictions_ = num_evictions_.Get();
+  stats.dirty_write_backs_ = num_dirty_write_backs_.Get();
+  stats.no_free_frame_failures_ = num_no_free_frame_failures_.Get();
+  stats.replacer_victims_ = replacer_->GetNumVictims();
+  stats.latch_wait_ns_ = latch_wait_ns_.Get();
+  stats.disk_read_ns_ = disk_read_ns_.Get();
+  if (compressed_tier_ != nullptr) {
+    compressed_tier_->CollectStats(&stats);
+  }
+  return stats;
+}
+
+auto BufferPoolManagerInstance::Resize(size_t pool_size) -> bool {
+  if (pool_size == 0 || pool_size > max_pool_size_) {
     return false;
   }
-  frame_id_t fid = page_table_[page_id];
-  if (pages_[fid].pin_count_ > 0) {
-    pages_[fid].pin_count_--;
+  std::scoped_lock resize_guard(resize_latch_);
+  if (pool_size > pool_size_) {
+    Grow(pool_size);
+    return true;
+  }
+  return pool_size == pool_size_ || Shrink(pool_size);
+}
+
+void BufferPoolManagerInstance::Grow(size_t pool_size) {
+  // Frames of a block that a shrink left partly in use get their old pages back; the rest get a new block, allocated
+  // before taking the latch.
+  size_t first_new_frame = pool_size_;
+  for (const auto &block : blocks_) {
+    if (block.first_frame_ <= first_new_frame && first_new_frame < block.first_frame_ + block.num_frames_) {
+      first_new_frame = std::min(pool_size, block.first_frame_ + block.num_frames_);
+    }
+  }
+  if (first_new_frame < pool_size) {
+    blocks_.push_back(NewFrameBlock(first_new_frame, pool_size - first_new_frame));
+  }
+
+  auto guard = AcquireLatch();
+  for (const auto &block : blocks_) {
+    for (size_t i = std::max(block.first_frame_, pool_size_.load());
+         i < std::min(pool_size, block.first_frame_ + block.num_frames_); ++i) {
+      frames_[i].store(&block.pages_[i - block.first_frame_], std::memory_order_release);
+      free_list_.emplace_back(static_cast<frame_id_t>(i));
+    }
+  }
+  pool_size_ = pool_size;
+}
+
+auto BufferPoolManagerInstance::Shrink(size_t pool_size) -> bool {
+  auto guard = AcquireLatch();
+  // Claim the frames to be removed, so that nobody can pin them any more. A frame with I/O in flight is pinned by the
+  // thread doing it. Free frames need no claim: whether never used or freed, they hold no page and sit at -1, and
+  // TryPin only pins frames at 0 or above, so a lock-free fetcher following a stale page table entry cannot pin them.
+  std::vector<frame_id_t> claimed;
+  for (size_t i = pool_size; i < pool_size_; ++i) {
+    auto fid = static_cast<frame_id_t>(i);
+    if (Frame(fid).page_id_ == INVALID_PAGE_ID && Frame(fid).pin_count_ == -1) {
+      continue;
+    }
+    if (!ClaimFrame(fid)) {
+      for (frame_id_t claimed_fid : claimed) {
+        Frame(claimed_fid).pin_count_ = 0;
+      }
+      return false;
+    }
+    claimed.push_back(fid);
+  }
+  free_list_.remove_if([&](frame_id_t fid) { return static_cast<size_t>(fid) >= pool_size; });
+  pool_size_ = pool_size;
+
+  // Evict the pages like a miss would, and write back the dirty ones with the latch released.
+  std::vector<std::pair<frame_id_t, page_id_t>> write_backs;
+  for (frame_id_t fid : claimed) {
+    replacer_->Pin(fid);
+    page_id_t write_back_page_id = EvictFrame(fid);
+    if (write_back_page_id != INVALID_PAGE_ID) {
+      // Fetchers of the page wait on the frame until it is written back.
+      Frame(fid).io_in_progress_ = true;
+      write_backs.emplace_back(fid, write_back_page_id);
+    }
+  }
+  if (!write_backs.empty()) {
+    guard.unlock();
+    for (const auto &[fid, page_id] : write_backs) {
+      disk_manager_->WritePage(page_id, Frame(fid).GetData());
+    }
+    RelockLatch(&guard);
+    for (const auto &[fid, page_id] : write_backs) {
+      FinishIo(fid, page_id);
+    }
+  }
+  for (size_t i = pool_size; i < max_pool_size_; ++i) {
+    Page *page = frames_[i].load(std::memory_order_relaxed);
+    if (page != nullptr) {
+      page->page_id_ = INVALID_PAGE_ID;
+      page->is_dirty_ = false;
+      frames_[i].store(nullptr, std::memory_order_release);
+    }
   }
-  pages_[fid].is_dirty_ = is_dirty || pages_[fid].is_dirty_;
-  if (pages_[fid].pin_count_ == 0) {
-    replacer_->Unpin(fid);
+  guard.unlock();
+
+  // Lock-free fetchers that looked up a removed page just before it was unmapped may still be about to touch its
+  // frame. Once they are done, the blocks beyond the new size can go.
+  optimistic_readers_.WaitForReaders();
+  auto retired = std::partition(blocks_.begin(), blocks_.end(),
+                                [&](const FrameBlock &block) { return block.first_frame_ < pool_size; });
+  for (auto it = retired; it != blocks_.end(); ++it) {
+    DeleteFrameBlock(*it);
   }
-  latch_.unlock();
+  blocks_.erase(retired, blocks_.end());
   return true;
 }
 
-auto BufferPoolManagerInstance::AllocatePage() -> page_id_t {
-  const page_id_t next_page_id = next_page_id_;
-  next_page_id_ += num_instances_;
-  ValidatePageId(next_page_id);
-  return next_page_id;
+auto BufferPoolManagerInstance::NewFrameBlock(size_t first_frame, size_t num_frames) -> FrameBlock {
+  auto *arena = new FrameArena(num_frames);
+  auto *pages = new Page[num_frames];
+  for (size_t i = 0; i < num_frames; ++i) {
+    pages[i].data_ = arena->GetFrame(i);
+    pages[i].is_zeroed_ = true;
+  }
+  return {first_frame, num_frames, pages, arena};
+}
+
+void BufferPoolManagerInstance::DeleteFrameBlock(const FrameBlock &block) {
+  delete[] block.pages_;
+  delete block.arena_;
 }
 
+/** @return true if the page is in one of the tablespaces */
+static auto InTablespaces(page_id_t page_id, const std::vector<tablespace_id_t> &tablespaces) -> bool {
+  return page_id != INVALID_PAGE_ID &&
+         std::find(tablespaces.begin(), tablespaces.end(), DiskManager::TablespaceOf(page_id)) != tablespaces.end();
+}
+
+auto BufferPoolManagerInstance::DropTablespaces(const std::vector<tablespace_id_t> &tablespaces) -> bool {
+  for (tablespace_id_t tablespace : tablespaces) {
+    if (tablespace == DEFAULT_TABLESPACE || !disk_manager_->HasTablespace(tablespace)) {
+      throw Exception("can't drop tablespace " + std::to_string(tablespace));
+    }
+  }
+  std::vector<frame_id_t> claimed;
+  if (!ClaimTablespaceFrames(tablespaces, &claimed)) {
+    return false;
+  }
+  DiscardTablespaceFrames(tablespaces, claimed);
+  for (tablespace_id_t tablespace : tablespaces) {
+    disk_manager_->DropTablespace(tablespace);
+  }
+  return true;
+}
+
+auto BufferPoolManagerInstance::ClaimTablespaceFrames(const std::vector<tablespace_id_t> &tablespaces,
+                                                      std::vector<frame_id_t> *claimed) -> bool {
+  auto guard = AcquireLatch();
+  // A write-back that is still in flight would land in the file after it is gone.
+  for (auto wb = write_back_table_.begin(); wb != write_back_table_.end();) {
+    if (InTablespaces(wb->first, tablespaces)) {
+      WaitForWriteBack(&guard, wb->first);
+      wb = write_back_table_.begin();
+    } else {
+      ++wb;
+    }
+  }
+
+  // Frames with I/O in flight are pinned by the thread doing the I/O, so claiming a frame also waits out its reads.
+  claimed->clear();
+  for (size_t i = 0; i < pool_size_; ++i) {
+    auto fid = static_cast<frame_id_t>(i);
+    if (!InTablespaces(Frame(fid).page_id_, tablespaces)) {
+      continue;
+    }
+    if (!ClaimFrame(fid)) {
+      for (frame_id_t undo : *claimed) {
+        Frame(undo).pin_count_ = 0;
+      }
+      claimed->clear();
+      return false;
+    }
+    claimed->push_back(fid);
+  }
+  return true;
+}
+
+void BufferPoolManagerInstance::UnclaimTablespaceFrames(const std::vector<frame_id_t> &claimed) {
+  auto guard = AcquireLatch();
+  for (frame_id_t fid : claimed) {
+    Frame(fid).pin_count_ = 0;
+  }
+}
+
+void BufferPoolManagerInstance::DiscardTablespaceFrames(const std::vector<tablespace_id_t> &tablespaces,
+                                                        const std::vector<frame_id_t> &claimed) {
+  auto in_tablespaces = [&](page_id_t page_id) { return InTablespaces(page_id, tablespaces); };
+  auto guard = AcquireLatch();
+  // The tier holds evicted pages only, none of which are in the frames.
+  if (compressed_tier_ != nullptr) {
+    for (tablespace_id_t tablespace : tablespaces) {
+      compressed_tier_->EraseTablespace(tablespace);
+    }
+  }
+  for (frame_id_t fid : claimed) {
+    page_table_.Remove(Frame(fid).page_id_);
+    replacer_->Pin(fid);
+    Frame(fid).ReleaseChildFrames();
+    Frame(fid).page_id_ = INVALID_PAGE_ID;
+    Frame(fid).is_dirty_ = false;
+    free_list_.push_back(fid);
+  }
+  prefetch_queue_.erase(std::remove_if(prefetch_queue_.begin(), prefetch_queue_.end(), in_tablespaces),
+                        prefetch_queue_.end());
+}
+
+auto BufferPoolManagerInstance::GetResidentPages() -> std::vector<page_id_t> {
+  auto guard = AcquireLatch();
+  std::vector<page_id_t> page_ids;
+  std::vector<bool> listed(pool_size_, false);
+  for (frame_id_t fid : replacer_->Candidates(pool_size_)) {
+    page_ids.push_back(Frame(fid).page_id_);
+    listed[fid] = true;
+  }
+  // Whatever the replacer does not list is pinned, so it is as hot as it gets.
+  for (size_t i = 0; i < pool_size_; ++i) {
+    if (!listed[i] && Frame(i).page_id_ != INVALID_PAGE_ID) {
+      page_ids.push_back(Frame(i).page_id_);
+    }
+  }
+  return page_ids;
+}
+
+auto BufferPoolManagerInstance::WarmUp(const std::vector<page_id_t> &page_ids) -> size_t {
+  auto guard = AcquireLatch();
+  std::vector<page_id_t> wanted;
+  std::unordered_set<page_id_t> seen;
+  for (auto it = page_ids.rbegin(); it != page_ids.rend() && wanted.size() < free_list_.size(); ++it) {
+    frame_id_t fid;
+    if (static_cast<uint32_t>(*it) % num_instances_ == instance_index_ && seen.insert(*it).second &&
+        !page_table_.Find(*it, &fid) && disk_manager_->IsAllocated(*it)) {
+      wanted.push_back(*it);
+    }
+  }
+  std::reverse(wanted.begin(), wanted.end());
+
+  // Publish every page before reading any, like ReadPageIntoFrame does, so that early fetchers wait for the read.
+  std::vector<std::pair<page_id_t, frame_id_t>> batch;
+  for (page_id_t page_id : wanted) {
+    frame_id_t fid = free_list_.front();
+    free_list_.pop_front();
+    Frame(fid).page_id_ = page_id;
+    Frame(fid).is_dirty_ = false;
+    Frame(fid).is_zeroed_ = false;
+    Frame(fid).io_in_progress_ = true;
+    Frame(fid).pin_count_ = 1;
+    page_table_.Insert(page_id, fid);
+    replacer_->SetPageId(fid, page_id);
+    batch.emplace_back(page_id, fid);
+  }
+  guard.unlock();
+
+  LoadPages(batch);
+
+  // Unpinning coldest first leaves the replacer with the order the pages were listed in.
+  RelockLatch(&guard);
+  for (const auto &[page_id, fid] : batch) {
+    FinishIo(fid, INVALID_PAGE_ID);
+  }
+  guard.unlock();
+  for (const auto &[page_id, fid] : batch) {
+    DropPin(fid);
+  }
+  return batch.size();
+}
+
+void BufferPoolManagerInstance::DumpResidentSet() { disk_manager_->WriteWarmUpList(GetResidentPages()); }
+
+auto BufferPoolManagerInstance::LoadResidentSet() -> size_t { return WarmUp(disk_manager_->ReadWarmUpList()); }
+
+auto BufferPoolManagerInstance::AcquireLatch() -> std::unique_lock<std::mutex> {
+  std::unique_lock<std::mutex> guard(latch_, std::defer_lock);
+  RelockLatch(&guard);
+  return guard;
+}
+
+void BufferPoolManagerInstance::RelockLatch(std::unique_lock<std::mutex> *guard) {
+  // Only a contended latch is timed, so that the common case does not read the clock.
+  if (guard->try_lock()) {
+    return;
+  }
+  auto wait_start = std::chrono::steady_clock::now();
+  guard->lock();
+  latch_wait_ns_.Add(ElapsedNs(wait_start));
+}
+
+void BufferPoolManagerInstance::LoadPage(page_id_t page_id, frame_id_t frame_id) {
+  if (compressed_tier_ != nullptr && compressed_tier_->Take(page_id, Frame(frame_id).data_)) {
+    return;
+  }
+  auto read_start = std::chrono::steady_clock::now();
+  disk_manager_->ReadPage(page_id, Frame(frame_id).data_);
+  disk_read_ns_.Add(ElapsedNs(read_start));
+}
+
+void BufferPoolManagerInstance::LoadPages(const std::vector<std::pair<page_id_t, frame_id_t>> &pages) {
+  std::vector<std::pair<page_id_t, char *>> from_disk;
+  for (const auto &[page_id, frame_id] : pages) {
+    if (compressed_tier_ == nullptr || !compressed_tier_->Take(page_id, Frame(frame_id).data_)) {
+      from_disk.emplace_back(page_id, Frame(frame_id).data_);
+    }
+  }
+  if (from_disk.empty()) {
+    return;
+  }
+  auto read_start = std::chrono::steady_clock::now();
+  if (num_instances_ == 1) {
+    disk_manager_->ReadPages(std::move(from_disk));
+  } else {
+    std::vector<std::future<void>> reads;
+    reads.reserve(from_disk.size());
+    for (const auto &[page_id, data] : from_disk) {
+      reads.push_back(disk_manager_->ReadPageAsync(page_id, data));
+    }
+    for (auto &read : reads) {
+      read.wait();
+    }
+  }
+  disk_read_ns_.Add(ElapsedNs(read_start));
+}
+
+auto BufferPoolManagerInstance::ElapsedNs(std::chrono::steady_clock::time_point start) -> uint64_t {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+void BufferPoolManagerInstance::PrefetchPages(const std::vector<page_id_t> &page_ids, BufferAccessStrategy *strategy) {
+  if (strategy != nullptr && !strategy->IsActive()) {
+    strategy = nullptr;
+  }
+  auto guard = AcquireLatch();
+  // The ring is taken here rather than by the prefetch thread, since the strategy belongs to the calling operation.
+  size_t ring_reads = 0;
+  size_t max_ring_reads = 0;
+  if (strategy != nullptr) {
+    // Leave the operation a frame of the ring for its own next miss, or that miss would evict a page of the shared
+    // pool.
+    for (page_id_t ring_page_id : strategy->GetRing(instance_index_, pool_size_).page_ids_) {
+      frame_id_t frame_id;
+      if (ring_page_id == INVALID_PAGE_ID || !page_table_.Find(ring_page_id, &frame_id) ||
+          Frame(frame_id).pin_count_ == 0) {
+        max_ring_reads++;
+      }
+    }
+    max_ring_reads = std::max<size_t>(max_ring_reads, 1) - 1;
+  }
+  for (page_id_t page_id : page_ids) {
+    if (prefetch_queue_.size() + prefetch_ring_reads_.size() >= pool_size_ ||
+        (strategy != nullptr && ring_reads >= max_ring_reads)) {
+      break;
+    }
+    frame_id_t frame_id;
+    if (static_cast<uint32_t>(page_id) % num_instances_ != instance_index_ || page_table_.Find(page_id, &frame_id) ||
+        !disk_manager_->IsAllocated(page_id)) {
+      continue;
+    }
+    if (strategy == nullptr) {
+      prefetch_queue_.push_back(page_id);
+      continue;
+    }
+    if (write_back_table_.count(page_id) != 0) {
+      continue;
+    }
+    // A read ahead is only a hint. It may grow the ring from the shared pool, but once the ring is full it stops while
+    // all the frames of the ring are in use, rather than evict a page of the shared pool.
+    if (!AcquireRingFrame(strategy, &frame_id)) {
+      BufferAccessStrategy::Ring &ring = strategy->GetRing(instance_index_, pool_size_);
+      page_id_t slot_page_id = ring.page_ids_[ring.current_];
+      frame_id_t slot_frame_id;
+      if ((slot_page_id != INVALID_PAGE_ID && page_table_.Find(slot_page_id, &slot_frame_id)) ||
+          !AcquireFrame(&frame_id)) {
+        break;
+      }
+    }
+    AddToRing(strategy, page_id);
+    prefetch_ring_reads_.push_back({page_id, frame_id, PublishFrame(frame_id, page_id, false)});
+    ring_reads++;
+  }
+  if (prefetch_queue_.empty() && prefetch_ring_reads_.empty()) {
+    return;
+  }
+  if (prefetch_thread_ == nullptr) {
+    prefetch_thread_ = new std::thread(&BufferPoolManagerInstance::Prefetch, this);
+  }
+  prefetch_cv_.notify_one();
+}
+
+void BufferPoolManagerInstance::Prefetch() {
+  auto guard = AcquireLatch();
+  while (true) {
+    prefetch_cv_.wait(guard, [&] {
+      return stop_prefetch_thread_ || !prefetch_queue_.empty() || !prefetch_ring_reads_.empty();
+    });
+    // Ring reads have their frames published already, and may have to write back a victim.
+    if (stop_prefetch_thread_ && prefetch_ring_reads_.empty()) {
+      return;
+    }
+    // A batch keeps its frames pinned until all of its reads are done, so it may only take a part of the pool.
+    size_t max_batch = std::min<size_t>(IO_QUEUE_DEPTH, std::max<size_t>(1, pool_size_ / 4));
+    std::vector<PrefetchRead> batch;
+    batch.swap(prefetch_ring_reads_);
+    while (!stop_prefetch_thread_ && !prefetch_queue_.empty() && batch.size() < max_batch) {
+      page_id_t page_id = prefetch_queue_.front();
+      prefetch_queue_.pop_front();
+      // The page may have been fetched since it was queued. If it is being written back it was resident very
+      // recently, and reading it ahead is not worth waiting for the write.
+      frame_id_t frame_id;
+      if (page_table_.Find(page_id, &frame_id) || write_back_table_.count(page_id) != 0) {
+        continue;
+      }
+      if (!AcquireFrame(&frame_id)) {
+        continue;
+      }
+      batch.push_back({page_id, frame_id, PublishFrame(frame_id, page_id, false)});
+    }
+    if (batch.empty()) {
+      continue;
+    }
+    guard.unlock();
+
+    std::vector<std::future<void>> write_backs;
+    for (const auto &read : batch) {
+      if (read.write_back_page_id_ != INVALID_PAGE_ID) {
+        write_backs.push_back(
+            disk_manager_->WritePageAsync(read.write_back_page_id_, Frame(read.frame_id_).GetData()));
+      }
+    }
+    for (auto &write_back : write_backs) {
+      write_back.wait();
+    }
+    std::vector<std::pair<page_id_t, frame_id_t>> reads;
+    reads.reserve(batch.size());
+    for (const auto &read : batch) {
+      reads.emplace_back(read.page_id_, read.frame_id_);
+    }
+    LoadPages(reads);
+
+    RelockLatch(&guard);
+    for (const auto &read : batch) {
+      FinishIo(read.frame_id_, read.write_back_page_id_);
+      DropPin(read.frame_id_);
+    }
+  }
+}
+
+void BufferPoolManagerInstance::WaitForIo(std::unique_lock<std::mutex> *guard, frame_id_t frame_id) {
+  io_cv_[frame_id].wait(*guard, [&] { return !Frame(frame_id).io_in_progress_; });
+}
+
+void BufferPoolManagerInstance::WaitForWriteBack(std::unique_lock<std::mutex> *guard, page_id_t page_id) {
+  for (auto wb = write_back_table_.find(page_id); wb != write_back_table_.end(); wb = write_back_table_.find(page_id)) {
+    frame_id_t frame_id = wb->second;
+    io_cv_[frame_id].wait(*guard, [&] {
+      auto cur = write_back_table_.find(page_id);
+      return cur == write_back_table_.end() || cur->second != frame_id;
+    });
+  }
+}
+
+void BufferPoolManagerInstance::FinishIo(frame_id_t frame_id, page_id_t write_back_page_id) {
+  if (write_back_page_id != INVALID_PAGE_ID) {
+    write_back_table_.erase(write_back_page_id);
+  }
+  Frame(frame_id).io_in_progress_ = false;
+  io_cv_[frame_id].notify_all();
+}
+
+auto BufferPoolManagerInstance::CleanWindow() const -> size_t {
+  return std::max<size_t>(1, static_cast<size_t>(clean_target_ * pool_size_));
+}
+
+void BufferPoolManagerInstance::BackgroundFlush() {
+  auto guard = AcquireLatch();
+  while (!stop_flush_thread_) {
+    flush_cv_.wait_for(guard, background_flush_interval, [&] { return stop_flush_thread_ || flush_requested_; });
+    flush_requested_ = false;
+    if (!stop_flush_thread_) {
+      FlushEvictionCandidates(&guard);
+    }
+  }
+}
+
+void BufferPoolManagerInstance::FlushEvictionCandidates(std::unique_lock<std::mutex> *guard) {
+  size_t window = CleanWindow();
+  if (free_list_.size() >= window) {
+    return;
+  }
+  std::vector<std::pair<frame_id_t, page_id_t>> batch;
+  for (frame_id_t fid : replacer_->Candidates(window - free_list_.size())) {
+    if (static_cast<size_t>(fid) >= pool_size_) {
+      continue;
+    }
+    Page &page = Frame(fid);
+    int unpinned = 0;
+    if (!page.is_dirty_ || !page.pin_count_.compare_exchange_strong(unpinned, 1)) {
+      continue;
+    }
+    page.is_dirty_ = false;
+    // Registered like an eviction write-back, so that the synchronous flushes wait for it instead of being overtaken.
+    write_back_table_[page.page_id_] = fid;
+    batch.emplace_back(fid, page.page_id_);
+  }
+  if (batch.empty()) {
+    return;
+  }
+
+  guard->unlock();
+  // Whoever pins a page meanwhile may be writing to it, so each page is copied under its read latch and written from
+  // the copy. That way no latch is held across the I/O, and all the writes of the batch can be in flight together.
+  // The copies are page-aligned like the frames, so that direct I/O can write them as they are.
+  FrameArena images(batch.size());
+  std::vector<std::future<void>> writes;
+  writes.reserve(batch.size());
+  for (size_t i = 0; i < batch.size(); ++i) {
+    const auto &[fid, page_id] = batch[i];
+    char *image = images.GetFrame(i);
+    Frame(fid).RLatch();
+    memcpy(image, Frame(fid).GetData(), PAGE_SIZE);
+    Frame(fid).RUnlatch();
+    writes.push_back(disk_manager_->WritePageAsync(page_id, image));
+  }
+  for (auto &write : writes) {
+    write.wait();
+  }
+  RelockLatch(guard);
+
+  for (const auto &[fid, page_id] : batch) {
+    FinishIo(fid, page_id);
+    DropPin(fid);
+  }
+}
+
+auto BufferPoolManagerInstance::AllocatePage(tablespace_id_t tablespace) -> page_id_t {
+  const page_id_t page_id = disk_manager_->AllocatePage(num_instances_, instance_index_, tablespace);
+  ValidatePageId(page_id);
+  return page_id;
+}
+
+void BufferPoolManagerInstance::DeallocatePage(page_id_t page_id) { disk_manager_->DeallocatePage(page_id); }
+
 void BufferPoolManagerInstance::ValidatePageId(const page_id_t page_id) const {
   assert(page_id % num_instances_ == instance_index_);  // allocated pages mod back to this BPI
 }
@@ -14,16 +14,100 @@
 
 namespace bustub {
 
-ClockReplacer::ClockReplacer(size_t num_pages) {}
+ClockReplacer::ClockReplacer(size_t num_pages) : num_pages_(num_pages), ref_(num_pages), evictable_(num_pages) {}
 
 ClockReplacer::~ClockReplacer() = default;
 
-auto ClockReplacer::Victim(frame_id_t *frame_id) -> bool { return false; }
+auto ClockReplacer::Victim(frame_id_t *frame_id) -> bool {
+  std::scoped_lock guard(hand_latch_);
+  // Two full turns are enough: the first clears every reference bit, the second finds a frame without one. Frames
+  // pinned concurrently may make us come back empty-handed, which the caller treats like a full pool.
+  for (size_t step = 0; step < 2 * num_pages_ && size_.load() > 0; ++step) {
+    size_t frame = hand_;
+    hand_ = (hand_ + 1) % num_pages_;
+    if (!evictable_[frame].load()) {
+      continue;
+    }
+    if (ref_[frame].exchange(false)) {
+      continue;
+    }
+    if (evictable_[frame].exchange(false)) {
+      size_--;
+      *frame_id = static_cast<frame_id_t>(frame);
+      return CountVictim(true);
+    }
+  }
+  return CountVictim(false);
+}
 
-void ClockReplacer::Pin(frame_id_t frame_id) {}
+auto ClockReplacer::VictimPreferring(frame_id_t *frame_id, const std::function<bool(frame_id_t)> &prefer,
+                                     size_t window) -> bool {
+  std::scoped_lock guard(hand_latch_);
+  // Sweep as Victim does, but pass over up to window frames that are ready for eviction and not preferred. The first
+  // of them is taken if no preferred frame shows up in time.
+  size_t skipped = 0;
+  size_t fallback = num_pages_;
+  for (size_t step = 0; step < 2 * num_pages_ && size_.load() > 0; ++step) {
+    size_t frame = hand_;
+    hand_ = (hand_ + 1) % num_pages_;
+    if (!evictable_[frame].load()) {
+      continue;
+    }
+    if (ref_[frame].exchange(false)) {
+      continue;
+    }
+    if (!prefer(static_cast<frame_id_t>(frame))) {
+      if (fallback == num_pages_) {
+        fallback = frame;
+      }
+      if (++skipped >= window) {
+        break;
+      }
+      continue;
+    }
+    if (evictable_[frame].exchange(false)) {
+      size_--;
+      *frame_id = static_cast<frame_id_t>(frame);
+      return CountVictim(true);
+    }
+  }
+  if (fallback != num_pages_ && evictable_[fallback].exchange(false)) {
+    size_--;
+    *frame_id = static_cast<frame_id_t>(fallback);
+    return CountVictim(true);
+  }
+  return CountVictim(false);
+}
 
-void ClockReplacer::Unpin(frame_id_t frame_id) {}
+auto ClockReplacer::Candidates(size_t max_count) -> std::vector<frame_id_t> {
+  std::scoped_lock guard(hand_latch_);
+  // Frames without a reference bit go first, in the order the hand reaches them; the others follow.
+  std::vector<frame_id_t> frames;
+  for (bool referenced : {false, true}) {
+    for (size_t step = 0; step < num_pages_ && frames.size() < max_count; ++step) {
+      size_t frame = (hand_ + step) % num_pages_;
+      if (evictable_[frame].load() && ref_[frame].load() == referenced) {
+        frames.push_back(static_cast<frame_id_t>(frame));
+      }
+    }
+  }
+  return frames;
+}
 
-auto ClockReplacer::Size() -> size_t { return 0; }
+void ClockReplacer::Pin(frame_id_t frame_id) {
+  ref_[frame_id].store(true);
+  if (evictable_[frame_id].load() && evictable_[frame_id].exchange(false)) {
+    size_--;
+  }
+}
+
+void ClockReplacer::Unpin(frame_id_t frame_id) {
+  ref_[frame_id].store(true);
+  if (!evictable_[frame_id].load() && !evictable_[frame_id].exchange(true)) {
+    size_++;
+  }
+}
+
+auto ClockReplacer::Size() -> size_t { return size_.load(); }
 
 }  // namespace bustub
@@ -0,0 +1,99 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compressed_page_cache.cpp
+//
+// Identification: src/buffer/compressed_page_cache.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/compressed_page_cache.h"
+
+#include <iterator>
+
+#include "common/util/lz_codec.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+CompressedPageCache::CompressedPageCache(size_t capacity) : capacity_(capacity) {}
+
+void CompressedPageCache::Insert(page_id_t page_id, const char *data) {
+  // Compress before taking the latch, so that concurrent lookups only wait for the bookkeeping.
+  std::string compressed(LZCodec::MaxCompressedSize(PAGE_SIZE), '\0');
+  compressed.resize(LZCodec::Compress(data, PAGE_SIZE, compressed.data()));
+
+  std::scoped_lock guard(latch_);
+  auto it = pages_.find(page_id);
+  if (it != pages_.end()) {
+    Remove(it);
+  }
+  if (compressed.size() >= static_cast<size_t>(PAGE_SIZE) || compressed.size() > capacity_) {
+    return;
+  }
+  while (size_ + compressed.size() > capacity_) {
+    Remove(pages_.find(lru_list_.back()));
+  }
+  compressed.shrink_to_fit();
+  size_ += compressed.size();
+  lru_list_.push_front(page_id);
+  pages_.emplace(page_id, Entry{std::move(compressed), lru_list_.begin()});
+}
+
+auto CompressedPageCache::Take(page_id_t page_id, char *data) -> bool {
+  std::string compressed;
+  {
+    std::scoped_lock guard(latch_);
+    auto it = pages_.find(page_id);
+    if (it == pages_.end()) {
+      misses_++;
+      return false;
+    }
+    hits_++;
+    compressed = Remove(it);
+  }
+  // Only the caller knows about the page now, so it can be decompressed without holding the latch.
+  bool decompressed = LZCodec::Decompress(compressed.data(), compressed.size(), data, PAGE_SIZE);
+  BUSTUB_ASSERT(decompressed, "A compressed page is corrupt.");
+  return true;
+}
+
+void CompressedPageCache::Erase(page_id_t page_id) {
+  std::scoped_lock guard(latch_);
+  auto it = pages_.find(page_id);
+  if (it != pages_.end()) {
+    Remove(it);
+  }
+}
+
+void CompressedPageCache::EraseTablespace(tablespace_id_t tablespace) {
+  std::scoped_lock guard(latch_);
+  for (auto it = pages_.begin(); it != pages_.end();) {
+    auto next = std::next(it);
+    if (DiskManager::TablespaceOf(it->first) == tablespace) {
+      Remove(it);
+    }
+    it = next;
+  }
+}
+
+void CompressedPageCache::CollectStats(BufferPoolStats *stats) {
+  std::scoped_lock guard(latch_);
+  stats->tier_hits_ += hits_;
+  stats->tier_misses_ += misses_;
+  stats->tier_pages_ += pages_.size();
+  stats->tier_bytes_ += size_;
+}
+
+auto CompressedPageCache::Remove(std::unordered_map<page_id_t, Entry>::iterator it) -> std::string {
+  std::string data = std::move(it->second.data_);
+  size_ -= data.size();
+  lru_list_.erase(it->second.lru_position_);
+  pages_.erase(it);
+  return data;
+}
+
+}  // namespace bustub
@@ -0,0 +1,48 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.cpp
+//
+// Identification: src/buffer/frame_arena.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/frame_arena.h"
+
+#include <sys/mman.h>
+
+#include <cstdint>
+
+#include "common/exception.h"
+
+namespace bustub {
+
+FrameArena::FrameArena(size_t num_frames) {
+  size_t size = num_frames * PAGE_SIZE;
+  // Only arenas that span a huge page are worth aligning: map one huge page more and start at the first boundary.
+  size_t alignment = size >= HUGE_PAGE_SIZE ? HUGE_PAGE_SIZE : PAGE_SIZE;
+  mapping_size_ = size + (alignment > PAGE_SIZE ? alignment : 0);
+  mapping_ = mmap(nullptr, mapping_size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (mapping_ == MAP_FAILED) {
+    mapping_ = nullptr;
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "can't map the frames of the buffer pool");
+  }
+  auto start = reinterpret_cast<uintptr_t>(mapping_);
+  data_ = reinterpret_cast<char *>((start + alignment - 1) / alignment * alignment);
+#ifdef MADV_HUGEPAGE
+  if (BUFFER_POOL_HUGE_PAGES && alignment == HUGE_PAGE_SIZE) {
+    huge_pages_ = madvise(data_, size / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE, MADV_HUGEPAGE) == 0;
+  }
+#endif
+}
+
+FrameArena::~FrameArena() {
+  if (mapping_ != nullptr) {
+    munmap(mapping_, mapping_size_);
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,161 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer.cpp
+//
+// Identification: src/buffer/lru_k_replacer.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/lru_k_replacer.h"
+
+#include "common/macros.h"
+
+namespace bustub {
+
+LRUKReplacer::LRUKReplacer(size_t num_pages, size_t k) : num_pages_(num_pages), k_(k), frames_(num_pages) {
+  BUSTUB_ASSERT(k > 0, "LRU-K needs k >= 1");
+}
+
+LRUKReplacer::~LRUKReplacer() = default;
+
+auto LRUKReplacer::Victim(frame_id_t *frame_id) -> bool {
+  std::scoped_lock guard(lock_);
+  std::set<Key> *group = !infinite_distance_.empty() ? &infinite_distance_ : &finite_distance_;
+  if (group->empty()) {
+    return CountVictim(false);
+  }
+  *frame_id = group->begin()->second;
+  Evict(group, group->begin());
+  return CountVictim(true);
+}
+
+auto LRUKReplacer::VictimPreferring(frame_id_t *frame_id, const std::function<bool(frame_id_t)> &prefer, size_t window)
+    -> bool {
+  std::scoped_lock guard(lock_);
+  size_t seen = 0;
+  for (std::set<Key> *group : {&infinite_distance_, &finite_distance_}) {
+    for (auto it = group->begin(); it != group->end() && seen < window; ++it, ++seen) {
+      if (prefer(it->second)) {
+        *frame_id = it->second;
+        Evict(group, it);
+        return CountVictim(true);
+      }
+    }
+  }
+  std::set<Key> *group = !infinite_distance_.empty() ? &infinite_distance_ : &finite_distance_;
+  if (group->empty()) {
+    return CountVictim(false);
+  }
+  *frame_id = group->begin()->second;
+  Evict(group, group->begin());
+  return CountVictim(true);
+}
+
+auto LRUKReplacer::Candidates(size_t max_count) -> std::vector<frame_id_t> {
+  std::scoped_lock guard(lock_);
+  std::vector<frame_id_t> frames;
+  for (const std::set<Key> *group : {&infinite_distance_, &finite_distance_}) {
+    for (auto it = group->begin(); it != group->end() && frames.size() < max_count; ++it) {
+      frames.push_back(it->second);
+    }
+  }
+  return frames;
+}
+
+void LRUKReplacer::Pin(frame_id_t frame_id) {
+  std::scoped_lock guard(lock_);
+  FrameEntry &entry = frames_[frame_id];
+  if (entry.evictable_) {
+    RemoveEvictable(frame_id, entry);
+  }
+  RecordAccess(&entry);
+}
+
+void LRUKReplacer::Unpin(frame_id_t frame_id) {
+  std::scoped_lock guard(lock_);
+  FrameEntry &entry = frames_[frame_id];
+  if (entry.evictable_) {
+    return;
+  }
+  // A frame that was never pinned through the replacer still counts as accessed once.
+  if (entry.history_.empty()) {
+    RecordAccess(&entry);
+  }
+  AddEvictable(frame_id, entry);
+}
+
+auto LRUKReplacer::Size() -> size_t {
+  std::scoped_lock guard(lock_);
+  return infinite_distance_.size() + finite_distance_.size();
+}
+
+void LRUKReplacer::SetPageId(frame_id_t frame_id, page_id_t page_id) {
+  std::scoped_lock guard(lock_);
+  FrameEntry &entry = frames_[frame_id];
+  if (entry.evictable_) {
+    RemoveEvictable(frame_id, entry);
+  }
+  entry.page_id_ = page_id;
+  entry.history_.clear();
+  auto it = evicted_index_.find(page_id);
+  if (it != evicted_index_.end()) {
+    entry.history_ = std::move(it->second->second);
+    evicted_history_.erase(it->second);
+    evicted_index_.erase(it);
+  }
+}
+
+void LRUKReplacer::RecordAccess(FrameEntry *entry) {
+  entry->history_.push_back(current_timestamp_++);
+  if (entry->history_.size() > k_) {
+    entry->history_.pop_front();
+  }
+}
+
+void LRUKReplacer::AddEvictable(frame_id_t frame_id, const FrameEntry &entry) {
+  frames_[frame_id].evictable_ = true;
+  if (entry.history_.size() < k_) {
+    infinite_distance_.emplace(entry.history_.front(), frame_id);
+  } else {
+    finite_distance_.emplace(entry.history_.front(), frame_id);
+  }
+}
+
+void LRUKReplacer::RemoveEvictable(frame_id_t frame_id, const FrameEntry &entry) {
+  frames_[frame_id].evictable_ = false;
+  if (entry.history_.size() < k_) {
+    infinite_distance_.erase({entry.history_.front(), frame_id});
+  } else {
+    finite_distance_.erase({entry.history_.front(), frame_id});
+  }
+}
+
+void LRUKReplacer::Evict(std::set<Key> *group, std::set<Key>::iterator it) {
+  frame_id_t frame_id = it->second;
+  group->erase(it);
+  FrameEntry &entry = frames_[frame_id];
+  if (entry.page_id_ != INVALID_PAGE_ID) {
+    RetainHistory(entry.page_id_, std::move(entry.history_));
+  }
+  entry = FrameEntry{};
+}
+
+void LRUKReplacer::RetainHistory(page_id_t page_id, std::list<size_t> &&history) {
+  auto it = evicted_index_.find(page_id);
+  if (it != evicted_index_.end()) {
+    evicted_history_.erase(it->second);
+    evicted_index_.erase(it);
+  }
+  if (evicted_history_.size() >= num_pages_) {
+    evicted_index_.erase(evicted_history_.front().first);
+    evicted_history_.pop_front();
+  }
+  evicted_history_.emplace_back(page_id, std::move(history));
+  evicted_index_[page_id] = std::prev(evicted_history_.end());
+}
+
+}  // namespace bustub
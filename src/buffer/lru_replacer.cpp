@@ -22,13 +22,33 @@ auto LRUReplacer::Victim(frame_id_t *frame_id) -> bool {
   lock_.lock();
   if (hash_.empty()) {
     lock_.unlock();
-    return false;
+    return CountVictim(false);
   }
   *frame_id = unpin_list_.back();
   unpin_list_.pop_back();
   hash_.erase(*frame_id);
   lock_.unlock();
-  return true;
+  return CountVictim(true);
+}
+
+auto LRUReplacer::VictimPreferring(frame_id_t *frame_id, const std::function<bool(frame_id_t)> &prefer, size_t window)
+    -> bool {
+  std::scoped_lock guard(lock_);
+  if (hash_.empty()) {
+    return CountVictim(false);
+  }
+  auto victim = std::prev(unpin_list_.end());
+  size_t seen = 0;
+  for (auto it = unpin_list_.rbegin(); it != unpin_list_.rend() && seen < window; ++it, ++seen) {
+    if (prefer(*it)) {
+      victim = std::prev(it.base());
+      break;
+    }
+  }
+  *frame_id = *victim;
+  unpin_list_.erase(victim);
+  hash_.erase(*frame_id);
+  return CountVictim(true);
 }
 
 void LRUReplacer::Pin(frame_id_t frame_id) {
@@ -63,4 +83,13 @@ auto LRUReplacer::Size() -> size_t {
   return s;
 }
 
+auto LRUReplacer::Candidates(size_t max_count) -> std::vector<frame_id_t> {
+  std::scoped_lock guard(lock_);
+  std::vector<frame_id_t> frames;
+  for (auto it = unpin_list_.rbegin(); it != unpin_list_.rend() && frames.size() < max_count; ++it) {
+    frames.push_back(*it);
+  }
+  return frames;
+}
+
 }  // namespace bustub
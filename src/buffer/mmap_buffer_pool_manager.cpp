@@ -0,0 +1,100 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// mmap_buffer_pool_manager.cpp
+//
+// Identification: src/buffer/mmap_buffer_pool_manager.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/mmap_buffer_pool_manager.h"
+
+#include <sys/mman.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+
+#include "common/exception.h"
+#include "common/logger.h"
+
+namespace bustub {
+
+MmapBufferPoolManager::MmapBufferPoolManager(DiskManager *disk_manager)
+    : mapping_(disk_manager->MapReadOnly()),
+      num_pages_(disk_manager->GetNumMappedPages()),
+      views_(new std::atomic<Page *>[num_pages_]()) {}
+
+MmapBufferPoolManager::~MmapBufferPoolManager() {
+  for (size_t i = 0; i < num_pages_; ++i) {
+    delete views_[i].load();
+  }
+  delete[] views_;
+}
+
+auto MmapBufferPoolManager::FetchPgImp(page_id_t page_id) -> Page * {
+  if (!IsMapped(page_id)) {
+    return nullptr;
+  }
+  Page *page = views_[page_id].load(std::memory_order_acquire);
+  if (page != nullptr) {
+    return page;
+  }
+  // Threads that fetch a page for the first time at once race to publish their view; the losers drop theirs.
+  auto *view = new Page();
+  // The mapping is PROT_READ, so a write through the view faults rather than reaching the file.
+  view->data_ = const_cast<char *>(mapping_) + static_cast<size_t>(page_id) * PAGE_SIZE;
+  view->page_id_ = page_id;
+  view->pin_count_ = 0;
+  view->read_only_ = true;
+  if (views_[page_id].compare_exchange_strong(page, view, std::memory_order_acq_rel)) {
+    return view;
+  }
+  delete view;
+  return page;
+}
+
+auto MmapBufferPoolManager::UnpinPgImp(page_id_t page_id, bool is_dirty) -> bool {
+  if (is_dirty) {
+    throw Exception("buffer pool is read-only: page " + std::to_string(page_id) + " was modified");
+  }
+  return IsMapped(page_id);
+}
+
+auto MmapBufferPoolManager::FlushPgImp(page_id_t page_id) -> bool { return IsMapped(page_id); }
+
+auto MmapBufferPoolManager::NewPgImp(page_id_t *page_id) -> Page * {
+  throw Exception("buffer pool is read-only: can't create a page");
+}
+
+auto MmapBufferPoolManager::DeletePgImp(page_id_t page_id) -> bool {
+  throw Exception("buffer pool is read-only: can't delete page " + std::to_string(page_id));
+}
+
+void MmapBufferPoolManager::PrefetchPages(const std::vector<page_id_t> &page_ids, BufferAccessStrategy *strategy) {
+  // Advise runs of adjacent pages with one call each; the mapping starts page-aligned, so every page does.
+  std::vector<page_id_t> sorted;
+  for (page_id_t page_id : page_ids) {
+    if (IsMapped(page_id)) {
+      sorted.push_back(page_id);
+    }
+  }
+  std::sort(sorted.begin(), sorted.end());
+  for (size_t begin = 0; begin < sorted.size();) {
+    size_t end = begin + 1;
+    while (end < sorted.size() && sorted[end] <= sorted[end - 1] + 1) {
+      ++end;
+    }
+    char *start = const_cast<char *>(mapping_) + static_cast<size_t>(sorted[begin]) * PAGE_SIZE;
+    size_t length = static_cast<size_t>(sorted[end - 1] - sorted[begin] + 1) * PAGE_SIZE;
+    if (madvise(start, length, MADV_WILLNEED) != 0) {
+      LOG_DEBUG("madvise failed for page %d", sorted[begin]);
+    }
+    begin = end;
+  }
+}
+
+}  // namespace bustub
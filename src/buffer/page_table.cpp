@@ -0,0 +1,90 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.cpp
+//
+// Identification: src/buffer/page_table.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/page_table.h"
+
+namespace bustub {
+
+PageTable::PageTable(size_t num_frames) {
+  while ((static_cast<size_t>(1) << bits_) < 2 * num_frames) {
+    bits_++;
+  }
+  mask_ = (static_cast<size_t>(1) << bits_) - 1;
+  slots_ = new std::atomic<uint64_t>[mask_ + 1];
+  for (size_t i = 0; i <= mask_; ++i) {
+    slots_[i].store(EMPTY_SLOT, std::memory_order_relaxed);
+  }
+}
+
+PageTable::~PageTable() { delete[] slots_; }
+
+auto PageTable::Home(page_id_t page_id) const -> size_t {
+  // Fibonacci hashing spreads the consecutive page ids of a table over the whole array.
+  return (static_cast<uint64_t>(static_cast<uint32_t>(page_id)) * 0x9E3779B97F4A7C15ULL) >> (64 - bits_);
+}
+
+auto PageTable::Find(page_id_t page_id, frame_id_t *frame_id) const -> bool {
+  for (size_t i = Home(page_id);; i = (i + 1) & mask_) {
+    uint64_t slot = slots_[i].load(std::memory_order_acquire);
+    if (slot == EMPTY_SLOT) {
+      return false;
+    }
+    if (PageOf(slot) == page_id) {
+      *frame_id = FrameOf(slot);
+      return true;
+    }
+  }
+}
+
+void PageTable::Insert(page_id_t page_id, frame_id_t frame_id) {
+  size_t i = Home(page_id);
+  while (true) {
+    uint64_t slot = slots_[i].load(std::memory_order_relaxed);
+    if (slot == EMPTY_SLOT || PageOf(slot) == page_id) {
+      break;
+    }
+    i = (i + 1) & mask_;
+  }
+  slots_[i].store(Pack(page_id, frame_id), std::memory_order_release);
+}
+
+void PageTable::Remove(page_id_t page_id) {
+  size_t hole = Home(page_id);
+  while (true) {
+    uint64_t slot = slots_[hole].load(std::memory_order_relaxed);
+    if (slot == EMPTY_SLOT) {
+      return;
+    }
+    if (PageOf(slot) == page_id) {
+      break;
+    }
+    hole = (hole + 1) & mask_;
+  }
+
+  // Move back every later entry of the cluster whose home is not between the hole and its current slot, so that each
+  // entry stays reachable from its home without crossing an empty slot.
+  for (size_t i = (hole + 1) & mask_;; i = (i + 1) & mask_) {
+    uint64_t slot = slots_[i].load(std::memory_order_relaxed);
+    if (slot == EMPTY_SLOT) {
+      break;
+    }
+    size_t home = Home(PageOf(slot));
+    bool stays = hole <= i ? (hole < home && home <= i) : (hole < home || home <= i);
+    if (!stays) {
+      slots_[hole].store(slot, std::memory_order_release);
+      hole = i;
+    }
+  }
+  slots_[hole].store(EMPTY_SLOT, std::memory_order_release);
+}
+
+}  // namespace bustub
@@ -12,58 +12,255 @@
 
 #include "buffer/parallel_buffer_pool_manager.h"
 
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
 namespace bustub {
 
 ParallelBufferPoolManager::ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
-                                                     LogManager *log_manager) {
+                                                     LogManager *log_manager)
+    : disk_manager_(disk_manager) {
   // Allocate and create individual BufferPoolManagerInstances
+  BUSTUB_ASSERT(num_instances > 0, "A parallel BPM needs at least one instance");
+  instances_.reserve(num_instances);
+  for (size_t i = 0; i < num_instances; ++i) {
+    instances_.push_back(new BufferPoolManagerInstance(pool_size, num_instances, i, disk_manager, log_manager));
+  }
 }
 
 // Update constructor to destruct all BufferPoolManagerInstances and deallocate any associated memory
-ParallelBufferPoolManager::~ParallelBufferPoolManager() = default;
+ParallelBufferPoolManager::~ParallelBufferPoolManager() {
+  for (auto *instance : instances_) {
+    delete instance;
+  }
+}
 
 auto ParallelBufferPoolManager::GetPoolSize() -> size_t {
   // Get size of all BufferPoolManagerInstances
-  return 0;
+  size_t pool_size = 0;
+  for (auto *instance : instances_) {
+    pool_size += instance->GetPoolSize();
+  }
+  return pool_size;
+}
+
+auto ParallelBufferPoolManager::Resize(size_t pool_size) -> bool {
+  if (pool_size < instances_.size()) {
+    return false;
+  }
+  bool resized = true;
+  for (size_t i = 0; i < instances_.size(); ++i) {
+    size_t instance_pool_size = pool_size / instances_.size() + (i < pool_size % instances_.size() ? 1 : 0);
+    resized = instances_[i]->Resize(instance_pool_size) && resized;
+  }
+  return resized;
+}
+
+auto ParallelBufferPoolManager::DropTablespaces(const std::vector<tablespace_id_t> &tablespaces) -> bool {
+  for (tablespace_id_t tablespace : tablespaces) {
+    if (tablespace == DEFAULT_TABLESPACE || !disk_manager_->HasTablespace(tablespace)) {
+      throw Exception("can't drop tablespace " + std::to_string(tablespace));
+    }
+  }
+  std::vector<std::vector<frame_id_t>> claimed(instances_.size());
+  for (size_t i = 0; i < instances_.size(); ++i) {
+    if (!instances_[i]->ClaimTablespaceFrames(tablespaces, &claimed[i])) {
+      for (size_t j = 0; j < i; ++j) {
+        instances_[j]->UnclaimTablespaceFrames(claimed[j]);
+      }
+      return false;
+    }
+  }
+  for (size_t i = 0; i < instances_.size(); ++i) {
+    instances_[i]->DiscardTablespaceFrames(tablespaces, claimed[i]);
+  }
+  for (tablespace_id_t tablespace : tablespaces) {
+    disk_manager_->DropTablespace(tablespace);
+  }
+  return true;
+}
+
+void ParallelBufferPoolManager::StartBackgroundFlusher(double clean_target) {
+  for (auto *instance : instances_) {
+    instance->StartBackgroundFlusher(clean_target);
+  }
+}
+
+void ParallelBufferPoolManager::StopBackgroundFlusher() {
+  for (auto *instance : instances_) {
+    instance->StopBackgroundFlusher();
+  }
+}
+
+void ParallelBufferPoolManager::EnableCompressedTier(size_t capacity) {
+  for (auto *instance : instances_) {
+    instance->EnableCompressedTier(capacity / instances_.size());
+  }
+}
+
+void ParallelBufferPoolManager::PrefetchPages(const std::vector<page_id_t> &page_ids, BufferAccessStrategy *strategy) {
+  std::vector<std::vector<page_id_t>> per_instance(instances_.size());
+  for (page_id_t page_id : page_ids) {
+    if (page_id != INVALID_PAGE_ID) {
+      per_instance[page_id % instances_.size()].push_back(page_id);
+    }
+  }
+  for (size_t i = 0; i < instances_.size(); ++i) {
+    if (!per_instance[i].empty()) {
+      instances_[i]->PrefetchPages(per_instance[i], strategy);
+    }
+  }
+}
+
+auto ParallelBufferPoolManager::FetchPages(const std::vector<page_id_t> &page_ids) -> std::vector<Page *> {
+  // Remember where each page came from, so that the instances' results can be put back in order.
+  std::vector<std::vector<page_id_t>> per_instance(instances_.size());
+  std::vector<std::vector<size_t>> positions(instances_.size());
+  for (size_t i = 0; i < page_ids.size(); ++i) {
+    if (page_ids[i] == INVALID_PAGE_ID) {
+      continue;
+    }
+    size_t instance = page_ids[i] % instances_.size();
+    per_instance[instance].push_back(page_ids[i]);
+    positions[instance].push_back(i);
+  }
+  std::vector<Page *> pages(page_ids.size(), nullptr);
+  for (size_t i = 0; i < instances_.size(); ++i) {
+    if (per_instance[i].empty()) {
+      continue;
+    }
+    std::vector<Page *> fetched = instances_[i]->FetchPages(per_instance[i]);
+    for (size_t j = 0; j < fetched.size(); ++j) {
+      pages[positions[i][j]] = fetched[j];
+    }
+  }
+  return pages;
+}
+
+void ParallelBufferPoolManager::UnpinPages(const std::vector<page_id_t> &page_ids, bool is_dirty) {
+  std::vector<std::vector<page_id_t>> per_instance(instances_.size());
+  for (page_id_t page_id : page_ids) {
+    if (page_id != INVALID_PAGE_ID) {
+      per_instance[page_id % instances_.size()].push_back(page_id);
+    }
+  }
+  for (size_t i = 0; i < instances_.size(); ++i) {
+    if (!per_instance[i].empty()) {
+      instances_[i]->UnpinPages(per_instance[i], is_dirty);
+    }
+  }
+}
+
+void ParallelBufferPoolManager::DumpResidentSet() {
+  // Each instance only picks its own pages out of the list, so their relative order is all that matters.
+  std::vector<page_id_t> page_ids;
+  for (auto *instance : instances_) {
+    std::vector<page_id_t> resident = instance->GetResidentPages();
+    page_ids.insert(page_ids.end(), resident.begin(), resident.end());
+  }
+  disk_manager_->WriteWarmUpList(page_ids);
+}
+
+auto ParallelBufferPoolManager::LoadResidentSet() -> size_t {
+  std::vector<page_id_t> page_ids = disk_manager_->ReadWarmUpList();
+  std::vector<size_t> loaded(instances_.size());
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < instances_.size(); ++i) {
+    threads.emplace_back([&, i] { loaded[i] = instances_[i]->WarmUp(page_ids); });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  size_t total = 0;
+  for (size_t count : loaded) {
+    total += count;
+  }
+  return total;
+}
+
+auto ParallelBufferPoolManager::GetStats() -> BufferPoolStats {
+  BufferPoolStats stats;
+  for (auto *instance : instances_) {
+    stats += instance->GetStats();
+  }
+  return stats;
 }
 
 auto ParallelBufferPoolManager::GetBufferPoolManager(page_id_t page_id) -> BufferPoolManager * {
   // Get BufferPoolManager responsible for handling given page id. You can use this method in your other methods.
-  return nullptr;
+  return instances_[page_id % instances_.size()];
 }
 
 auto ParallelBufferPoolManager::FetchPgImp(page_id_t page_id) -> Page * {
   // Fetch page for page_id from responsible BufferPoolManagerInstance
-  return nullptr;
+  return GetBufferPoolManager(page_id)->FetchPage(page_id);
 }
 
 auto ParallelBufferPoolManager::UnpinPgImp(page_id_t page_id, bool is_dirty) -> bool {
   // Unpin page_id from responsible BufferPoolManagerInstance
-  return false;
+  return GetBufferPoolManager(page_id)->UnpinPage(page_id, is_dirty);
 }
 
 auto ParallelBufferPoolManager::FlushPgImp(page_id_t page_id) -> bool {
   // Flush page_id from responsible BufferPoolManagerInstance
-  return false;
+  return GetBufferPoolManager(page_id)->FlushPage(page_id);
+}
+
+auto ParallelBufferPoolManager::NewPgImp(page_id_t *page_id) -> Page * { return NewPageWithStrategy(page_id, nullptr); }
+
+auto ParallelBufferPoolManager::FetchPageWithStrategy(page_id_t page_id, BufferAccessStrategy *strategy) -> Page * {
+  return instances_[page_id % instances_.size()]->FetchPageWithStrategy(page_id, strategy);
 }
 
-auto ParallelBufferPoolManager::NewPgImp(page_id_t *page_id) -> Page * {
+auto ParallelBufferPoolManager::FetchPageWithHint(page_id_t page_id, frame_id_t *frame_id) -> Page * {
+  return instances_[page_id % instances_.size()]->FetchPageWithHint(page_id, frame_id);
+}
+
+auto ParallelBufferPoolManager::NewPageWithStrategy(page_id_t *page_id, BufferAccessStrategy *strategy,
+                                                    tablespace_id_t tablespace) -> Page * {
   // create new page. We will request page allocation in a round robin manner from the underlying
   // BufferPoolManagerInstances
   // 1.   From a starting index of the BPMIs, call NewPageImpl until either 1) success and return 2) looped around to
   // starting index and return nullptr
   // 2.   Bump the starting index (mod number of instances) to start search at a different BPMI each time this function
   // is called
+  size_t start = next_instance_.fetch_add(1) % instances_.size();
+  for (size_t i = 0; i < instances_.size(); ++i) {
+    Page *page = instances_[(start + i) % instances_.size()]->NewPageWithStrategy(page_id, strategy, tablespace);
+    if (page != nullptr) {
+      return page;
+    }
+  }
   return nullptr;
 }
 
+auto ParallelBufferPoolManager::NewPageInExtent(page_id_t *page_id, Extent *extent, BufferAccessStrategy *strategy)
+    -> Page * {
+  // The ids of an extent map to the instances in turn; the page can only be created in the one its id maps to.
+  *page_id = extent->NextPageId(disk_manager_);
+  return instances_[*page_id % instances_.size()]->NewPageWithId(*page_id, strategy);
+}
+
 auto ParallelBufferPoolManager::DeletePgImp(page_id_t page_id) -> bool {
   // Delete page_id from responsible BufferPoolManagerInstance
-  return false;
+  return GetBufferPoolManager(page_id)->DeletePage(page_id);
 }
 
 void ParallelBufferPoolManager::FlushAllPgsImp() {
-  // flush all pages from all BufferPoolManagerInstances
+  // flush all pages from all BufferPoolManagerInstances, in a single batch followed by a single sync of the free page
+  // map, rather than one of each per instance
+  std::vector<std::pair<page_id_t, const char *>> pages;
+  std::vector<std::vector<frame_id_t>> dirty;
+  dirty.reserve(instances_.size());
+  for (auto *instance : instances_) {
+    dirty.push_back(instance->CollectDirtyPages(&pages));
+  }
+  disk_manager_->WritePages(std::move(pages));
+  disk_manager_->FlushFreePageMap();
+  for (size_t i = 0; i < instances_.size(); ++i) {
+    instances_[i]->ReleaseFlushedPages(dirty[i]);
+  }
 }
 
 }  // namespace bustub
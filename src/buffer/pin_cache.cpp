@@ -0,0 +1,68 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// pin_cache.cpp
+//
+// Identification: src/buffer/pin_cache.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/pin_cache.h"
+
+#include <algorithm>
+#include <iterator>
+
+namespace bustub {
+
+PinCache::PinCache(BufferPoolManager *buffer_pool_manager, size_t capacity)
+    : buffer_pool_manager_(buffer_pool_manager), capacity_(std::max<size_t>(capacity, 2)) {
+  pages_.reserve(capacity_);
+}
+
+auto PinCache::ForPool(BufferPoolManager *buffer_pool_manager) -> std::unique_ptr<PinCache> {
+  size_t capacity = std::min<size_t>(PIN_CACHE_SIZE, buffer_pool_manager->GetPoolSize() / PIN_CACHE_POOL_FRACTION);
+  if (capacity < 2) {
+    return nullptr;
+  }
+  return std::make_unique<PinCache>(buffer_pool_manager, capacity);
+}
+
+auto PinCache::FetchPage(page_id_t page_id, BufferAccessStrategy *strategy) -> Page * {
+  // The cache is small, and scans ask for the page they asked for last, so search from the back.
+  for (auto it = pages_.rbegin(); it != pages_.rend(); ++it) {
+    if (it->first == page_id) {
+      Page *page = it->second;
+      std::rotate(std::prev(it.base()), it.base(), pages_.end());
+      return page;
+    }
+  }
+
+  if (pages_.size() == capacity_) {
+    Release(capacity_ / 2);
+  }
+  Page *page = buffer_pool_manager_->FetchPageWithStrategy(page_id, strategy);
+  if (page != nullptr) {
+    pages_.emplace_back(page_id, page);
+  }
+  return page;
+}
+
+void PinCache::Flush() { Release(pages_.size()); }
+
+void PinCache::Release(size_t count) {
+  if (count == 0) {
+    return;
+  }
+  std::vector<page_id_t> page_ids;
+  page_ids.reserve(count);
+  for (size_t i = 0; i < count; ++i) {
+    page_ids.push_back(pages_[i].first);
+  }
+  buffer_pool_manager_->UnpinPages(page_ids, false);
+  pages_.erase(pages_.begin(), pages_.begin() + count);
+}
+
+}  // namespace bustub
@@ -0,0 +1,66 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// read_ahead.cpp
+//
+// Identification: src/buffer/read_ahead.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/read_ahead.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace bustub {
+
+ReadAheadWindow::ReadAheadWindow(BufferPoolManager *buffer_pool_manager, BufferAccessStrategy *strategy)
+    : buffer_pool_manager_(buffer_pool_manager), strategy_(strategy) {
+  if (buffer_pool_manager_ == nullptr) {
+    return;
+  }
+  size_t pool_size = buffer_pool_manager_->GetPoolSize();
+  max_window_ = std::min<size_t>(READ_AHEAD_MAX_WINDOW, pool_size / 4);
+  if (strategy_ != nullptr) {
+    // The pages read ahead go into the scan's ring, which holds at most an eighth of the pool and must not recycle
+    // them before the scan gets to them.
+    max_window_ = std::min(max_window_, std::min(strategy_->GetRingSize(), pool_size / 8) / 2);
+  }
+}
+
+void ReadAheadWindow::Advance(page_id_t from, page_id_t to) {
+  if (max_window_ == 0 || from == INVALID_PAGE_ID || to == INVALID_PAGE_ID) {
+    return;
+  }
+  size_t reach = std::max<size_t>(window_, READ_AHEAD_MIN_WINDOW);
+  if (to <= from || static_cast<size_t>(to - from) > reach) {
+    window_ = 0;
+    prefetched_until_ = INVALID_PAGE_ID;
+    return;
+  }
+
+  if (window_ == 0) {
+    window_ = std::min<size_t>(READ_AHEAD_MIN_WINDOW, max_window_);
+    prefetched_until_ = to + 1;
+  } else if (static_cast<size_t>(std::max(prefetched_until_ - to, 0)) > window_ / 2) {
+    // Still well inside what was read ahead last time.
+    return;
+  } else {
+    window_ = std::min(2 * window_, max_window_);
+  }
+
+  page_id_t end = to + 1 + static_cast<page_id_t>(window_);
+  std::vector<page_id_t> page_ids;
+  for (page_id_t page_id = std::max(prefetched_until_, to + 1); page_id < end; ++page_id) {
+    page_ids.push_back(page_id);
+  }
+  prefetched_until_ = end;
+  if (!page_ids.empty()) {
+    buffer_pool_manager_->PrefetchPages(page_ids, strategy_);
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,147 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lz_codec.cpp
+//
+// Identification: src/common/util/lz_codec.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/util/lz_codec.h"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+
+namespace bustub {
+
+namespace {
+
+constexpr size_t MIN_MATCH = 4;
+constexpr size_t MAX_OFFSET = 65535;
+constexpr size_t HASH_BITS = 12;
+constexpr size_t NIBBLE_MAX = 15;
+
+auto Load32(const char *p) -> uint32_t {
+  uint32_t value;
+  memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+auto Hash(uint32_t value) -> uint32_t { return (value * 2654435761U) >> (32 - HASH_BITS); }
+
+/** Writes the part of a length that does not fit in its nibble. */
+void WriteExtraLength(size_t length, char **out) {
+  while (length >= 255) {
+    *(*out)++ = static_cast<char>(255);
+    length -= 255;
+  }
+  *(*out)++ = static_cast<char>(length);
+}
+
+/** Reads the part of a length that did not fit in its nibble. */
+auto ReadExtraLength(const char **in, const char *end, size_t *length) -> bool {
+  uint8_t byte;
+  do {
+    if (*in == end) {
+      return false;
+    }
+    byte = static_cast<uint8_t>(*(*in)++);
+    *length += byte;
+  } while (byte == 255);
+  return true;
+}
+
+/** Writes a sequence; a match length of 0 marks the last sequence, which has no match. */
+void WriteSequence(const char *literals, size_t num_literals, size_t offset, size_t match_length, char **out) {
+  size_t match_code = match_length == 0 ? 0 : match_length - MIN_MATCH;
+  *(*out)++ = static_cast<char>((std::min(num_literals, NIBBLE_MAX) << 4) | std::min(match_code, NIBBLE_MAX));
+  if (num_literals >= NIBBLE_MAX) {
+    WriteExtraLength(num_literals - NIBBLE_MAX, out);
+  }
+  memcpy(*out, literals, num_literals);
+  *out += num_literals;
+  if (match_length == 0) {
+    return;
+  }
+  *(*out)++ = static_cast<char>(offset & 0xff);
+  *(*out)++ = static_cast<char>(offset >> 8);
+  if (match_code >= NIBBLE_MAX) {
+    WriteExtraLength(match_code - NIBBLE_MAX, out);
+  }
+}
+
+}  // namespace
+
+auto LZCodec::Compress(const char *src, size_t size, char *dst) -> size_t {
+  std::array<int32_t, 1 << HASH_BITS> last_seen;
+  last_seen.fill(-1);
+  char *out = dst;
+  size_t anchor = 0;
+  size_t pos = 0;
+  while (pos + MIN_MATCH <= size) {
+    uint32_t hash = Hash(Load32(src + pos));
+    int32_t candidate = last_seen[hash];
+    last_seen[hash] = static_cast<int32_t>(pos);
+    if (candidate < 0 || pos - candidate > MAX_OFFSET || Load32(src + candidate) != Load32(src + pos)) {
+      ++pos;
+      continue;
+    }
+    size_t match_length = MIN_MATCH;
+    while (pos + match_length < size && src[candidate + match_length] == src[pos + match_length]) {
+      ++match_length;
+    }
+    WriteSequence(src + anchor, pos - anchor, pos - candidate, match_length, &out);
+    pos += match_length;
+    anchor = pos;
+  }
+  WriteSequence(src + anchor, size - anchor, 0, 0, &out);
+  return out - dst;
+}
+
+auto LZCodec::Decompress(const char *src, size_t src_size, char *dst, size_t size) -> bool {
+  const char *in = src;
+  const char *in_end = src + src_size;
+  size_t pos = 0;
+  while (in < in_end) {
+    auto token = static_cast<uint8_t>(*in++);
+    size_t num_literals = token >> 4;
+    if (num_literals == NIBBLE_MAX && !ReadExtraLength(&in, in_end, &num_literals)) {
+      return false;
+    }
+    if (num_literals > static_cast<size_t>(in_end - in) || num_literals > size - pos) {
+      return false;
+    }
+    memcpy(dst + pos, in, num_literals);
+    in += num_literals;
+    pos += num_literals;
+    if (in == in_end) {
+      break;
+    }
+
+    if (in_end - in < 2) {
+      return false;
+    }
+    size_t offset = static_cast<uint8_t>(in[0]) | (static_cast<size_t>(static_cast<uint8_t>(in[1])) << 8);
+    in += 2;
+    size_t match_length = token & NIBBLE_MAX;
+    if (match_length == NIBBLE_MAX && !ReadExtraLength(&in, in_end, &match_length)) {
+      return false;
+    }
+    match_length += MIN_MATCH;
+    if (offset == 0 || offset > pos || match_length > size - pos) {
+      return false;
+    }
+    // The match may overlap the bytes it produces, as runs do, so copy it one byte at a time.
+    for (size_t i = 0; i < match_length; ++i, ++pos) {
+      dst[pos] = dst[pos - offset];
+    }
+  }
+  return pos == size;
+}
+
+}  // namespace bustub
@@ -37,7 +37,7 @@ auto IndexScanExecutor::Next(Tuple *tuple, RID *rid) -> bool {
     lock_mgr->LockShared(txn, (*iter_).second);
   }
 
-  table_->table_->GetTuple((*iter_).second, tuple, txn);
+  table_->table_->GetTuple((*iter_).second, tuple, txn, exec_ctx_->GetPinCache());
   if (plan_->GetPredicate() != nullptr &&
       !plan_->GetPredicate()->Evaluate(tuple, plan_->OutputSchema()).GetAs<bool>()) {
     if (lock_mgr != nullptr) {
@@ -26,7 +26,8 @@ void SeqScanExecutor::Init() {
   table_ = catalog->GetTable(plan_->GetTableOid());
   if (table_ == nullptr) { return; }
 
-  iter_ = table_->table_->Begin(exec_ctx_->GetTransaction());
+  strategy_ = exec_ctx_->CreateScanStrategy();
+  iter_ = table_->table_->Begin(exec_ctx_->GetTransaction(), strategy_.get(), exec_ctx_->GetPinCache());
 }
 
 auto SeqScanExecutor::Next(Tuple *tuple, RID *rid) -> bool {
@@ -0,0 +1,91 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_access_strategy.h
+//
+// Identification: src/include/buffer/buffer_access_strategy.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/** The kinds of bulk operations a BufferAccessStrategy is made for. */
+enum class BufferAccessType { BULK_READ, BULK_WRITE };
+
+/**
+ * BufferAccessStrategy confines a bulk operation, such as a large sequential scan or a table load, to a small ring of
+ * frames, so that it does not wipe out the working set of the shared buffer pool.
+ *
+ * On a miss, the buffer pool reuses the frame of the page that the operation read into the current ring slot, if
+ * nobody else is using that page. Otherwise it picks a victim as usual, and the new frame takes the slot. A bulk read
+ * gives up a ring frame whose page was dirtied meanwhile, since someone else is evidently using it. A bulk write
+ * reuses dirty ring frames, writing them back itself.
+ *
+ * The ring only kicks in once the operation has touched more than activation_threshold distinct pages, so small
+ * operations keep using the shared pool. Each buffer pool instance gets its own ring, holding at most an eighth of
+ * the instance. A strategy belongs to a single operation and is not thread-safe.
+ */
+class BufferAccessStrategy {
+ public:
+  /**
+   * Creates a new BufferAccessStrategy.
+   * @param type the kind of bulk operation
+   * @param ring_size the number of frames in each ring
+   * @param activation_threshold the number of pages the operation touches before the ring is used
+   */
+  BufferAccessStrategy(BufferAccessType type, size_t ring_size, size_t activation_threshold = 0);
+
+  /** @return the kind of bulk operation */
+  auto GetType() const -> BufferAccessType { return type_; }
+
+  /** @return the number of frames in each ring */
+  auto GetRingSize() const -> size_t { return ring_size_; }
+
+  /**
+   * Counts an access to a page, and tells whether the ring is in use. Consecutive accesses to the same page count
+   * once.
+   * @param page_id the page being accessed
+   * @return true if the access should go through the ring
+   */
+  auto Access(page_id_t page_id) -> bool;
+
+  /** @return true if accesses go through the ring, as Access last said */
+  auto IsActive() const -> bool { return pages_accessed_ > activation_threshold_; }
+
+  /** The frames a buffer pool instance lends to the operation, identified by the pages read into them. */
+  struct Ring {
+    /** The page read into each slot, INVALID_PAGE_ID for unused slots. */
+    std::vector<page_id_t> page_ids_;
+    /** The slot to fill next. */
+    size_t current_{0};
+  };
+
+  /**
+   * @param instance_index the index of a buffer pool instance
+   * @param pool_size the size of that instance
+   * @return the ring of the given instance
+   */
+  auto GetRing(uint32_t instance_index, size_t pool_size) -> Ring &;
+
+ private:
+  const BufferAccessType type_;
+  const size_t ring_size_;
+  const size_t activation_threshold_;
+  /** The number of distinct pages accessed so far. */
+  size_t pages_accessed_{0};
+  page_id_t last_page_id_{INVALID_PAGE_ID};
+  /** One ring per buffer pool instance, keyed by instance index. */
+  std::unordered_map<uint32_t, Ring> rings_;
+};
+
+}  // namespace bustub
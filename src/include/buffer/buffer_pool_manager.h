@@ -14,11 +14,17 @@
 
 #include <list>
 #include <mutex>  // NOLINT
+#include <string>
 #include <unordered_map>
+#include <vector>
 
+#include "buffer/buffer_access_strategy.h"
+#include "buffer/buffer_pool_stats.h"
 #include "buffer/lru_replacer.h"
+#include "common/exception.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
+#include "storage/disk/extent.h"
 #include "storage/page/page.h"
 
 namespace bustub {
@@ -87,6 +93,147 @@ class BufferPoolManager {
   /** @return size of the buffer pool */
   virtual auto GetPoolSize() -> size_t = 0;
 
+  /**
+   * Hints that the given pages will be fetched soon. The pages are read into the buffer pool in the background and
+   * are not pinned; pages that are already resident or were never allocated are skipped. This is only a hint, and a
+   * buffer pool may ignore it, which is what the default implementation does.
+   * @param page_ids ids of the pages to read ahead, in the order they are expected to be fetched
+   * @param strategy the access strategy of the bulk operation that will fetch the pages, nullptr for the shared pool
+   */
+  virtual void PrefetchPages(const std::vector<page_id_t> &page_ids, BufferAccessStrategy *strategy = nullptr) {}
+
+  /**
+   * Fetch the requested page on behalf of a bulk operation. On a miss, the frame is taken from the strategy's ring.
+   * Buffer pools without rings fall back to FetchPage, which is what the default implementation does.
+   * @param page_id id of page to be fetched
+   * @param strategy the bulk operation's access strategy, nullptr to use the shared pool
+   * @return the requested page
+   */
+  virtual auto FetchPageWithStrategy(page_id_t page_id, BufferAccessStrategy *strategy) -> Page * {
+    return FetchPage(page_id);
+  }
+
+  /**
+   * Fetch the requested page, trying the frame it was last seen in before looking it up. This is how index pages
+   * follow their swizzled child links (see Page::GetChildFrames). Buffer pools that cannot use the hint fall back to
+   * FetchPage and report no frame, which is what the default implementation does.
+   * @param page_id id of page to be fetched
+   * @param[in,out] frame_id the frame the page is expected in, -1 if unknown; set to the frame it was found in
+   * @return the requested page
+   */
+  virtual auto FetchPageWithHint(page_id_t page_id, frame_id_t *frame_id) -> Page * {
+    *frame_id = -1;
+    return FetchPage(page_id);
+  }
+
+  /**
+   * Fetch several pages in one call. A page id that appears more than once is pinned once per appearance. Buffer pools
+   * that cannot batch fetches fetch the pages one by one, which is what the default implementation does.
+   * @param page_ids ids of the pages to be fetched
+   * @return the pages in the order of page_ids, with nullptr for each page that could not be fetched
+   */
+  virtual auto FetchPages(const std::vector<page_id_t> &page_ids) -> std::vector<Page *> {
+    std::vector<Page *> pages;
+    pages.reserve(page_ids.size());
+    for (page_id_t page_id : page_ids) {
+      pages.push_back(FetchPage(page_id));
+    }
+    return pages;
+  }
+
+  /**
+   * Unpin several pages in one call. A page id that appears more than once loses one pin per appearance. Buffer pools
+   * that cannot batch unpins unpin the pages one by one, which is what the default implementation does.
+   * @param page_ids ids of the pages to be unpinned
+   * @param is_dirty true if the pages should be marked as dirty, false otherwise
+   */
+  virtual void UnpinPages(const std::vector<page_id_t> &page_ids, bool is_dirty) {
+    for (page_id_t page_id : page_ids) {
+      UnpinPage(page_id, is_dirty);
+    }
+  }
+
+  /**
+   * Creates a new page on behalf of a bulk operation, taking the frame from the strategy's ring, or in a tablespace
+   * other than the db file. Buffer pools without rings fall back to NewPage, which is what the default implementation
+   * does; it can only create pages in DEFAULT_TABLESPACE.
+   * @param[out] page_id id of created page
+   * @param strategy the bulk operation's access strategy, nullptr to use the shared pool
+   * @param tablespace the tablespace to create the page in, see DiskManager::CreateTablespace
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   * @throw Exception if the page cannot be created in the tablespace
+   */
+  virtual auto NewPageWithStrategy(page_id_t *page_id, BufferAccessStrategy *strategy,
+                                   tablespace_id_t tablespace = DEFAULT_TABLESPACE) -> Page * {
+    if (tablespace != DEFAULT_TABLESPACE) {
+      throw Exception("buffer pool can't create pages in tablespace " + std::to_string(tablespace));
+    }
+    return NewPage(page_id);
+  }
+
+  /**
+   * Creates a new page of an object that keeps its pages together, such as a table heap or an index. The page gets the
+   * next id of the object's extent, so that the object's pages lie in the file in the order they were created. Buffer
+   * pools that cannot create a page under a given id fall back to NewPageWithStrategy in the extent's tablespace,
+   * which is what the default implementation does.
+   * @param[out] page_id id of created page
+   * @param extent the extent of the object
+   * @param strategy the bulk operation's access strategy, nullptr to use the shared pool
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   * @throw Exception if the extent's tablespace does not exist or is full
+   */
+  virtual auto NewPageInExtent(page_id_t *page_id, Extent *extent, BufferAccessStrategy *strategy = nullptr)
+      -> Page * {
+    return NewPageWithStrategy(page_id, strategy, extent->GetTablespace());
+  }
+
+  /**
+   * Takes a snapshot of the buffer pool's counters. The counters are always on, and cheap enough to stay that way.
+   * Buffer pools without counters return all zeros, which is what the default implementation does.
+   * @return the counters accumulated since the buffer pool was created
+   */
+  virtual auto GetStats() -> BufferPoolStats { return {}; }
+
+  /**
+   * Grows or shrinks the buffer pool while it is in use. Buffer pools that cannot be resized return false, which is
+   * what the default implementation does.
+   * @param pool_size the new size of the buffer pool, as GetPoolSize reports it
+   * @return true if the buffer pool now has the new size
+   */
+  virtual auto Resize(size_t pool_size) -> bool { return false; }
+
+  /**
+   * Drops a tablespace and its pages. The pages are discarded from the buffer pool without being written back, then
+   * the tablespace is dropped on disk.
+   * @param tablespace the tablespace to drop, see DiskManager::CreateTablespace
+   * @return false if a page of the tablespace is pinned; the tablespace is then left as it was
+   * @throw Exception if the tablespace does not exist or is DEFAULT_TABLESPACE
+   */
+  auto DropTablespace(tablespace_id_t tablespace) -> bool { return DropTablespaces({tablespace}); }
+
+  /**
+   * Drops several tablespaces like DropTablespace, either all of them or none. Buffer pools that cannot create pages
+   * outside DEFAULT_TABLESPACE cannot drop tablespaces either, and return false, which is what the default
+   * implementation does.
+   * @param tablespaces the tablespaces to drop
+   * @return false if a page of one of the tablespaces is pinned; all of them are then left as they were
+   * @throw Exception if one of the tablespaces does not exist or is DEFAULT_TABLESPACE; none is dropped then
+   */
+  virtual auto DropTablespaces(const std::vector<tablespace_id_t> &tablespaces) -> bool { return false; }
+
+  /**
+   * Records the pages resident in the buffer pool, with their eviction order, in the disk manager's warm-up file, so
+   * that LoadResidentSet can bring them back after a restart. The default implementation does nothing.
+   */
+  virtual void DumpResidentSet() {}
+
+  /**
+   * Reads in the pages recorded by the last DumpResidentSet and restores their eviction order. Meant to be called at
+   * startup, before the buffer pool takes any traffic. The default implementation does nothing.
+   * @return the number of pages read in
+   */
+  virtual auto LoadResidentSet() -> size_t { return 0; }
+
  protected:
   /**
    * Grading function. Do not modify!
@@ -12,18 +12,31 @@
 
 #pragma once
 
+#include <chrono>              // NOLINT
+#include <condition_variable>  // NOLINT
+#include <deque>
 #include <list>
-#include <mutex>  // NOLINT
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_stats.h"
+#include "buffer/compressed_page_cache.h"
+#include "buffer/frame_arena.h"
 #include "buffer/lru_replacer.h"
+#include "buffer/page_table.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/page/page.h"
 
 namespace bustub {
 
+/** The replacement policies a BufferPoolManagerInstance can be built with. */
+enum class ReplacerType { LRU, LRU_K, CLOCK };
+
 /**
  * BufferPoolManager reads disk pages to and from its internal buffer pool.
  */
@@ -34,8 +47,13 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    * @param pool_size the size of the buffer pool
    * @param disk_manager the disk manager
    * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_type the replacement policy
+   * @param replacer_k the K of the LRU-K policy, ignored by the other policies
+   * @param max_pool_size the largest size Resize can grow the pool to, 0 for BUFFER_POOL_MAX_GROWTH times pool_size
    */
-  BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager = nullptr);
+  BufferPoolManagerInstance(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager = nullptr,
+                            ReplacerType replacer_type = ReplacerType::LRU, size_t replacer_k = LRUK_REPLACER_K,
+                            size_t max_pool_size = 0);
   /**
    * Creates a new BufferPoolManagerInstance.
    * @param pool_size the size of the buffer pool
@@ -43,9 +61,14 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    * @param instance_index index of this BPI in the parallel BPM
    * @param disk_manager the disk manager
    * @param log_manager the log manager (for testing only: nullptr = disable logging)
+   * @param replacer_type the replacement policy
+   * @param replacer_k the K of the LRU-K policy, ignored by the other policies
+   * @param max_pool_size the largest size Resize can grow the pool to, 0 for BUFFER_POOL_MAX_GROWTH times pool_size
    */
   BufferPoolManagerInstance(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
-                            DiskManager *disk_manager, LogManager *log_manager = nullptr);
+                            DiskManager *disk_manager, LogManager *log_manager = nullptr,
+                            ReplacerType replacer_type = ReplacerType::LRU, size_t replacer_k = LRUK_REPLACER_K,
+                            size_t max_pool_size = 0);
 
   /**
    * Destroys an existing BufferPoolManagerInstance.
@@ -55,9 +78,192 @@ class BufferPoolManagerInstance : public BufferPoolManager {
   /** @return size of the buffer pool */
   auto GetPoolSize() -> size_t override { return pool_size_; }
 
-  /** @return pointer to all the pages in the buffer pool */
+  /** @return pointer to the pages the buffer pool was created with, which stay in place across Resize calls */
   auto GetPages() -> Page * { return pages_; }
 
+  /** @return the largest size the buffer pool can be resized to */
+  auto GetMaxPoolSize() const -> size_t { return max_pool_size_; }
+
+  /**
+   * Grows or shrinks the buffer pool while it is in use. Growing adds free frames. Shrinking evicts the pages in the
+   * frames beyond the new size, writing back the dirty ones, and gives the memory of those frames back once no
+   * lock-free fetcher can still be looking at them. Frames are allocated in blocks, one per growth, and a block is
+   * only freed once all of its frames are gone.
+   * @param pool_size the new number of frames, between 1 and GetMaxPoolSize()
+   * @return false if the size is out of range, or if a page in a frame to be removed is pinned; the pool is then
+   * left as it was
+   */
+  auto Resize(size_t pool_size) -> bool override;
+
+  auto DropTablespaces(const std::vector<tablespace_id_t> &tablespaces) -> bool override;
+
+  /**
+   * Claims the frames holding pages of the tablespaces, so that nobody can pin them, after waiting for write-backs of
+   * their pages that are in flight. This is the first half of DropTablespaces, which every instance of a parallel pool
+   * does before any of them discards a page.
+   * @param tablespaces the tablespaces whose pages to claim
+   * @param[out] claimed the claimed frames
+   * @return false if a page of one of the tablespaces is pinned; no frame is claimed then
+   */
+  auto ClaimTablespaceFrames(const std::vector<tablespace_id_t> &tablespaces, std::vector<frame_id_t> *claimed)
+      -> bool;
+
+  /**
+   * Gives up the frames claimed by ClaimTablespaceFrames, leaving their pages as they were.
+   * @param claimed the frames claimed by ClaimTablespaceFrames
+   */
+  void UnclaimTablespaceFrames(const std::vector<frame_id_t> &claimed);
+
+  /**
+   * The second half of DropTablespaces: discards the pages in the frames claimed by ClaimTablespaceFrames without
+   * writing them back, along with the tablespaces' pages in the compressed tier and the prefetch queue.
+   * @param tablespaces the tablespaces passed to ClaimTablespaceFrames
+   * @param claimed the frames claimed by ClaimTablespaceFrames
+   */
+  void DiscardTablespaceFrames(const std::vector<tablespace_id_t> &tablespaces, const std::vector<frame_id_t> &claimed);
+
+  /** @return the resident pages, the next victim first and the pinned pages last */
+  auto GetResidentPages() -> std::vector<page_id_t>;
+
+  /**
+   * Reads the given pages of this instance into free frames, several at a time and in page id order, then unpins them
+   * in list order so that the replacer ends up ordering them the same way. Pages that belong to another instance,
+   * are not allocated or are already resident are skipped; if there are more pages than frames, the last ones win.
+   * @param page_ids pages in the order GetResidentPages lists them
+   * @return the number of pages read in
+   */
+  auto WarmUp(const std::vector<page_id_t> &page_ids) -> size_t;
+
+  /** Writes GetResidentPages to the warm-up file. */
+  void DumpResidentSet() override;
+
+  /**
+   * Warms up with the pages of this instance listed in the warm-up file.
+   * @return the number of pages read in
+   */
+  auto LoadResidentSet() -> size_t override;
+
+  /**
+   * Starts the background flusher thread. Every background_flush_interval, or sooner when a miss had to evict a dirty
+   * page, it looks at the frames closest to eviction and writes the dirty ones back ahead of time, until at least
+   * clean_target of the pool is free or clean and evictable. While it runs, eviction prefers clean frames among those,
+   * so that a miss usually only has to read. Does nothing if the flusher is already running.
+   * @param clean_target the fraction of the pool to keep free or clean and evictable, in (0, 1]
+   */
+  void StartBackgroundFlusher(double clean_target = BACKGROUND_FLUSH_CLEAN_TARGET);
+
+  /**
+   * Stops and joins the background flusher thread, if it is running.
+   */
+  void StopBackgroundFlusher();
+
+  /**
+   * Puts a compressed tier behind the buffer pool (see CompressedPageCache). Clean pages are compressed into it as
+   * they are evicted, and misses look there before reading from disk. Call it before the buffer pool takes any
+   * traffic. Does nothing if the tier is already enabled.
+   * @param capacity the most bytes of compressed pages the tier may hold
+   */
+  void EnableCompressedTier(size_t capacity);
+
+  /**
+   * Queues the given pages to be read in by the prefetch thread, which is started on first use. Requests beyond one
+   * pool's worth of queued pages are dropped. Once the strategy is active, the pages are read into frames of its ring
+   * instead, which are taken right away and take their ring slots; the prefetch thread only does the reads. The read
+   * ahead then leaves one frame of the ring that is not in use for the operation's own next miss, and takes no frame
+   * from the shared pool once the ring is full.
+   * @param page_ids ids of the pages to read ahead
+   * @param strategy the access strategy of the bulk operation that will fetch the pages, nullptr for the shared pool
+   */
+  void PrefetchPages(const std::vector<page_id_t> &page_ids, BufferAccessStrategy *strategy = nullptr) override;
+
+  /**
+   * Fetch the requested page on behalf of a bulk operation. Once the strategy is active, a miss reuses the frame of
+   * the strategy's current ring slot if it can, and the page then takes that slot.
+   * @param page_id id of page to be fetched
+   * @param strategy the bulk operation's access strategy, nullptr to use the shared pool
+   * @return the requested page
+   */
+  auto FetchPageWithStrategy(page_id_t page_id, BufferAccessStrategy *strategy) -> Page * override;
+
+  /**
+   * Fetch the requested page, pinning the hinted frame directly if it still holds the page. Like any other hit, that
+   * takes neither latch_ nor the page table. A hint that went stale, because the page was evicted, moved or the frame
+   * was removed by Resize, costs one failed pin before the regular fetch.
+   * @param page_id id of page to be fetched
+   * @param[in,out] frame_id the frame the page is expected in, -1 if unknown; set to the frame it was found in
+   * @return the requested page
+   */
+  auto FetchPageWithHint(page_id_t page_id, frame_id_t *frame_id) -> Page * override;
+
+  /**
+   * Fetch several pages in one call. The resident pages are pinned in one lock-free pass, and the rest are read in
+   * under a single acquisition of latch_.
+   * @param page_ids ids of the pages to be fetched
+   * @return the pages in the order of page_ids, with nullptr for each page that could not be fetched
+   */
+  auto FetchPages(const std::vector<page_id_t> &page_ids) -> std::vector<Page *> override;
+
+  /**
+   * Unpin several pages in one call. All the pins a page loses in the batch are dropped with a single update of its
+   * pin count, and the page is handed to the replacer at most once.
+   * @param page_ids ids of the pages to be unpinned
+   * @param is_dirty true if the pages should be marked as dirty, false otherwise
+   */
+  void UnpinPages(const std::vector<page_id_t> &page_ids, bool is_dirty) override;
+
+  /**
+   * Creates a new page on behalf of a bulk operation, taking the frame from the strategy's ring like
+   * FetchPageWithStrategy does.
+   * @param[out] page_id id of created page
+   * @param strategy the bulk operation's access strategy, nullptr to use the shared pool
+   * @param tablespace the tablespace to create the page in
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   * @throw Exception if the tablespace does not exist or is full
+   */
+  auto NewPageWithStrategy(page_id_t *page_id, BufferAccessStrategy *strategy,
+                           tablespace_id_t tablespace = DEFAULT_TABLESPACE) -> Page * override;
+
+  /**
+   * Creates a new page under the next id of an extent. An instance of a parallel pool owns only some of the ids of
+   * an extent and creates the page with NewPageWithStrategy instead; ParallelBufferPoolManager uses NewPageWithId.
+   * @param[out] page_id id of created page
+   * @param extent the extent of the object
+   * @param strategy the bulk operation's access strategy, nullptr to use the shared pool
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  auto NewPageInExtent(page_id_t *page_id, Extent *extent, BufferAccessStrategy *strategy = nullptr)
+      -> Page * override;
+
+  /**
+   * Creates a new page under an id that is allocated already, such as one taken from an extent. If no frame can be
+   * made free for it, the page is deallocated.
+   * @param page_id id of the page, which must map to this instance
+   * @param strategy the bulk operation's access strategy, nullptr to use the shared pool
+   * @return nullptr if the page could not be created, otherwise pointer to new page
+   */
+  auto NewPageWithId(page_id_t page_id, BufferAccessStrategy *strategy) -> Page *;
+
+  /**
+   * The first half of FlushAllPages, for callers that write the pages of several instances in one batch. Pins the
+   * dirty pages so that they stay put until ReleaseFlushedPages, and marks them clean.
+   * @param[out] pages (page id, raw page data) pairs of the pages to write, appended to
+   * @return the pinned frames, to be passed to ReleaseFlushedPages once the pages are written
+   */
+  auto CollectDirtyPages(std::vector<std::pair<page_id_t, const char *>> *pages) -> std::vector<frame_id_t>;
+
+  /**
+   * The second half of FlushAllPages: unpins the frames pinned by CollectDirtyPages.
+   * @param frames the frames returned by CollectDirtyPages
+   */
+  void ReleaseFlushedPages(const std::vector<frame_id_t> &frames);
+
+  /**
+   * Adds up the counters of this instance and of its replacer. Counters are bumped with relaxed atomics on
+   * per-thread shards, and only a contended latch_ is timed.
+   * @return the counters accumulated since the instance was created
+   */
+  auto GetStats() -> BufferPoolStats override;
+
  protected:
   /**
    * Fetch the requested page from the buffer pool.
@@ -96,23 +302,32 @@ class BufferPoolManagerInstance : public BufferPoolManager {
   auto DeletePgImp(page_id_t page_id) -> bool override;
 
   /**
-   * Flushes all the pages in the buffer pool to disk.
+   * Flushes all the pages in the buffer pool to disk, and syncs the database file so that they are durable.
    */
   void FlushAllPgsImp() override;
 
   /**
-   * Allocate a page on disk.∂
+   * Allocate a page on disk, reusing a deallocated page of this instance if there is one.
+   * @param tablespace the tablespace to allocate the page in
    * @return the id of the allocated page
    */
-  auto AllocatePage() -> page_id_t;
+  auto AllocatePage(tablespace_id_t tablespace = DEFAULT_TABLESPACE) -> page_id_t;
 
   /**
-   * Deallocate a page on disk.
+   * Puts a newly allocated page into a frame, the body of NewPageWithStrategy and NewPageWithId. Deallocates the page
+   * if no frame can be made free for it.
+   * @param page_id id of the page
+   * @param strategy the bulk operation's access strategy, nullptr to use the shared pool
+   * @param guard the held latch_, which is dropped while an evicted page is written back
+   * @return nullptr if no frame could be made free, otherwise pointer to the page
+   */
+  auto NewPageLocked(page_id_t page_id, BufferAccessStrategy *strategy, std::unique_lock<std::mutex> *guard) -> Page *;
+
+  /**
+   * Deallocate a page on disk, so that AllocatePage can hand it out again.
    * @param page_id id of the page to deallocate
    */
-  void DeallocatePage(__attribute__((unused)) page_id_t page_id) {
-    // This is a no-nop right now without a more complex data structure to track deallocated pages
-  }
+  void DeallocatePage(page_id_t page_id);
 
   /**
    * Validate that the page_id being used is accessible to this BPI. This can be used in all of the functions to
@@ -121,28 +336,296 @@ class BufferPoolManagerInstance : public BufferPoolManager {
    */
   void ValidatePageId(page_id_t page_id) const;
 
-  /** Number of pages in the buffer pool. */
-  const size_t pool_size_;
+  /** @return a lock on latch_, counting the time spent waiting for it if it is contended */
+  auto AcquireLatch() -> std::unique_lock<std::mutex>;
+
+  /**
+   * Lock latch_ again after it was released, counting the time spent waiting for it if it is contended.
+   * @param guard the released lock on latch_
+   */
+  void RelockLatch(std::unique_lock<std::mutex> *guard);
+
+  /** @return the nanoseconds elapsed since start */
+  static auto ElapsedNs(std::chrono::steady_clock::time_point start) -> uint64_t;
+
+  /**
+   * Fill a frame with a page that is not in the buffer pool, from the compressed tier if it holds the page and from
+   * disk otherwise. The frame must be marked as having I/O in progress.
+   * @param page_id the page to read
+   * @param frame_id the frame to read it into
+   */
+  void LoadPage(page_id_t page_id, frame_id_t frame_id);
+
+  /**
+   * Fill a batch of frames like LoadPage. The pages that are not in the compressed tier are read from disk together:
+   * adjacent ones with one preadv per run, or, when this is one of several instances and no two of its pages are
+   * adjacent, all in flight at once.
+   * @param pages (page, frame) pairs
+   */
+  void LoadPages(const std::vector<std::pair<page_id_t, frame_id_t>> &pages);
+
+  /**
+   * @param frame_id a frame below the pool size
+   * @return the page in the frame
+   */
+  auto Frame(frame_id_t frame_id) -> Page & { return *frames_[frame_id].load(std::memory_order_acquire); }
+
+  /**
+   * Makes the frames from the current pool size up to pool_size available, reusing the pages of a block that is
+   * still allocated and putting the rest in a new block. Must hold resize_latch_ but not latch_.
+   * @param pool_size the new number of frames
+   */
+  void Grow(size_t pool_size);
+
+  /**
+   * Evicts the pages in the frames from pool_size on and gives up the frames. Must hold resize_latch_ but not latch_.
+   * @param pool_size the new number of frames
+   * @return false if a page in one of the frames is pinned
+   */
+  auto Shrink(size_t pool_size) -> bool;
+
+  /**
+   * Pin a frame whose page was looked up without holding latch_. The caller must check that the frame still holds
+   * the page afterwards.
+   * @param frame_id the frame to pin
+   * @return false if the frame is free or being taken over by another page
+   */
+  auto TryPin(frame_id_t frame_id) -> bool;
+
+  /**
+   * Finish a lock-free hit on a frame pinned by TryPin: if the frame still holds the page, count the hit and wait for
+   * any read in flight, otherwise give the pin back.
+   * @param frame_id the pinned frame
+   * @param page_id the page the frame was expected to hold
+   * @return true if the frame holds the page, which stays pinned
+   */
+  auto CompleteHit(frame_id_t frame_id, page_id_t page_id) -> bool;
+
+  /**
+   * The rest of a fetch that the lock-free lookup could not pin: pin the page if it is resident after all, otherwise
+   * read it into a new frame. Must hold latch_ through guard.
+   * @param guard the held latch_, released while the page is read in
+   * @param page_id id of page to be fetched
+   * @param strategy the bulk operation's access strategy, nullptr to use the shared pool
+   * @return the requested page, nullptr if every frame is pinned
+   */
+  auto FetchWithLatch(std::unique_lock<std::mutex> *guard, page_id_t page_id, BufferAccessStrategy *strategy)
+      -> Page *;
+
+  /**
+   * Drop up to count pins from a page.
+   * @param page_id the page to unpin
+   * @param count the number of pins to drop
+   * @param is_dirty true if the page should be marked as dirty
+   * @return false if the page is not in the buffer pool
+   */
+  auto ReleasePins(page_id_t page_id, int count, bool is_dirty) -> bool;
+
+  /**
+   * Drop a pin, and hand the frame back to the replacer if it was the last one.
+   * @param frame_id the frame to unpin
+   */
+  void DropPin(frame_id_t frame_id);
+
+  /**
+   * Claim an unpinned frame for eviction or deletion, by moving its pin count from 0 to -1 so that lock-free
+   * fetchers can no longer pin it. Must hold latch_.
+   * @param frame_id the frame to claim
+   * @return false if somebody pinned the frame first
+   */
+  auto ClaimFrame(frame_id_t frame_id) -> bool;
+
+  /**
+   * Take a frame from the strategy's ring if possible, else from the free list, or from the replacer if the free list
+   * is empty. Must hold latch_.
+   * @param[out] frame_id the acquired frame
+   * @param strategy the active access strategy of a bulk operation, or nullptr
+   * @return false if every frame is pinned
+   */
+  auto AcquireFrame(frame_id_t *frame_id, BufferAccessStrategy *strategy = nullptr) -> bool;
+
+  /**
+   * Take the frame of a ring slot of the strategy whose page can be evicted, trying the slots from the current one on
+   * and skipping those whose pages are in use, such as pages still being read ahead. The slot found becomes the
+   * current one. Must hold latch_.
+   * @param strategy the active access strategy of a bulk operation
+   * @param[out] frame_id the frame of the slot
+   * @return false if the ring has to grow, in which case the current slot is one that is unused or whose page has left
+   * the pool, or if all the pages of the ring are in use
+   */
+  auto AcquireRingFrame(BufferAccessStrategy *strategy, frame_id_t *frame_id) -> bool;
+
+  /**
+   * Put a page that was just read in or created into the strategy's current ring slot, and move on to the next slot.
+   * Must hold latch_.
+   * @param strategy the active access strategy of a bulk operation
+   * @param page_id the page to put into the ring
+   */
+  void AddToRing(BufferAccessStrategy *strategy, page_id_t page_id);
+
+  /**
+   * Unmap the page currently held by an acquired frame. If that page is dirty it is registered in write_back_table_,
+   * and the caller must write it back once latch_ has been released. Must hold latch_.
+   * @param frame_id the frame returned by AcquireFrame
+   * @return the id of the page that needs to be written back, or INVALID_PAGE_ID
+   */
+  auto EvictFrame(frame_id_t frame_id) -> page_id_t;
+
+  /**
+   * Map a page to an acquired frame and read it in. latch_ is released during the I/O, while the frame is flagged
+   * with io_in_progress_ so that concurrent fetchers of the page wait for it. The frame is left pinned once, and the
+   * replacer records that pin as an access only if record_access is set. Must hold latch_.
+   * @param guard the held lock on latch_
+   * @param frame_id the frame returned by AcquireFrame
+   * @param page_id the page to read
+   * @param record_access false for reads nobody has asked for yet
+   */
+  void ReadPageIntoFrame(std::unique_lock<std::mutex> *guard, frame_id_t frame_id, page_id_t page_id,
+                         bool record_access);
+
+  /**
+   * The first half of ReadPageIntoFrame: evict the frame and map the page to it, flagged with io_in_progress_. The
+   * caller does the I/O with latch_ released and then calls FinishIo. Must hold latch_.
+   * @param frame_id the frame returned by AcquireFrame
+   * @param page_id the page to read
+   * @param record_access false for reads nobody has asked for yet
+   * @return the page the caller must write back from the frame before reading, or INVALID_PAGE_ID
+   */
+  auto PublishFrame(frame_id_t frame_id, page_id_t page_id, bool record_access) -> page_id_t;
+
+  /** A read ahead whose frame has been taken and published, see PublishFrame. */
+  struct PrefetchRead {
+    page_id_t page_id_;
+    frame_id_t frame_id_;
+    page_id_t write_back_page_id_;
+  };
+
+  /**
+   * Main loop of the prefetch thread. It takes the reads already given ring frames and then the queue in batches, and
+   * reads each batch with LoadPages.
+   */
+  void Prefetch();
+
+  /**
+   * Block until no I/O is in progress on the given frame. latch_ is released while waiting.
+   * @param guard the held lock on latch_
+   * @param frame_id the frame to wait for
+   */
+  void WaitForIo(std::unique_lock<std::mutex> *guard, frame_id_t frame_id);
+
+  /**
+   * Block until no write-back of the given page is in flight. latch_ is released while waiting.
+   * @param guard the held lock on latch_
+   * @param page_id the page to wait for
+   */
+  void WaitForWriteBack(std::unique_lock<std::mutex> *guard, page_id_t page_id);
+
+  /**
+   * Mark the I/O on a frame as finished and wake up its waiters. Must hold latch_.
+   * @param frame_id the frame whose I/O finished
+   * @param write_back_page_id the page that was written back from the frame, or INVALID_PAGE_ID
+   */
+  void FinishIo(frame_id_t frame_id, page_id_t write_back_page_id);
+
+  /** @return the number of frames closest to eviction that the background flusher keeps clean. Must hold latch_. */
+  auto CleanWindow() const -> size_t;
+
+  /** Main loop of the background flusher thread. */
+  void BackgroundFlush();
+
+  /**
+   * Writes back the dirty unpinned pages among the frames closest to eviction. The frames are pinned behind the
+   * replacer's back while latch_ is released, so that they keep their place in the eviction order. Must hold latch_.
+   * @param guard the held lock on latch_
+   */
+  void FlushEvictionCandidates(std::unique_lock<std::mutex> *guard);
+
+  /** Number of pages in the buffer pool. Only changes under both resize_latch_ and latch_. */
+  std::atomic<size_t> pool_size_;
+  /** The largest pool_size_ can grow to. Every per-frame structure other than the pages is sized for it. */
+  const size_t max_pool_size_;
   /** How many instances are in the parallel BPM (if present, otherwise just 1 BPI) */
   const uint32_t num_instances_ = 1;
   /** Index of this BPI in the parallel BPM (if present, otherwise just 0) */
   const uint32_t instance_index_ = 0;
-  /** Each BPI maintains its own counter for page_ids to hand out, must ensure they mod back to its instance_index_ */
-  std::atomic<page_id_t> next_page_id_ = instance_index_;
-
-  /** Array of buffer pool pages. */
+  /** The pages the buffer pool was created with, the first entry of blocks_. */
   Page *pages_;
+  /** The page in each frame, nullptr for frames beyond pool_size_. */
+  std::atomic<Page *> *frames_;
+  /** A run of frames allocated together: the pages that describe them, and the arena that holds their data. */
+  struct FrameBlock {
+    size_t first_frame_;
+    size_t num_frames_;
+    Page *pages_;
+    FrameArena *arena_;
+  };
+  /**
+   * Allocate a run of frames. Their data starts out zeroed.
+   * @param first_frame the frame id of the first frame
+   * @param num_frames the number of frames
+   * @return the new block
+   */
+  static auto NewFrameBlock(size_t first_frame, size_t num_frames) -> FrameBlock;
+  /** Free a run of frames allocated by NewFrameBlock. */
+  static void DeleteFrameBlock(const FrameBlock &block);
+  /** The allocated runs of frames. Protected by resize_latch_. */
+  std::vector<FrameBlock> blocks_;
+  /** Lock-free fetchers and unpinners in flight, which Shrink waits for before freeing frames. */
+  OptimisticReaders optimistic_readers_;
   /** Pointer to the disk manager. */
   DiskManager *disk_manager_ __attribute__((__unused__));
   /** Pointer to the log manager. */
   LogManager *log_manager_ __attribute__((__unused__));
-  /** Page table for keeping track of buffer pool pages. */
-  std::unordered_map<page_id_t, frame_id_t> page_table_;
+  /** Page table for keeping track of buffer pool pages. Read without latch_ by FetchPage and UnpinPage hits. */
+  PageTable page_table_;
   /** Replacer to find unpinned pages for replacement. */
   Replacer *replacer_;
   /** List of free pages. */
   std::list<frame_id_t> free_list_;
-  /** This latch protects shared data structures. We recommend updating this comment to describe what it protects. */
+  /**
+   * Pages whose write-back is still in flight, mapped to the frame they are written from: pages evicted while dirty,
+   * and pages the background flusher is writing.
+   */
+  std::unordered_map<page_id_t, frame_id_t> write_back_table_;
+  /** One condition variable per frame, signalled when I/O on that frame finishes. Waited on with latch_. */
+  std::condition_variable *io_cv_;
+  /** The background flusher thread, nullptr if it is not running. */
+  std::thread *flush_thread_ = nullptr;
+  /** The fraction of the pool the background flusher keeps free or clean. */
+  double clean_target_ = 0;
+  /** Set to stop the background flusher. */
+  bool stop_flush_thread_ = false;
+  /** Set by a miss that had to evict a dirty page, to wake up the background flusher early. */
+  bool flush_requested_ = false;
+  /** Signalled to wake up the background flusher. Waited on with latch_. */
+  std::condition_variable flush_cv_;
+  /** The prefetch thread, nullptr until the first prefetch request. */
+  std::thread *prefetch_thread_ = nullptr;
+  /** Pages waiting to be read ahead. */
+  std::deque<page_id_t> prefetch_queue_;
+  /** Reads ahead into ring frames, which PrefetchPages has published already; their frames stay pinned until read. */
+  std::vector<PrefetchRead> prefetch_ring_reads_;
+  /** Set to stop the prefetch thread. */
+  bool stop_prefetch_thread_ = false;
+  /** Signalled when pages are queued for prefetching. Waited on with latch_. */
+  std::condition_variable prefetch_cv_;
+  /** Counters reported by GetStats. */
+  StatCounter num_hits_;
+  StatCounter num_misses_;
+  StatCounter num_evictions_;
+  StatCounter num_dirty_write_backs_;
+  StatCounter num_no_free_frame_failures_;
+  StatCounter latch_wait_ns_;
+  StatCounter disk_read_ns_;
+  /** The compressed tier, nullptr unless EnableCompressedTier was called. */
+  CompressedPageCache *compressed_tier_{nullptr};
+  /**
+   * This latch serializes the writers of page_table_, and protects write_back_table_, free_list_ and the background
+   * thread state. Pages are pinned without it, so a frame is only reused after ClaimFrame succeeds. It is never
+   * held across disk I/O: frames being read or written back are flagged with io_in_progress_ instead.
+   */
   std::mutex latch_;
+  /** Serializes Resize calls. Taken before latch_. */
+  std::mutex resize_latch_;
 };
 }  // namespace bustub
@@ -0,0 +1,112 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_stats.h
+//
+// Identification: src/include/buffer/buffer_pool_stats.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <thread>  // NOLINT
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * A snapshot of the counters of a buffer pool, as returned by BufferPoolManager::GetStats. Times are in nanoseconds.
+ */
+struct BufferPoolStats {
+  /** Fetches of pages that were already in the pool. */
+  uint64_t hits_{0};
+  /** Fetches that had to read the page from disk. */
+  uint64_t misses_{0};
+  /** Pages that were evicted to make room for another page. */
+  uint64_t evictions_{0};
+  /** Evicted pages that were dirty and had to be written back. */
+  uint64_t dirty_write_backs_{0};
+  /** FetchPage and NewPage calls that failed because every frame was pinned. */
+  uint64_t no_free_frame_failures_{0};
+  /** Frames the replacer handed out as victims, including ones the pool then found pinned again. */
+  uint64_t replacer_victims_{0};
+  /** Time spent waiting for latch_ while another thread held it. */
+  uint64_t latch_wait_ns_{0};
+  /** Time spent reading pages from disk. */
+  uint64_t disk_read_ns_{0};
+  /** Misses that found the page in the compressed tier. */
+  uint64_t tier_hits_{0};
+  /** Misses that looked in the compressed tier and had to read the page from disk. */
+  uint64_t tier_misses_{0};
+  /** Pages held in the compressed tier. */
+  uint64_t tier_pages_{0};
+  /** Bytes taken by the pages in the compressed tier. */
+  uint64_t tier_bytes_{0};
+
+  /** @return the fraction of fetches that were hits, or 0 if there were none */
+  auto HitRatio() const -> double {
+    return hits_ + misses_ == 0 ? 0 : static_cast<double>(hits_) / static_cast<double>(hits_ + misses_);
+  }
+
+  /** @return how many times smaller the pages in the compressed tier are than uncompressed, or 0 if it is empty */
+  auto TierCompressionRatio() const -> double {
+    return tier_bytes_ == 0 ? 0 : static_cast<double>(tier_pages_ * PAGE_SIZE) / static_cast<double>(tier_bytes_);
+  }
+
+  auto operator+=(const BufferPoolStats &other) -> BufferPoolStats & {
+    hits_ += other.hits_;
+    misses_ += other.misses_;
+    evictions_ += other.evictions_;
+    dirty_write_backs_ += other.dirty_write_backs_;
+    no_free_frame_failures_ += other.no_free_frame_failures_;
+    replacer_victims_ += other.replacer_victims_;
+    latch_wait_ns_ += other.latch_wait_ns_;
+    disk_read_ns_ += other.disk_read_ns_;
+    tier_hits_ += other.tier_hits_;
+    tier_misses_ += other.tier_misses_;
+    tier_pages_ += other.tier_pages_;
+    tier_bytes_ += other.tier_bytes_;
+    return *this;
+  }
+};
+
+/**
+ * A counter that many threads can bump without contending on one cache line. Each thread adds to one of a few
+ * padded shards with a relaxed atomic increment; reads add the shards up.
+ */
+class StatCounter {
+ public:
+  /** Adds to the counter. */
+  void Add(uint64_t delta = 1) { shards_[ShardIndex()].value_.fetch_add(delta, std::memory_order_relaxed); }
+
+  /** @return the sum of everything added so far */
+  auto Get() const -> uint64_t {
+    uint64_t sum = 0;
+    for (const auto &shard : shards_) {
+      sum += shard.value_.load(std::memory_order_relaxed);
+    }
+    return sum;
+  }
+
+ private:
+  static constexpr size_t NUM_SHARDS = 16;
+
+  static auto ShardIndex() -> size_t {
+    static thread_local const size_t index = std::hash<std::thread::id>{}(std::this_thread::get_id()) % NUM_SHARDS;
+    return index;
+  }
+
+  struct alignas(64) Shard {
+    std::atomic<uint64_t> value_{0};
+  };
+  Shard shards_[NUM_SHARDS];
+};
+
+}  // namespace bustub
@@ -12,7 +12,7 @@
 
 #pragma once
 
-#include <list>
+#include <atomic>
 #include <mutex>  // NOLINT
 #include <vector>
 
@@ -23,6 +23,11 @@ namespace bustub {
 
 /**
  * ClockReplacer implements the clock replacement policy, which approximates the Least Recently Used policy.
+ *
+ * Pin and Unpin are lock-free: they only set the frame's reference bit and flip its evictable flag with atomic
+ * operations, so buffer pool hits never contend on a replacer mutex. Only the sweeping hand in Victim is serialized.
+ * A frame is handed out by Victim only if Victim is the one that clears its evictable flag, so a concurrent Pin either
+ * wins and keeps the frame, or loses and finds it already gone.
  */
 class ClockReplacer : public Replacer {
  public:
@@ -45,8 +50,22 @@ class ClockReplacer : public Replacer {
 
   auto Size() -> size_t override;
 
+  auto Candidates(size_t max_count) -> std::vector<frame_id_t> override;
+
+  auto VictimPreferring(frame_id_t *frame_id, const std::function<bool(frame_id_t)> &prefer, size_t window)
+      -> bool override;
+
  private:
-  // TODO(student): implement me!
+  const size_t num_pages_;
+  /** Reference bit per frame, set on every access and cleared as the hand passes. */
+  std::vector<std::atomic<bool>> ref_;
+  /** True if the frame is in the replacer, i.e. unpinned and evictable. */
+  std::vector<std::atomic<bool>> evictable_;
+  /** Number of evictable frames. */
+  std::atomic<size_t> size_{0};
+  /** Position of the clock hand. Protected by hand_latch_. */
+  size_t hand_{0};
+  std::mutex hand_latch_;
 };
 
 }  // namespace bustub
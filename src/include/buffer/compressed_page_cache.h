@@ -0,0 +1,103 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compressed_page_cache.h
+//
+// Identification: src/include/buffer/compressed_page_cache.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <list>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+
+#include "buffer/buffer_pool_stats.h"
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * CompressedPageCache is a second tier behind a buffer pool: it keeps clean pages that were evicted from the pool,
+ * compressed with LZCodec, so that a miss on one of them costs a decompression instead of a disk read.
+ *
+ * The cache is exclusive of the pool. A page enters when the pool evicts it clean and leaves when the pool reads it
+ * back, so memory is never spent on two copies of a page. The compressed pages take at most capacity bytes; the least
+ * recently inserted ones are dropped to make room. Pages that do not compress are not kept. The cache is thread-safe.
+ */
+class CompressedPageCache {
+ public:
+  /**
+   * Creates a new CompressedPageCache.
+   * @param capacity the most bytes of compressed pages to keep
+   */
+  explicit CompressedPageCache(size_t capacity);
+
+  DISALLOW_COPY_AND_MOVE(CompressedPageCache);
+
+  /**
+   * Compresses and keeps a page that matches its copy on disk, replacing any older copy.
+   * @param page_id id of the page
+   * @param data the PAGE_SIZE bytes of the page
+   */
+  void Insert(page_id_t page_id, const char *data);
+
+  /**
+   * Moves a page out of the cache.
+   * @param page_id id of the page
+   * @param[out] data the PAGE_SIZE bytes of the page
+   * @return false if the cache does not hold the page
+   */
+  auto Take(page_id_t page_id, char *data) -> bool;
+
+  /**
+   * Drops a page, because the copy kept here is out of date or the page was deleted.
+   * @param page_id id of the page
+   */
+  void Erase(page_id_t page_id);
+
+  /**
+   * Drops the pages of a tablespace, because it is being dropped.
+   * @param tablespace the tablespace, see DiskManager::TablespaceOf
+   */
+  void EraseTablespace(tablespace_id_t tablespace);
+
+  /**
+   * Adds the cache's counters to a snapshot of its buffer pool's counters.
+   * @param[in,out] stats the snapshot
+   */
+  void CollectStats(BufferPoolStats *stats);
+
+ private:
+  struct Entry {
+    std::string data_;
+    /** Where the page is in lru_list_. */
+    std::list<page_id_t>::iterator lru_position_;
+  };
+
+  /**
+   * Drops a page. Must hold latch_.
+   * @param it the page's entry
+   * @return the compressed page
+   */
+  auto Remove(std::unordered_map<page_id_t, Entry>::iterator it) -> std::string;
+
+  const size_t capacity_;
+  /** The compressed pages. */
+  std::unordered_map<page_id_t, Entry> pages_;
+  /** The pages in the order they were inserted, most recent first. */
+  std::list<page_id_t> lru_list_;
+  /** The total size of the compressed pages. */
+  size_t size_{0};
+  uint64_t hits_{0};
+  uint64_t misses_{0};
+  std::mutex latch_;
+};
+
+}  // namespace bustub
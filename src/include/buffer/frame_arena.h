@@ -0,0 +1,68 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.h
+//
+// Identification: src/include/buffer/frame_arena.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * FrameArena is the memory behind a run of buffer pool frames: one contiguous, page-aligned mapping of PAGE_SIZE bytes
+ * per frame, kept apart from the Page objects that describe the frames. Being page-aligned, frames can be read and
+ * written by a DiskManager in direct I/O mode without a bounce buffer.
+ *
+ * The memory comes straight from the kernel, so it starts out zeroed and is only backed by physical pages once it is
+ * touched. Arenas of at least one huge page are aligned to the huge page size, and, if BUFFER_POOL_HUGE_PAGES is on,
+ * advised to be backed by transparent huge pages, which cuts the TLB misses of a large pool. The advice is only a hint:
+ * the arena works the same if the kernel does not follow it.
+ */
+class FrameArena {
+ public:
+  /**
+   * Maps the memory for a run of frames.
+   * @param num_frames the number of frames
+   * @throw Exception if the memory cannot be mapped
+   */
+  explicit FrameArena(size_t num_frames);
+
+  /**
+   * Unmaps the memory.
+   */
+  ~FrameArena();
+
+  DISALLOW_COPY_AND_MOVE(FrameArena);
+
+  /**
+   * @param index the index of a frame in the arena
+   * @return the PAGE_SIZE bytes of that frame
+   */
+  auto GetFrame(size_t index) const -> char * { return data_ + index * PAGE_SIZE; }
+
+  /** @return true if the arena was advised to be backed by huge pages */
+  auto IsHugePageBacked() const -> bool { return huge_pages_; }
+
+ private:
+  static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+  /** The start of the frames. */
+  char *data_{nullptr};
+  /** The start and length of the whole mapping. */
+  void *mapping_{nullptr};
+  size_t mapping_size_{0};
+  bool huge_pages_{false};
+};
+
+}  // namespace bustub
@@ -0,0 +1,102 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer.h
+//
+// Identification: src/include/buffer/lru_k_replacer.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <list>
+#include <mutex>  // NOLINT
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * LRUKReplacer implements the LRU-K replacement policy.
+ *
+ * The victim is the evictable frame with the largest backward K-distance, i.e. the longest time since its K-th most
+ * recent access. Frames with fewer than K recorded accesses have an infinite distance and are evicted first, oldest
+ * first access first. A single sequential scan therefore only evicts pages that were touched once, and pages that are
+ * referenced repeatedly stay resident.
+ *
+ * The access history of evicted pages is kept in a bounded history table keyed by page id, so that a page which is
+ * evicted and read back soon afterwards is not treated as brand new.
+ */
+class LRUKReplacer : public Replacer {
+ public:
+  /**
+   * Create a new LRUKReplacer.
+   * @param num_pages the maximum number of frames the LRUKReplacer will be required to store
+   * @param k the number of most recent accesses used to compute the backward K-distance
+   */
+  LRUKReplacer(size_t num_pages, size_t k);
+
+  /**
+   * Destroys the LRUKReplacer.
+   */
+  ~LRUKReplacer() override;
+
+  auto Victim(frame_id_t *frame_id) -> bool override;
+
+  /** Records an access to the frame and makes it non-evictable. */
+  void Pin(frame_id_t frame_id) override;
+
+  void Unpin(frame_id_t frame_id) override;
+
+  auto Size() -> size_t override;
+
+  auto Candidates(size_t max_count) -> std::vector<frame_id_t> override;
+
+  auto VictimPreferring(frame_id_t *frame_id, const std::function<bool(frame_id_t)> &prefer, size_t window)
+      -> bool override;
+
+  void SetPageId(frame_id_t frame_id, page_id_t page_id) override;
+
+ private:
+  /** Eviction key: the timestamp ordering a frame within its group, then the frame id. */
+  using Key = std::pair<size_t, frame_id_t>;
+
+  struct FrameEntry {
+    /** Timestamps of the last (up to) K accesses, oldest first. */
+    std::list<size_t> history_;
+    /** The page held by the frame, INVALID_PAGE_ID if unknown. */
+    page_id_t page_id_{INVALID_PAGE_ID};
+    bool evictable_{false};
+  };
+
+  void RecordAccess(FrameEntry *entry);
+  void AddEvictable(frame_id_t frame_id, const FrameEntry &entry);
+  void RemoveEvictable(frame_id_t frame_id, const FrameEntry &entry);
+  /** Remove an evictable frame from its group and reset it, remembering the history of the page it held. */
+  void Evict(std::set<Key> *group, std::set<Key>::iterator it);
+  /** Remember the history of a page that is being evicted, dropping the oldest remembered page if needed. */
+  void RetainHistory(page_id_t page_id, std::list<size_t> &&history);
+
+  const size_t num_pages_;
+  const size_t k_;
+  size_t current_timestamp_{0};
+  std::vector<FrameEntry> frames_;
+  /** Evictable frames with fewer than K accesses, keyed by their first recorded access. */
+  std::set<Key> infinite_distance_;
+  /** Evictable frames with K accesses, keyed by their K-th most recent access. */
+  std::set<Key> finite_distance_;
+  /** History table of recently evicted pages, oldest eviction first. */
+  std::list<std::pair<page_id_t, std::list<size_t>>> evicted_history_;
+  std::unordered_map<page_id_t, decltype(evicted_history_)::iterator> evicted_index_;
+  std::mutex lock_;
+};
+
+}  // namespace bustub
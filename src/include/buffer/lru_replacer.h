@@ -46,6 +46,11 @@ class LRUReplacer : public Replacer {
 
   auto Size() -> size_t override;
 
+  auto Candidates(size_t max_count) -> std::vector<frame_id_t> override;
+
+  auto VictimPreferring(frame_id_t *frame_id, const std::function<bool(frame_id_t)> &prefer, size_t window)
+      -> bool override;
+
  private:
   // TODO(student): implement me!
    std::list<frame_id_t> unpin_list_;
@@ -0,0 +1,111 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// mmap_buffer_pool_manager.h
+//
+// Identification: src/include/buffer/mmap_buffer_pool_manager.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * MmapBufferPoolManager serves the pages of a database file that is never written, such as that of a read-only
+ * reporting replica, straight out of a read-only mapping of the file. Fetching a page hands out a Page whose data
+ * points into the mapping: nothing is copied, there are no frames to run out of, and nothing is ever evicted, so pins
+ * are not tracked either. The kernel page cache is the only cache.
+ *
+ * The pool covers the pages the file had when it was created. Anything that would write is rejected with an Exception:
+ * NewPage, DeletePage, unpinning a page as dirty, and write-latching a page, which every writer does before changing
+ * it. Writing to the data of a page without the latch faults.
+ */
+class MmapBufferPoolManager : public BufferPoolManager {
+ public:
+  /**
+   * Creates a buffer pool over a read-only mapping of the database file.
+   * @param disk_manager the disk manager of the file, which must outlive the buffer pool
+   * @throw Exception if the file cannot be mapped
+   */
+  explicit MmapBufferPoolManager(DiskManager *disk_manager);
+
+  /**
+   * Destroys the page views. The mapping belongs to the disk manager.
+   */
+  ~MmapBufferPoolManager() override;
+
+  /** @return the number of pages in the file when the pool was created */
+  auto GetPoolSize() -> size_t override { return num_pages_; }
+
+  /**
+   * Advises the kernel to read the given pages into the page cache in the background.
+   * @param page_ids ids of the pages to read ahead
+   * @param strategy ignored, as the kernel decides what stays in the page cache
+   */
+  void PrefetchPages(const std::vector<page_id_t> &page_ids, BufferAccessStrategy *strategy = nullptr) override;
+
+ protected:
+  /**
+   * Hands out the view of a page.
+   * @param page_id id of the page
+   * @return the page, or nullptr if it is not in the file
+   */
+  auto FetchPgImp(page_id_t page_id) -> Page * override;
+
+  /**
+   * Does nothing, as pins are not tracked.
+   * @param page_id id of the page
+   * @param is_dirty must be false
+   * @return true if the page is in the file
+   * @throw Exception if is_dirty is set
+   */
+  auto UnpinPgImp(page_id_t page_id, bool is_dirty) -> bool override;
+
+  /**
+   * Does nothing, as no page is ever dirty.
+   * @param page_id id of the page
+   * @return true if the page is in the file
+   */
+  auto FlushPgImp(page_id_t page_id) -> bool override;
+
+  /**
+   * @throw Exception always: the pool is read-only
+   */
+  auto NewPgImp(page_id_t *page_id) -> Page * override;
+
+  /**
+   * @throw Exception always: the pool is read-only
+   */
+  auto DeletePgImp(page_id_t page_id) -> bool override;
+
+  /**
+   * Does nothing, as no page is ever dirty.
+   */
+  void FlushAllPgsImp() override {}
+
+ private:
+  /** @return true if the page is in the mapping */
+  auto IsMapped(page_id_t page_id) const -> bool {
+    return page_id >= 0 && static_cast<size_t>(page_id) < num_pages_;
+  }
+
+  /** The start of the mapping, nullptr if the file was empty. */
+  const char *mapping_;
+  /** Number of pages in the mapping. */
+  const size_t num_pages_;
+  /** The view of each page, made the first time the page is fetched. */
+  std::atomic<Page *> *views_;
+};
+
+}  // namespace bustub
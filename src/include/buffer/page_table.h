@@ -0,0 +1,133 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.h
+//
+// Identification: src/include/buffer/page_table.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <thread>  // NOLINT
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * PageTable maps the ids of the pages resident in a buffer pool to the frames that hold them.
+ *
+ * It is a fixed-capacity open-addressing hash table with linear probing, sized so that it is at most half full when
+ * every frame is in use. Each slot packs a page id and a frame id into one 64-bit atomic word, so lookups are lock-free
+ * and never see a torn entry. Insert and Remove must be serialized by the caller; Remove closes the gap it leaves by
+ * shifting later entries of the probe sequence back, so no tombstones build up.
+ *
+ * A lookup that races with a writer may miss an entry that is being shifted, or return an entry that has just been
+ * removed. Lock-free callers must therefore validate the frame they find, and treat a miss as "look again under the
+ * latch".
+ */
+class PageTable {
+ public:
+  /**
+   * Creates a new PageTable.
+   * @param num_frames the number of frames in the buffer pool, i.e. the maximum number of entries
+   */
+  explicit PageTable(size_t num_frames);
+
+  /**
+   * Destroys the PageTable.
+   */
+  ~PageTable();
+
+  DISALLOW_COPY_AND_MOVE(PageTable);
+
+  /**
+   * Looks up the frame holding a page. Lock-free.
+   * @param page_id the page to look up
+   * @param[out] frame_id the frame holding the page
+   * @return true if the page was found
+   */
+  auto Find(page_id_t page_id, frame_id_t *frame_id) const -> bool;
+
+  /**
+   * Maps a page to a frame, replacing any existing mapping of the page.
+   * @param page_id the page
+   * @param frame_id the frame holding it
+   */
+  void Insert(page_id_t page_id, frame_id_t frame_id);
+
+  /**
+   * Removes the mapping of a page, if there is one.
+   * @param page_id the page
+   */
+  void Remove(page_id_t page_id);
+
+ private:
+  /** An all-ones word, i.e. INVALID_PAGE_ID mapped to frame -1. */
+  static constexpr uint64_t EMPTY_SLOT = ~static_cast<uint64_t>(0);
+
+  static auto Pack(page_id_t page_id, frame_id_t frame_id) -> uint64_t {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(page_id)) << 32) | static_cast<uint32_t>(frame_id);
+  }
+  static auto PageOf(uint64_t slot) -> page_id_t { return static_cast<page_id_t>(slot >> 32); }
+  static auto FrameOf(uint64_t slot) -> frame_id_t { return static_cast<frame_id_t>(slot & 0xFFFFFFFF); }
+
+  /** @return the first slot of the probe sequence of a page */
+  auto Home(page_id_t page_id) const -> size_t;
+
+  /** log2 of the number of slots. */
+  size_t bits_{1};
+  /** Number of slots minus one. */
+  size_t mask_;
+  std::atomic<uint64_t> *slots_;
+};
+
+/**
+ * OptimisticReaders tracks the threads that are reading the page table without a latch, so that memory they may
+ * still reach through an entry that was just removed is only reclaimed once they are done. Each thread registers on
+ * one of a few padded shards, so readers do not contend on one cache line.
+ */
+class OptimisticReaders {
+ public:
+  /** Registers the calling thread as a reader. Must come before its lookups. */
+  void Enter() { shards_[ShardIndex()].count_.fetch_add(1); }
+
+  /** Unregisters the calling thread. */
+  void Exit() { shards_[ShardIndex()].count_.fetch_sub(1); }
+
+  /**
+   * Blocks until every reader that entered before the call has exited. Readers that enter later can no longer see
+   * entries removed before the call.
+   */
+  void WaitForReaders() const {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    for (const auto &shard : shards_) {
+      while (shard.count_.load() != 0) {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+ private:
+  static constexpr size_t NUM_SHARDS = 16;
+
+  static auto ShardIndex() -> size_t {
+    static thread_local const size_t index = std::hash<std::thread::id>{}(std::this_thread::get_id()) % NUM_SHARDS;
+    return index;
+  }
+
+  struct alignas(64) Shard {
+    std::atomic<int64_t> count_{0};
+  };
+  Shard shards_[NUM_SHARDS];
+};
+
+}  // namespace bustub
@@ -12,13 +12,21 @@
 
 #pragma once
 
+#include <atomic>
+#include <vector>
+
 #include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_manager_instance.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
 #include "storage/page/page.h"
 
 namespace bustub {
 
+/**
+ * ParallelBufferPoolManager shards pages over several BufferPoolManagerInstances, each with its own latch. A page is
+ * always owned by instance `page_id % num_instances`.
+ */
 class ParallelBufferPoolManager : public BufferPoolManager {
  public:
   /**
@@ -39,6 +47,107 @@ class ParallelBufferPoolManager : public BufferPoolManager {
   /** @return size of the buffer pool */
   auto GetPoolSize() -> size_t override;
 
+  /**
+   * Resizes every instance, spreading the new size evenly over them. The number of instances stays the same, since
+   * it decides which instance owns which page ids.
+   * @param pool_size the new total number of frames, at least one per instance
+   * @return false if some instance could not be resized; the others keep their new size
+   */
+  auto Resize(size_t pool_size) -> bool override;
+
+  /**
+   * Discards the pages of the tablespaces from every instance, then drops them on disk. Every instance claims the
+   * frames of the tablespaces before any of them discards a page.
+   * @param tablespaces the tablespaces to drop
+   * @return false if a page of one of the tablespaces is pinned; all of them are then left as they were
+   */
+  auto DropTablespaces(const std::vector<tablespace_id_t> &tablespaces) -> bool override;
+
+  /** Writes the resident pages of all instances to the warm-up file. */
+  void DumpResidentSet() override;
+
+  /**
+   * Warms up every instance with its pages from the warm-up file, all instances at once.
+   * @return the number of pages read in
+   */
+  auto LoadResidentSet() -> size_t override;
+
+  /**
+   * Starts the background flusher of every instance.
+   * @param clean_target the fraction of each instance to keep free or clean and evictable
+   */
+  void StartBackgroundFlusher(double clean_target = BACKGROUND_FLUSH_CLEAN_TARGET);
+
+  /** Stops the background flusher of every instance. */
+  void StopBackgroundFlusher();
+
+  /**
+   * Puts a compressed tier behind every instance, splitting the capacity between them evenly.
+   * @param capacity the most bytes of compressed pages all the tiers together may hold
+   */
+  void EnableCompressedTier(size_t capacity);
+
+  /**
+   * Hands each page to be read ahead to the instance that owns it.
+   * @param page_ids ids of the pages to read ahead
+   * @param strategy the access strategy of the bulk operation, whose rings the instances read into
+   */
+  void PrefetchPages(const std::vector<page_id_t> &page_ids, BufferAccessStrategy *strategy = nullptr) override;
+
+  /**
+   * Fetch the requested page from the instance that owns it, using that instance's ring of the strategy.
+   * @param page_id id of page to be fetched
+   * @param strategy the bulk operation's access strategy, nullptr to use the shared pool
+   * @return the requested page
+   */
+  auto FetchPageWithStrategy(page_id_t page_id, BufferAccessStrategy *strategy) -> Page * override;
+
+  /**
+   * Fetch the requested page from the instance that owns it. Frame ids are local to that instance.
+   * @param page_id id of page to be fetched
+   * @param[in,out] frame_id the frame the page is expected in, -1 if unknown; set to the frame it was found in
+   * @return the requested page
+   */
+  auto FetchPageWithHint(page_id_t page_id, frame_id_t *frame_id) -> Page * override;
+
+  /**
+   * Fetch several pages in one call, as one batch per instance that owns some of them.
+   * @param page_ids ids of the pages to be fetched
+   * @return the pages in the order of page_ids, with nullptr for each page that could not be fetched
+   */
+  auto FetchPages(const std::vector<page_id_t> &page_ids) -> std::vector<Page *> override;
+
+  /**
+   * Unpin several pages in one call, as one batch per instance that owns some of them.
+   * @param page_ids ids of the pages to be unpinned
+   * @param is_dirty true if the pages should be marked as dirty, false otherwise
+   */
+  void UnpinPages(const std::vector<page_id_t> &page_ids, bool is_dirty) override;
+
+  /**
+   * Creates a new page in the first instance, in round robin order, that can make room for it.
+   * @param[out] page_id id of created page
+   * @param strategy the bulk operation's access strategy, nullptr to use the shared pool
+   * @param tablespace the tablespace to create the page in
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   * @throw Exception if the tablespace does not exist or is full
+   */
+  auto NewPageWithStrategy(page_id_t *page_id, BufferAccessStrategy *strategy,
+                           tablespace_id_t tablespace = DEFAULT_TABLESPACE) -> Page * override;
+
+  /**
+   * Creates a new page under the next id of an extent, in the instance that the id maps to.
+   * @param[out] page_id id of created page
+   * @param extent the extent of the object
+   * @param strategy the bulk operation's access strategy, nullptr to use the shared pool
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  auto NewPageInExtent(page_id_t *page_id, Extent *extent, BufferAccessStrategy *strategy = nullptr)
+      -> Page * override;
+
+  /** @return the counters of all instances added up */
+  auto GetStats() -> BufferPoolStats override;
+
  protected:
   /**
    * @param page_id id of page
@@ -86,5 +195,13 @@ class ParallelBufferPoolManager : public BufferPoolManager {
    * Flushes all the pages in the buffer pool to disk.
    */
   void FlushAllPgsImp() override;
+
+ private:
+  /** The individual buffer pool instances; instance i owns the page ids that are congruent to i. */
+  std::vector<BufferPoolManagerInstance *> instances_;
+  /** The disk manager the instances share. */
+  DiskManager *disk_manager_;
+  /** The instance that the next NewPgImp call starts looking for a free frame in. */
+  std::atomic<size_t> next_instance_{0};
 };
 }  // namespace bustub
@@ -0,0 +1,89 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// pin_cache.h
+//
+// Identification: src/include/buffer/pin_cache.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * PinCache keeps the pages a reader keeps coming back to pinned between uses, so that a sequential scan pins each table
+ * page once instead of once per tuple. The cache holds one pin per page. When it is full, the pins of the older half of
+ * its pages are released together through BufferPoolManager::UnpinPages; Flush releases the rest.
+ *
+ * Pages fetched through the cache are for reading only, and must not be unpinned by the caller. A page stays valid
+ * until the next fetch through the cache that is not for one of the capacity / 2 most recently fetched pages. A
+ * PinCache is not thread-safe; every executor context has its own.
+ */
+class PinCache {
+ public:
+  /**
+   * Creates a new PinCache.
+   * @param buffer_pool_manager the buffer pool the pages are fetched from
+   * @param capacity the number of pages to keep pinned, at least 2
+   */
+  explicit PinCache(BufferPoolManager *buffer_pool_manager, size_t capacity = PIN_CACHE_SIZE);
+
+  /**
+   * Creates the pin cache for the readers of a buffer pool. It keeps up to PIN_CACHE_SIZE pages pinned, but never more
+   * than 1 / PIN_CACHE_POOL_FRACTION of the pool, so that its pins do not starve the other users of a small pool.
+   * @param buffer_pool_manager the buffer pool the pages are fetched from
+   * @return the new PinCache, nullptr if the pool is too small to spare the 2 pins a cache needs at least
+   */
+  static auto ForPool(BufferPoolManager *buffer_pool_manager) -> std::unique_ptr<PinCache>;
+
+  /**
+   * Releases the pins still held.
+   */
+  ~PinCache() { Flush(); }
+
+  DISALLOW_COPY_AND_MOVE(PinCache);
+
+  /**
+   * Fetch a page, pinning it only if the cache does not hold it yet.
+   * @param page_id id of page to be fetched
+   * @param strategy the bulk operation's access strategy, nullptr to use the shared pool
+   * @return the requested page, nullptr if it could not be fetched
+   */
+  auto FetchPage(page_id_t page_id, BufferAccessStrategy *strategy = nullptr) -> Page *;
+
+  /**
+   * Releases all the pins the cache holds.
+   */
+  void Flush();
+
+  /** @return the number of pages the cache keeps pinned */
+  auto Size() const -> size_t { return pages_.size(); }
+
+  /** @return the number of pages the cache keeps pinned at most */
+  auto Capacity() const -> size_t { return capacity_; }
+
+ private:
+  /**
+   * Releases the pins of the oldest pages.
+   * @param count the number of pages to release
+   */
+  void Release(size_t count);
+
+  BufferPoolManager *buffer_pool_manager_;
+  size_t capacity_;
+  /** The pinned pages, least recently fetched first. */
+  std::vector<std::pair<page_id_t, Page *>> pages_;
+};
+
+}  // namespace bustub
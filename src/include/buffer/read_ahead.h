@@ -0,0 +1,62 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// read_ahead.h
+//
+// Identification: src/include/buffer/read_ahead.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * ReadAheadWindow detects a scan that moves through pages in ascending page id order, and asks the buffer pool to
+ * read the pages in front of it ahead of time.
+ *
+ * Scans follow page links, so the ids of the upcoming pages are a guess. It holds for table heaps and leaf chains that
+ * grew in order, because their pages were allocated one after the other. The window starts at READ_AHEAD_MIN_WINDOW
+ * pages once a scan looks sequential, and doubles each time the scan reaches the second half of what was read ahead,
+ * so that it keeps ahead of fast scans. It is capped at READ_AHEAD_MAX_WINDOW pages and at a quarter of the buffer
+ * pool, or at half the ring of a scan with an access strategy, so that the pages read ahead are not evicted before
+ * they are used. A jump outside the window resets it.
+ */
+class ReadAheadWindow {
+ public:
+  /**
+   * Creates a new ReadAheadWindow.
+   * @param buffer_pool_manager the buffer pool to read ahead into, nullptr to disable read-ahead
+   * @param strategy the access strategy of the scan, so that pages read ahead go into its ring; nullptr for none
+   */
+  explicit ReadAheadWindow(BufferPoolManager *buffer_pool_manager = nullptr, BufferAccessStrategy *strategy = nullptr);
+
+  /**
+   * Reports that the scan moves on from one page to the next, and reads ahead if the scan looks sequential.
+   * Call it before fetching the next page, so that its read overlaps with the ones issued here.
+   * @param from the page the scan is leaving
+   * @param to the page the scan moves to
+   */
+  void Advance(page_id_t from, page_id_t to);
+
+  /** @return the current window size in pages, 0 if the scan does not look sequential */
+  auto GetWindowSize() const -> size_t { return window_; }
+
+ private:
+  BufferPoolManager *buffer_pool_manager_;
+  BufferAccessStrategy *strategy_;
+  /** The largest window for this buffer pool. */
+  size_t max_window_{0};
+  /** The current window size. */
+  size_t window_{0};
+  /** One past the last page read ahead. */
+  page_id_t prefetched_until_{INVALID_PAGE_ID};
+};
+
+}  // namespace bustub
@@ -12,6 +12,11 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
 #include "common/config.h"
 
 namespace bustub {
@@ -45,6 +50,55 @@ class Replacer {
 
   /** @return the number of elements in the replacer that can be victimized */
   virtual auto Size() -> size_t = 0;
+
+  /**
+   * Tells the replacer which page a frame now holds. Policies that remember the history of evicted pages use this to
+   * recognize a page that is read back in; the others ignore it.
+   * @param frame_id the id of the frame that was just filled
+   * @param page_id the id of the page it now holds
+   */
+  virtual void SetPageId(frame_id_t frame_id, page_id_t page_id) {}
+
+  /**
+   * Lists the frames that Victim would pick next, without removing them.
+   * @param max_count the maximum number of frames to list
+   * @return up to max_count evictable frames, most likely victim first
+   */
+  virtual auto Candidates(size_t max_count) -> std::vector<frame_id_t> { return {}; }
+
+  /**
+   * Remove a victim frame, preferring one that satisfies prefer. Only the first window frames in eviction order are
+   * considered for the preference; if none of them satisfies it, the frame Victim would have picked is removed.
+   * @param[out] frame_id id of frame that was removed
+   * @param prefer predicate selecting the frames to evict first
+   * @param window how far down the eviction order to look for a preferred frame
+   * @return true if a victim frame was found, false otherwise
+   */
+  virtual auto VictimPreferring(frame_id_t *frame_id, const std::function<bool(frame_id_t)> &prefer, size_t window)
+      -> bool {
+    return Victim(frame_id);
+  }
+
+  /** @return the number of victims handed out so far */
+  auto GetNumVictims() const -> uint64_t { return num_victims_.load(std::memory_order_relaxed); }
+
+  /** @return the number of victim requests that found no evictable frame */
+  auto GetNumFailedVictims() const -> uint64_t { return num_failed_victims_.load(std::memory_order_relaxed); }
+
+ protected:
+  /**
+   * Counts the outcome of a Victim or VictimPreferring call. Implementations return through this.
+   * @param found whether a victim was found
+   * @return found
+   */
+  auto CountVictim(bool found) -> bool {
+    (found ? num_victims_ : num_failed_victims_).fetch_add(1, std::memory_order_relaxed);
+    return found;
+  }
+
+ private:
+  std::atomic<uint64_t> num_victims_{0};
+  std::atomic<uint64_t> num_failed_victims_{0};
 };
 
 }  // namespace bustub
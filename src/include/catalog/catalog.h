@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -69,15 +70,17 @@ struct IndexInfo {
    * @param index_oid The unique OID for the index
    * @param table_name The name of the table on which the index is created
    * @param key_size The size of the index key, in bytes
+   * @param tablespace The tablespace the pages of the index are in
    */
   IndexInfo(Schema key_schema, std::string name, std::unique_ptr<Index> &&index, index_oid_t index_oid,
-            std::string table_name, size_t key_size)
+            std::string table_name, size_t key_size, tablespace_id_t tablespace = DEFAULT_TABLESPACE)
       : key_schema_{std::move(key_schema)},
         name_{std::move(name)},
         index_{std::move(index)},
         index_oid_{index_oid},
         table_name_{std::move(table_name)},
-        key_size_{key_size} {}
+        key_size_{key_size},
+        tablespace_{tablespace} {}
   /** The schema for the index key */
   Schema key_schema_;
   /** The name of the index */
@@ -90,6 +93,8 @@ struct IndexInfo {
   std::string table_name_;
   /** The size of the index key, in bytes */
   const size_t key_size_;
+  /** The tablespace the pages of the index are in */
+  const tablespace_id_t tablespace_;
 };
 
 /**
@@ -110,9 +115,12 @@ class Catalog {
    * @param bpm The buffer pool manager backing tables created by this catalog
    * @param lock_manager The lock manager in use by the system
    * @param log_manager The log manager in use by the system
+   * @param disk_manager The disk manager to give each table and index a tablespace of its own in, so that dropping
+   * it deletes a file; nullptr to keep them all in the db file
    */
-  Catalog(BufferPoolManager *bpm, LockManager *lock_manager, LogManager *log_manager)
-      : bpm_{bpm}, lock_manager_{lock_manager}, log_manager_{log_manager} {}
+  Catalog(BufferPoolManager *bpm, LockManager *lock_manager, LogManager *log_manager,
+          DiskManager *disk_manager = nullptr)
+      : bpm_{bpm}, lock_manager_{lock_manager}, log_manager_{log_manager}, disk_manager_{disk_manager} {}
 
   /**
    * Create a new table and return its metadata.
@@ -127,7 +135,7 @@ class Catalog {
     }
 
     // Construct the table heap
-    auto table = std::make_unique<TableHeap>(bpm_, lock_manager_, log_manager_, txn);
+    auto table = std::make_unique<TableHeap>(bpm_, lock_manager_, log_manager_, txn, NewTablespace());
 
     // Fetch the table OID for the new table
     const auto table_oid = next_table_oid_.fetch_add(1);
@@ -214,12 +222,14 @@ class Catalog {
     // TODO(Kyle): We should update the API for CreateIndex
     // to allow specification of the index type itself, not
     // just the key, value, and comparator types
-    auto index = std::make_unique<BPlusTreeIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_);
+    const tablespace_id_t tablespace = NewTablespace();
+    auto index = std::make_unique<BPlusTreeIndex<KeyType, ValueType, KeyComparator>>(std::move(meta), bpm_, tablespace);
 
-    // Populate the index with all tuples in table heap
+    // Populate the index with all tuples in table heap, keeping a large heap from wiping out the buffer pool
     auto *table_meta = GetTable(table_name);
     auto *heap = table_meta->table_.get();
-    for (auto tuple = heap->Begin(txn); tuple != heap->End(); ++tuple) {
+    BufferAccessStrategy strategy(BufferAccessType::BULK_READ, BULK_READ_RING_SIZE, bpm_->GetPoolSize() / 4);
+    for (auto tuple = heap->Begin(txn, &strategy); tuple != heap->End(); ++tuple) {
       index->InsertEntry(tuple->KeyFromTuple(schema, key_schema, key_attrs), tuple->GetRid(), txn);
     }
 
@@ -227,8 +237,8 @@ class Catalog {
     const auto index_oid = next_index_oid_.fetch_add(1);
 
     // Construct index information; IndexInfo takes ownership of the Index itself
-    auto index_info =
-        std::make_unique<IndexInfo>(key_schema, index_name, std::move(index), index_oid, table_name, keysize);
+    auto index_info = std::make_unique<IndexInfo>(key_schema, index_name, std::move(index), index_oid, table_name,
+                                                  keysize, tablespace);
     auto *tmp = index_info.get();
 
     // Update internal tracking
@@ -321,10 +331,71 @@ class Catalog {
     return indexes;
   }
 
+  /**
+   * Drop the index `index_name` of table `table_name`. An index in a tablespace of its own takes the tablespace along.
+   * @param txn The transaction in which the index is being dropped
+   * @param index_name The name of the index
+   * @param table_name The name of the table on which the index is created
+   * @return false if there is no such index, or if a page of it is in use
+   */
+  auto DropIndex(Transaction *txn, const std::string &index_name, const std::string &table_name) -> bool {
+    auto *index_info = GetIndex(index_name, table_name);
+    if (index_info == NULL_INDEX_INFO || !DropObjectTablespace(index_info->tablespace_)) {
+      return false;
+    }
+    index_names_.find(table_name)->second.erase(index_name);
+    indexes_.erase(index_info->index_oid_);
+    return true;
+  }
+
+  /**
+   * Drop the table `table_name` and its indexes. A table in a tablespace of its own takes the tablespace along, and
+   * so do its indexes. Tables in the db file leave their pages allocated.
+   * @param txn The transaction in which the table is being dropped
+   * @param table_name The name of the table
+   * @return false if there is no such table, or if a page of it or of one of its indexes is in use; the table and
+   * all of its indexes are then left as they were
+   */
+  auto DropTable(Transaction *txn, const std::string &table_name) -> bool {
+    auto *table_info = GetTable(table_name);
+    if (table_info == NULL_TABLE_INFO) {
+      return false;
+    }
+    // All the tablespaces go in one call, so that a page in use in any of them leaves every one of them in place.
+    std::vector<IndexInfo *> indexes = GetTableIndexes(table_name);
+    std::vector<tablespace_id_t> tablespaces;
+    for (auto *index_info : indexes) {
+      tablespaces.push_back(index_info->tablespace_);
+    }
+    tablespaces.push_back(table_info->table_->GetTablespace());
+    tablespaces.erase(std::remove(tablespaces.begin(), tablespaces.end(), DEFAULT_TABLESPACE), tablespaces.end());
+    if (!tablespaces.empty() && !bpm_->DropTablespaces(tablespaces)) {
+      return false;
+    }
+    for (auto *index_info : indexes) {
+      indexes_.erase(index_info->index_oid_);
+    }
+    index_names_.erase(table_name);
+    table_names_.erase(table_name);
+    tables_.erase(table_info->oid_);
+    return true;
+  }
+
  private:
+  /** @return a new tablespace for a table or index, DEFAULT_TABLESPACE if objects do not get one of their own */
+  auto NewTablespace() -> tablespace_id_t {
+    return disk_manager_ != nullptr ? disk_manager_->CreateTablespace() : DEFAULT_TABLESPACE;
+  }
+
+  /** Drops the tablespace of a table or index, unless it is the db file. @return false if a page of it is pinned */
+  auto DropObjectTablespace(tablespace_id_t tablespace) -> bool {
+    return tablespace == DEFAULT_TABLESPACE || bpm_->DropTablespace(tablespace);
+  }
+
   [[maybe_unused]] BufferPoolManager *bpm_;
   [[maybe_unused]] LockManager *lock_manager_;
   [[maybe_unused]] LogManager *log_manager_;
+  DiskManager *disk_manager_;
 
   /**
    * Map table identifier -> table metadata.
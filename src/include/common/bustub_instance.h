@@ -13,6 +13,7 @@
 #include <string>
 
 #include "buffer/buffer_pool_manager_instance.h"
+#include "buffer/parallel_buffer_pool_manager.h"
 #include "common/config.h"
 #include "concurrency/lock_manager.h"
 #include "recovery/checkpoint_manager.h"
@@ -23,16 +24,36 @@ namespace bustub {
 
 class BustubInstance {
  public:
-  explicit BustubInstance(const std::string &db_file_name) {
+  /**
+   * Creates a new BustubInstance.
+   * @param db_file_name the database file
+   * @param num_instances number of buffer pool shards; more than one selects a ParallelBufferPoolManager
+   */
+  explicit BustubInstance(const std::string &db_file_name, size_t num_instances = 1)
+      : BustubInstance(new DiskManager(db_file_name), num_instances) {}
+
+  /**
+   * Creates a new BustubInstance on a given disk, such as a DiskManagerMemory that simulates one.
+   * @param disk_manager the disk manager, which the instance takes over and deletes
+   * @param num_instances number of buffer pool shards; more than one selects a ParallelBufferPoolManager
+   */
+  explicit BustubInstance(DiskManager *disk_manager, size_t num_instances = 1) {
     enable_logging = false;
 
     // storage related
-    disk_manager_ = new DiskManager(db_file_name);
+    disk_manager_ = disk_manager;
 
     // log related
     log_manager_ = new LogManager(disk_manager_);
 
-    buffer_pool_manager_ = new BufferPoolManagerInstance(BUFFER_POOL_SIZE, disk_manager_, log_manager_);
+    if (num_instances > 1) {
+      buffer_pool_manager_ =
+          new ParallelBufferPoolManager(num_instances, BUFFER_POOL_SIZE, disk_manager_, log_manager_);
+    } else {
+      buffer_pool_manager_ = new BufferPoolManagerInstance(BUFFER_POOL_SIZE, disk_manager_, log_manager_);
+    }
+    // bring back the pages that were resident at the last shutdown
+    buffer_pool_manager_->LoadResidentSet();
 
     // txn related
     lock_manager_ = new LockManager();
@@ -48,6 +69,7 @@ class BustubInstance {
     }
     delete checkpoint_manager_;
     delete log_manager_;
+    buffer_pool_manager_->DumpResidentSet();
     delete buffer_pool_manager_;
     delete lock_manager_;
     delete transaction_manager_;
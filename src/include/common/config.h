@@ -27,6 +27,9 @@ extern std::atomic<bool> enable_logging;
 /** If ENABLE_LOGGING is true, the log should be flushed to disk every LOG_TIMEOUT. */
 extern std::chrono::duration<int64_t> log_timeout;
 
+/** A running background flusher looks for dirty pages close to eviction every BACKGROUND_FLUSH_INTERVAL. */
+extern std::chrono::milliseconds background_flush_interval;
+
 static constexpr int INVALID_PAGE_ID = -1;                                    // invalid page id
 static constexpr int INVALID_TXN_ID = -1;                                     // invalid transaction id
 static constexpr int INVALID_LSN = -1;                                        // invalid log sequence number
@@ -35,12 +38,29 @@ static constexpr int PAGE_SIZE = 4096;                                        //
 static constexpr int BUFFER_POOL_SIZE = 10;                                   // size of buffer pool
 static constexpr int LOG_BUFFER_SIZE = ((BUFFER_POOL_SIZE + 1) * PAGE_SIZE);  // size of a log buffer in byte
 static constexpr int BUCKET_SIZE = 50;                                        // size of extendible hash bucket
+static constexpr int LRUK_REPLACER_K = 2;                                     // lookback window for lru-k replacer
+static constexpr double BACKGROUND_FLUSH_CLEAN_TARGET = 0.25;                 // share of frames kept clean by flusher
+static constexpr int READ_AHEAD_MIN_WINDOW = 4;                               // initial read-ahead window in pages
+static constexpr int READ_AHEAD_MAX_WINDOW = 64;                              // largest read-ahead window in pages
+static constexpr int BULK_READ_RING_SIZE = 32;                                // frames in a bulk-read ring
+static constexpr int BULK_WRITE_RING_SIZE = 256;                              // frames in a bulk-write ring
+static constexpr int BUFFER_POOL_MAX_GROWTH = 4;                              // default resize limit, x initial size
+static constexpr int IO_QUEUE_DEPTH = 64;                                     // async disk I/Os in flight at once
+static constexpr int IO_THREAD_POOL_SIZE = 4;                                 // async I/O threads without io_uring
+static constexpr bool BUFFER_POOL_HUGE_PAGES = true;                          // back large buffer pools by huge pages
+static constexpr int PIN_CACHE_SIZE = 8;                                      // pages a pin cache keeps pinned
+static constexpr int PIN_CACHE_POOL_FRACTION = 16;                            // pin cache limit, 1/n of the pool
+static constexpr int DEFAULT_TABLESPACE = 0;                                  // the tablespace of the db file
+static constexpr int TABLESPACE_PAGE_BITS = 24;                               // page id bits of the page number
+static constexpr int MAX_TABLESPACES = 1 << (31 - TABLESPACE_PAGE_BITS);      // tablespaces, db file included
+static constexpr int EXTENT_SIZE = 64;                                        // pages reserved at once per object
 
-using frame_id_t = int32_t;    // frame id type
-using page_id_t = int32_t;     // page id type
-using txn_id_t = int32_t;      // transaction id type
-using lsn_t = int32_t;         // log sequence number type
-using slot_offset_t = size_t;  // slot offset type
+using frame_id_t = int32_t;       // frame id type
+using page_id_t = int32_t;        // page id type
+using tablespace_id_t = int32_t;  // tablespace id type
+using txn_id_t = int32_t;         // transaction id type
+using lsn_t = int32_t;            // log sequence number type
+using slot_offset_t = size_t;     // slot offset type
 using oid_t = uint16_t;
 
 }  // namespace bustub
@@ -0,0 +1,53 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lz_codec.h
+//
+// Identification: src/include/common/util/lz_codec.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+
+namespace bustub {
+
+/**
+ * LZCodec is a small LZ77 compressor in the style of LZ4, fast enough to run on every page eviction.
+ *
+ * The output is a series of sequences. Each one starts with a token byte, whose high nibble is the number of literals
+ * and whose low nibble is the match length minus 4; a nibble of 15 is followed by bytes of 255 and a final byte that
+ * add up to the rest of the length. The literals follow the token, then a two-byte little-endian offset back into the
+ * output and the rest of the match length. The last sequence only has literals. Matches are found through a table of
+ * the last position of each hashed 4-byte string, so compression takes one pass and a fixed amount of memory.
+ */
+class LZCodec {
+ public:
+  /** @return the largest size that Compress can produce for size bytes of input */
+  static auto MaxCompressedSize(size_t size) -> size_t { return size + size / 255 + 16; }
+
+  /**
+   * Compresses a buffer.
+   * @param src the bytes to compress
+   * @param size the number of bytes to compress
+   * @param[out] dst the compressed bytes, at least MaxCompressedSize(size) of them
+   * @return the number of compressed bytes
+   */
+  static auto Compress(const char *src, size_t size, char *dst) -> size_t;
+
+  /**
+   * Decompresses a buffer produced by Compress.
+   * @param src the compressed bytes
+   * @param src_size the number of compressed bytes
+   * @param[out] dst the decompressed bytes
+   * @param size the number of bytes the input was compressed from
+   * @return false if src is not the compressed form of exactly size bytes
+   */
+  static auto Decompress(const char *src, size_t src_size, char *dst, size_t size) -> bool;
+};
+
+}  // namespace bustub
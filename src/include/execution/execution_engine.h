@@ -67,6 +67,9 @@ class ExecutionEngine {
     } catch (Exception &e) {
       // TODO(student): handle exceptions
     }
+    if (exec_ctx->GetPinCache() != nullptr) {
+      exec_ctx->GetPinCache()->Flush();
+    }
 
     return true;
   }
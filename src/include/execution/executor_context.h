@@ -12,10 +12,13 @@
 
 #pragma once
 
+#include <memory>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
+#include "buffer/buffer_access_strategy.h"
+#include "buffer/pin_cache.h"
 #include "catalog/catalog.h"
 #include "concurrency/transaction.h"
 #include "storage/page/tmp_tuple_page.h"
@@ -36,7 +39,12 @@ class ExecutorContext {
    */
   ExecutorContext(Transaction *transaction, Catalog *catalog, BufferPoolManager *bpm, TransactionManager *txn_mgr,
                   LockManager *lock_mgr)
-      : transaction_(transaction), catalog_{catalog}, bpm_{bpm}, txn_mgr_(txn_mgr), lock_mgr_(lock_mgr) {}
+      : transaction_(transaction),
+        catalog_{catalog},
+        bpm_{bpm},
+        txn_mgr_(txn_mgr),
+        lock_mgr_(lock_mgr),
+        pin_cache_(bpm != nullptr ? PinCache::ForPool(bpm) : nullptr) {}
 
   ~ExecutorContext() = default;
 
@@ -60,6 +68,22 @@ class ExecutorContext {
   /** @return the transaction manager */
   auto GetTransactionManager() -> TransactionManager * { return txn_mgr_; }
 
+  /**
+   * @return the pin cache that the executors read table pages through, flushed when a query is done; nullptr if the
+   * buffer pool is too small to spare its pins
+   */
+  auto GetPinCache() -> PinCache * { return pin_cache_.get(); }
+
+  /**
+   * Creates the buffer access strategy for a sequential scan. The scan reads through the shared buffer pool until it
+   * has touched more than a quarter of the pool, and is confined to a bulk-read ring from then on.
+   * @return the strategy for one scan
+   */
+  auto CreateScanStrategy() -> std::unique_ptr<BufferAccessStrategy> {
+    return std::make_unique<BufferAccessStrategy>(BufferAccessType::BULK_READ, BULK_READ_RING_SIZE,
+                                                  bpm_->GetPoolSize() / 4);
+  }
+
  private:
   /** The transaction context associated with this executor context */
   Transaction *transaction_;
@@ -71,6 +95,8 @@ class ExecutorContext {
   TransactionManager *txn_mgr_;
   /** The lock manager associated with this executor context */
   LockManager *lock_mgr_;
+  /** The pins the executors of this context keep between tuples, nullptr if there is no pin cache */
+  std::unique_ptr<PinCache> pin_cache_;
 };
 
 }  // namespace bustub
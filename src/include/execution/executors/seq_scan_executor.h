@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <memory>
 #include <vector>
 
 #include "execution/executor_context.h"
@@ -52,5 +53,7 @@ class SeqScanExecutor : public AbstractExecutor {
   const SeqScanPlanNode *plan_;
   TableIterator iter_;
   TableInfo *table_;
+  /** Keeps a large scan from wiping out the buffer pool */
+  std::unique_ptr<BufferAccessStrategy> strategy_;
 };
 }  // namespace bustub
@@ -0,0 +1,163 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// async_io.h
+//
+// Identification: src/include/storage/disk/async_io.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <sys/types.h>
+
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * AsyncIo keeps many reads and writes of a file in flight at once. Each request is a single pread or pwrite; its
+ * callback gets what that call would have returned, or -errno, and runs on a thread of the backend, so it must be
+ * short and must not submit more I/O and wait for it.
+ */
+class AsyncIo {
+ public:
+  /** Called with the number of bytes transferred, or -errno. */
+  using Callback = std::function<void(ssize_t)>;
+
+  virtual ~AsyncIo() = default;
+
+  /**
+   * Creates the best backend available: io_uring where the kernel supports it, an IoThreadPool otherwise.
+   * @param queue_depth the number of requests io_uring keeps in flight
+   * @param num_threads the number of threads of the fallback pool
+   * @return the new backend
+   */
+  static auto Create(size_t queue_depth, size_t num_threads) -> AsyncIo *;
+
+  /**
+   * Starts reading from a file.
+   * @param fd the file
+   * @param buf where to read to
+   * @param size the number of bytes to read
+   * @param offset where in the file to read from
+   * @param callback called once the read is done
+   */
+  virtual void SubmitRead(int fd, char *buf, size_t size, int64_t offset, Callback callback) = 0;
+
+  /**
+   * Starts writing to a file.
+   * @param fd the file
+   * @param buf what to write
+   * @param size the number of bytes to write
+   * @param offset where in the file to write to
+   * @param callback called once the write is done
+   */
+  virtual void SubmitWrite(int fd, const char *buf, size_t size, int64_t offset, Callback callback) = 0;
+
+  /** @return the name of the backend, for logging */
+  virtual auto GetName() const -> const char * = 0;
+};
+
+/**
+ * IoThreadPool is the portable AsyncIo backend: a fixed number of threads that run the requests with pread and
+ * pwrite, in the order they were submitted. The destructor waits for the requests submitted so far.
+ */
+class IoThreadPool : public AsyncIo {
+ public:
+  /**
+   * Starts the threads.
+   * @param num_threads the number of requests run at once
+   */
+  explicit IoThreadPool(size_t num_threads);
+
+  ~IoThreadPool() override;
+
+  DISALLOW_COPY_AND_MOVE(IoThreadPool);
+
+  void SubmitRead(int fd, char *buf, size_t size, int64_t offset, Callback callback) override;
+  void SubmitWrite(int fd, const char *buf, size_t size, int64_t offset, Callback callback) override;
+  auto GetName() const -> const char * override { return "thread pool"; }
+
+ private:
+  void Work();
+
+  std::vector<std::thread> threads_;
+  std::deque<std::function<void()>> requests_;
+  bool stop_{false};
+  std::mutex latch_;
+  std::condition_variable cv_;
+};
+
+/**
+ * IoUring is the AsyncIo backend for Linux: requests go to the kernel through an io_uring submission queue, and a
+ * thread reaps the completion queue and runs the callbacks. It talks to the kernel through the raw system calls, so
+ * it needs no library. The destructor waits for the requests in flight.
+ */
+class IoUring : public AsyncIo {
+ public:
+  /**
+   * Sets up the ring.
+   * @param queue_depth the number of requests in flight at once; submitting more waits for completions
+   * @return the new backend, nullptr if the kernel does not support io_uring
+   */
+  static auto Create(size_t queue_depth) -> IoUring *;
+
+  ~IoUring() override;
+
+  DISALLOW_COPY_AND_MOVE(IoUring);
+
+  void SubmitRead(int fd, char *buf, size_t size, int64_t offset, Callback callback) override;
+  void SubmitWrite(int fd, const char *buf, size_t size, int64_t offset, Callback callback) override;
+  auto GetName() const -> const char * override { return "io_uring"; }
+
+ private:
+  IoUring() = default;
+
+  /** Maps the rings of ring_fd_. */
+  auto MapRings() -> bool;
+  /** Queues one request and tells the kernel about it. */
+  void Submit(uint8_t opcode, int fd, const char *buf, size_t size, int64_t offset, Callback callback);
+  /** Reaps completions until the stop request comes back, or stop_ is set. */
+  void Reap();
+
+  int ring_fd_{-1};
+  unsigned queue_depth_{0};
+  /** The rings shared with the kernel, and their size. */
+  void *sq_ring_{nullptr};
+  size_t sq_ring_size_{0};
+  void *cq_ring_{nullptr};
+  size_t cq_ring_size_{0};
+  void *sqes_{nullptr};
+  size_t sqes_size_{0};
+  /** Fields of the rings. */
+  unsigned *sq_tail_{nullptr};
+  unsigned *sq_mask_{nullptr};
+  unsigned *sq_array_{nullptr};
+  unsigned *cq_head_{nullptr};
+  unsigned *cq_tail_{nullptr};
+  unsigned *cq_mask_{nullptr};
+  void *cqes_{nullptr};
+  /** Requests submitted and not yet completed, protected by latch_. */
+  size_t in_flight_{0};
+  /** Set once nothing is in flight anymore and the reaper is to stop. */
+  std::atomic<bool> stop_{false};
+  std::thread reaper_;
+  /** Serializes submissions, and guards in_flight_. */
+  std::mutex latch_;
+  std::condition_variable cv_;
+};
+
+}  // namespace bustub
@@ -12,55 +12,202 @@
 
 #pragma once
 
+#include <array>
 #include <atomic>
 #include <fstream>
 #include <future>  // NOLINT
 #include <mutex>   // NOLINT
+#include <set>
+#include <shared_mutex>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "common/config.h"
+#include "storage/disk/async_io.h"
 
 namespace bustub {
 
 /**
  * DiskManager takes care of the allocation and deallocation of pages within a database. It performs the reading and
  * writing of pages to and from disk, providing a logical file layer within the context of a database management system.
+ *
+ * The pages live in tablespaces, each a file of its own. Tablespace DEFAULT_TABLESPACE is the db file; the others are
+ * created on demand, typically one per table or index, next to it. A page id holds the number of its tablespace in the
+ * bits above TABLESPACE_PAGE_BITS and its page number within the tablespace below them, so the pages of the db file
+ * keep the ids they always had, and the pages of a tablespace lie in id order in its file.
  */
 class DiskManager {
  public:
   /**
    * Creates a new disk manager that writes to the specified database file.
    * @param db_file the file name of the database file to write to
+   * @param direct_io read and write the database file with O_DIRECT, bypassing the kernel page cache, so that pages
+   * are cached only once, in the buffer pool. Falls back to buffered I/O if the file system does not support it.
    */
-  explicit DiskManager(const std::string &db_file);
+  explicit DiskManager(const std::string &db_file, bool direct_io = false);
 
-  ~DiskManager() = default;
+  /**
+   * Closes the database file if ShutDown did not.
+   */
+  virtual ~DiskManager();
 
   /**
-   * Shut down the disk manager and close all the file resources.
+   * Shut down the disk manager and close all the file resources. Reading or writing pages afterwards throws, so the
+   * buffer pools on top of the disk manager have to be destroyed first.
    */
   void ShutDown();
 
   /**
-   * Write a page to the database file.
+   * Write a page to the database file. Pages are written with pwrite at their own offset, so writes and reads of
+   * different pages run in parallel. The page reaches the operating system right away, but is only durable after the
+   * next Sync.
    * @param page_id id of the page
    * @param page_data raw page data
    */
-  void WritePage(page_id_t page_id, const char *page_data);
+  virtual void WritePage(page_id_t page_id, const char *page_data);
 
   /**
-   * Read a page from the database file.
+   * Read a page from the database file. Pages past the end of the file read as zeros.
    * @param page_id id of the page
    * @param[out] page_data output buffer
    */
-  void ReadPage(page_id_t page_id, char *page_data);
+  virtual void ReadPage(page_id_t page_id, char *page_data);
+
+  /**
+   * Write a batch of pages and Sync once at the end. The pages are written in page id order, and each run of pages
+   * with consecutive ids goes out in a single pwritev.
+   * @param pages (page id, raw page data) pairs, in any order; of a page listed twice, the later data is written
+   */
+  virtual void WritePages(std::vector<std::pair<page_id_t, const char *>> pages);
+
+  /**
+   * Read a batch of pages, each run of pages with consecutive ids with a single preadv. Pages past the end of the file
+   * read as zeros.
+   * @param pages (page id, output buffer) pairs, in any order
+   */
+  virtual void ReadPages(std::vector<std::pair<page_id_t, char *>> pages);
+
+  /**
+   * Start writing a page, without waiting for the write. Any number of writes may be in flight; they go through
+   * io_uring where the kernel has it, and through a pool of IO_THREAD_POOL_SIZE threads otherwise.
+   * @param page_id id of the page
+   * @param page_data raw page data, which must stay untouched until the write is done
+   * @return a future that becomes ready once the page is written
+   */
+  virtual auto WritePageAsync(page_id_t page_id, const char *page_data) -> std::future<void>;
+
+  /**
+   * Start reading a page, without waiting for the read. Any number of reads may be in flight, as with WritePageAsync.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer, which must not be used until the read is done
+   * @return a future that becomes ready once page_data holds the page
+   */
+  virtual auto ReadPageAsync(page_id_t page_id, char *page_data) -> std::future<void>;
+
+  /**
+   * Make every page written so far durable, with one fdatasync of each file written to since the last Sync.
+   */
+  void Sync();
+
+  /**
+   * Create a tablespace, with a new file next to the db file. Its pages are handed out by AllocatePage.
+   * @return the id of the new tablespace
+   * @throw Exception if all MAX_TABLESPACES tablespaces exist already, or the file cannot be created
+   */
+  auto CreateTablespace() -> tablespace_id_t;
+
+  /**
+   * Drop a tablespace, deleting its file and with it every page in it, however many. Nothing may read or write its
+   * pages any more, nor have I/O of them in flight: the buffer pool must have deleted them first.
+   * @param tablespace id of the tablespace
+   * @throw Exception if the tablespace does not exist, or is DEFAULT_TABLESPACE
+   */
+  virtual void DropTablespace(tablespace_id_t tablespace);
+
+  /**
+   * @param tablespace id of the tablespace
+   * @return true if the tablespace exists
+   */
+  auto HasTablespace(tablespace_id_t tablespace) const -> bool;
+
+  /**
+   * @param page_id id of the page
+   * @return the tablespace the page is in
+   */
+  static auto TablespaceOf(page_id_t page_id) -> tablespace_id_t { return page_id >> TABLESPACE_PAGE_BITS; }
+
+  /**
+   * Map the db file into memory, read-only, as it is now: pages written to the file afterwards may or may not show
+   * through, and pages appended to it do not. Only the pages of DEFAULT_TABLESPACE are mapped. Meant for read-only
+   * replicas, see MmapBufferPoolManager. Calling it again returns the same mapping, which lasts as long as the disk
+   * manager.
+   * @return the start of the mapping, or nullptr if the file is empty
+   * @throw Exception if the file cannot be mapped
+   */
+  virtual auto MapReadOnly() -> const char *;
+
+  /** @return the number of pages in the mapping made by MapReadOnly, a partial last page included */
+  auto GetNumMappedPages() const -> size_t { return (mapping_size_ + PAGE_SIZE - 1) / PAGE_SIZE; }
+
+  /**
+   * Allocate a page in a tablespace, reusing a deallocated page if there is one.
+   * In the db file, a reused page is recorded as allocated in the free page map on disk before it is handed out, so it
+   * can never be handed out twice across a restart. The other tablespaces keep no free page map: their file is grown
+   * to cover every page handed out, and the pages they free are only reused until the disk manager shuts down.
+   * @param num_instances the number of buffer pool instances sharing the file
+   * @param instance_index the instance asking; the returned id is congruent to it modulo num_instances
+   * @param tablespace the tablespace to allocate the page in
+   * @return the id of the allocated page
+   * @throw Exception if the tablespace does not exist or is full
+   */
+  auto AllocatePage(uint32_t num_instances = 1, uint32_t instance_index = 0,
+                    tablespace_id_t tablespace = DEFAULT_TABLESPACE) -> page_id_t;
+
+  /**
+   * Allocate EXTENT_SIZE pages with consecutive ids in a tablespace, above every page allocated so far and starting
+   * at a multiple of EXTENT_SIZE, and reserve the space for them in the file where the file system can. The pages
+   * this skips stay free for AllocatePage. Used through Extent, which hands the pages out one by one.
+   * @param tablespace the tablespace to allocate the pages in
+   * @return the id of the first page of the extent
+   * @throw Exception if the tablespace does not exist or is full
+   */
+  auto AllocateExtent(tablespace_id_t tablespace = DEFAULT_TABLESPACE) -> page_id_t;
+
+  /**
+   * Deallocate a page, so that a later AllocatePage can reuse it. The free page map records this lazily: a page freed
+   * just before a crash is leaked, never reused twice.
+   * @param page_id id of the page to deallocate
+   */
+  void DeallocatePage(page_id_t page_id);
+
+  /**
+   * @param page_id id of the page
+   * @return true if the page has been allocated and not deallocated since
+   */
+  auto IsAllocated(page_id_t page_id) -> bool;
+
+  /**
+   * Write the parts of the free page map that changed since they were last written, and make them durable.
+   */
+  void FlushFreePageMap();
+
+  /**
+   * Replace the warm-up file, which lists the pages a buffer pool should read in at startup, next to the db file.
+   * The new list is written to a temporary file first, so a crash leaves either the old list or the new one.
+   * @param page_ids the pages to list, in the order the buffer pool wants them back
+   */
+  void WriteWarmUpList(const std::vector<page_id_t> &page_ids);
+
+  /** @return the pages listed in the warm-up file, or nothing if there is no valid one */
+  auto ReadWarmUpList() -> std::vector<page_id_t>;
 
   /**
    * Flush the entire log buffer into disk.
    * @param log_data raw log data
    * @param size size of log entry
    */
-  void WriteLog(char *log_data, int size);
+  virtual void WriteLog(char *log_data, int size);
 
   /**
    * Read a log entry from the log file.
@@ -69,7 +216,7 @@ class DiskManager {
    * @param offset offset of the log entry in the file
    * @return true if the read was successful, false otherwise
    */
-  auto ReadLog(char *log_data, int size, int offset) -> bool;
+  virtual auto ReadLog(char *log_data, int size, int offset) -> bool;
 
   /** @return the number of disk flushes */
   auto GetNumFlushes() const -> int;
@@ -80,6 +227,9 @@ class DiskManager {
   /** @return the number of disk writes */
   auto GetNumWrites() const -> int;
 
+  /** @return true if the database files are read and written with O_DIRECT */
+  auto IsDirectIo() const -> bool { return direct_io_; }
+
   /**
    * Sets the future which is used to check for non-blocking flushes.
    * @param f the non-blocking flush check
@@ -89,20 +239,117 @@ class DiskManager {
   /** Checks if the non-blocking flush future was set. */
   inline auto HasFlushLogFuture() -> bool { return flush_log_f_ != nullptr; }
 
+ protected:
+  /**
+   * Creates a disk manager without any files, for subclasses that keep the pages and the log elsewhere. Allocation and
+   * tablespaces work as usual, but the free page map lives only in memory, and the page and log I/O must be overridden.
+   */
+  DiskManager();
+
+  int num_flushes_;
+  std::atomic<int> num_writes_;
+  bool flush_log_;
+  std::future<void> *flush_log_f_;
+
  private:
+  /** The file of a tablespace, and the state of the allocation of its pages. */
+  struct Tablespace {
+    std::string file_name_;
+    /** Descriptor of the file, read and written with pread and pwrite so that no cursor is shared. */
+    int fd_{-1};
+    /** The size of the file, kept here so that reads do not have to stat it. */
+    std::atomic<int64_t> file_size_{0};
+    /** Whether the file has been written to since the last Sync. */
+    std::atomic<bool> unsynced_{false};
+    /** Pages below this id have been allocated at some point. */
+    page_id_t next_page_id_{0};
+    /** The next never-allocated page of each buffer pool instance, for the instance count last asked with. */
+    std::vector<page_id_t> next_instance_page_ids_;
+    /** The free pages, in id order. */
+    std::set<page_id_t> free_pages_;
+  };
+
+  /** @return the offset of a page in the file of its tablespace */
+  static auto OffsetOf(page_id_t page_id) -> int64_t {
+    return static_cast<int64_t>(page_id & ((1 << TABLESPACE_PAGE_BITS) - 1)) * PAGE_SIZE;
+  }
+  /** @return the tablespace a page is in, or nullptr if there is no such tablespace */
+  auto SpaceOf(page_id_t page_id) const -> Tablespace * {
+    tablespace_id_t tablespace = TablespaceOf(page_id);
+    return tablespace >= 0 && tablespace < MAX_TABLESPACES ? tablespaces_[tablespace].load() : nullptr;
+  }
+  /** @return the file name of a tablespace other than DEFAULT_TABLESPACE */
+  auto TablespaceFileName(tablespace_id_t tablespace) const -> std::string {
+    return tablespace_prefix_ + std::to_string(tablespace);
+  }
+  /** Open the file of a tablespace, creating it empty if create is set, and start handing out its pages. */
+  auto OpenTablespace(tablespace_id_t tablespace, const std::string &file_name, bool create) -> Tablespace *;
   auto GetFileSize(const std::string &file_name) -> int;
+  /** Write the rest of a page of which the first written bytes are written already. */
+  void WritePageFrom(page_id_t page_id, const char *page_data, size_t written);
+  /** Read the rest of a page of which the first read_count bytes are read already. */
+  void ReadPageFrom(page_id_t page_id, char *page_data, size_t read_count);
+  /** Raise the cached size of a file that was written to, up to at least the given size. */
+  static void GrowFileSize(Tablespace *space, int64_t size);
+  /** Grow a file to at least the given size, with its blocks allocated where the file system can. */
+  static void ExtendFile(Tablespace *space, int64_t size);
+  /** Raise the high-water mark of a tablespace. Must hold free_page_map_latch_. */
+  void RaiseNextPageId(Tablespace *space, page_id_t next_page_id);
+  /** Record a page that was never handed out as free. Must hold free_page_map_latch_. */
+  void MarkFreeLocked(Tablespace *space, page_id_t page_id);
+  /** @return true if O_DIRECT cannot transfer to or from the buffer, which must go through a bounce buffer instead */
+  auto NeedsBounce(const char *buf) const -> bool {
+    return direct_io_ && reinterpret_cast<uintptr_t>(buf) % PAGE_SIZE != 0;
+  }
+  /** @return the asynchronous I/O backend, started on first use. Must hold async_io_latch_ shared. */
+  auto GetAsyncIo() -> AsyncIo *;
+  /** @throw Exception if the disk manager was shut down */
+  void CheckNotShutDown() const;
+  /** Read the free page map, or start an empty one if fresh is set or there is none. */
+  void LoadFreePageMap(bool fresh);
+  /** IsAllocated for callers holding free_page_map_latch_. */
+  auto IsAllocatedLocked(page_id_t page_id) const -> bool;
+  /** Write one page of the free page map, without syncing it. Must hold free_page_map_latch_. */
+  void WriteFreePageMapPage(size_t map_page);
+  /** fdatasync the free page map file. Must hold free_page_map_latch_. */
+  void SyncFreePageMap();
   // stream to write log file
   std::fstream log_io_;
   std::string log_name_;
-  // stream to write db file
-  std::fstream db_io_;
+  /** The tablespaces by id, nullptr where there is none. Only the constructor, Create and DropTablespace set them. */
+  std::array<std::atomic<Tablespace *>, MAX_TABLESPACES> tablespaces_{};
+  /** Dropped tablespaces, kept until the disk manager is destroyed as a racing reader may still look at them. */
+  std::vector<Tablespace *> dropped_tablespaces_;
+  /** The file name of a tablespace is this followed by its id. */
+  std::string tablespace_prefix_;
+  /** Whether the files have O_DIRECT set. Every transfer must then use page-aligned buffers and offsets. */
+  bool direct_io_{false};
+  /** The read-only mapping of the db file made by MapReadOnly, and its length. */
+  void *mapping_{nullptr};
+  size_t mapping_size_{0};
+  std::mutex mapping_latch_;
   std::string file_name_;
-  int num_flushes_;
-  int num_writes_;
-  bool flush_log_;
-  std::future<void> *flush_log_f_;
-  // With multiple buffer pool instances, need to protect file access
-  std::mutex db_io_latch_;
+  /** The backend of the asynchronous reads and writes. */
+  AsyncIo *async_io_{nullptr};
+  std::once_flag async_io_started_;
+  /** Held shared while a request is submitted to async_io_, and exclusively by ShutDown while it stops async_io_. */
+  std::shared_mutex async_io_latch_;
+  /** Set by ShutDown, after which no page I/O is allowed anymore. */
+  std::atomic<bool> shut_down_{false};
+
+  // descriptor of the free page map file, or -1. Its first page holds the allocation high-water mark, each following
+  // page is a bitmap with one bit per page of the db file, set if the page is free.
+  int fpm_fd_{-1};
+  std::string fpm_name_;
+  // name of the warm-up file
+  std::string warm_up_name_;
+  /** The bitmap pages of the free page map, back to back. */
+  std::vector<char> free_bits_;
+  /** The bitmap pages that changed since they were last written. */
+  std::vector<bool> dirty_map_pages_;
+  bool map_header_dirty_ = false;
+  /** Guards the free page map, the allocation state of every tablespace, and which tablespaces exist. */
+  std::mutex free_page_map_latch_;
 };
 
 }  // namespace bustub
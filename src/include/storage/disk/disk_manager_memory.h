@@ -0,0 +1,165 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_memory.h
+//
+// Identification: src/include/storage/disk/disk_manager_memory.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <chrono>  // NOLINT
+#include <cstdint>
+#include <future>  // NOLINT
+#include <mutex>   // NOLINT
+#include <random>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * The timing of a simulated disk. Each direction transfers one I/O at a time at its bandwidth, so concurrent I/Os
+ * queue for it, and then takes its latency, during which other I/Os proceed as on a device with a deep queue. An I/O
+ * that does not start at the page where the previous one ended takes the seek latency on top, as on a spinning disk.
+ */
+struct DiskModel {
+  /** Time a read takes on top of its transfer. */
+  std::chrono::nanoseconds read_latency_{0};
+  /** Time a write takes on top of its transfer. */
+  std::chrono::nanoseconds write_latency_{0};
+  /** Time added to a page I/O that does not continue where the previous one ended. */
+  std::chrono::nanoseconds seek_latency_{0};
+  /** Bytes per second reads transfer at most, 0 for no cap. */
+  uint64_t read_bandwidth_{0};
+  /** Bytes per second writes transfer at most, 0 for no cap. */
+  uint64_t write_bandwidth_{0};
+  /** Each latency is scaled by a factor drawn uniformly from [1 - jitter_, 1 + jitter_]. */
+  double jitter_{0};
+  /** Seed of the jitter, so that a single-threaded run sees the same latencies every time. */
+  uint64_t seed_{0};
+
+  /** @return a model of an NVMe SSD: 80us reads, 20us writes, no seeks, 3 GB/s reads and 1.5 GB/s writes */
+  static auto Ssd() -> DiskModel;
+
+  /** @return a model of a 7200 rpm disk: 8ms seeks, 0.1ms per I/O otherwise, 150 MB/s */
+  static auto Hdd() -> DiskModel;
+};
+
+/**
+ * A snapshot of the counters of a DiskManagerMemory, as returned by GetStats. Times are in nanoseconds.
+ */
+struct DiskStats {
+  /** Pages read and written, including those of batched and asynchronous I/O. */
+  uint64_t pages_read_{0};
+  uint64_t pages_written_{0};
+  /** I/Os issued; a batch of adjacent pages is one I/O. */
+  uint64_t reads_{0};
+  uint64_t writes_{0};
+  /** Page I/Os that did not continue where the previous one ended. */
+  uint64_t seeks_{0};
+  /** Log writes and the bytes they wrote. */
+  uint64_t log_writes_{0};
+  uint64_t log_bytes_written_{0};
+  /** Simulated time reads and writes took, counting time spent queueing for bandwidth. */
+  uint64_t read_ns_{0};
+  uint64_t write_ns_{0};
+};
+
+/**
+ * DiskManagerMemory keeps the pages and the log in memory and makes every I/O take the time a DiskModel says it would,
+ * so that benchmarks can model an SSD or a hard disk on any machine, reproducibly. It is a drop-in replacement for
+ * DiskManager: allocation, tablespaces and the counters of DiskManager work as usual, but nothing outlives the object
+ * and MapReadOnly is not supported.
+ */
+class DiskManagerMemory : public DiskManager {
+ public:
+  /**
+   * Creates an empty in-memory disk.
+   * @param model the timing of the disk; the default takes no time at all
+   */
+  explicit DiskManagerMemory(const DiskModel &model = DiskModel());
+
+  /**
+   * Frees the pages.
+   */
+  ~DiskManagerMemory() override;
+
+  void WritePage(page_id_t page_id, const char *page_data) override;
+  void ReadPage(page_id_t page_id, char *page_data) override;
+  void WritePages(std::vector<std::pair<page_id_t, const char *>> pages) override;
+  void ReadPages(std::vector<std::pair<page_id_t, char *>> pages) override;
+
+  /**
+   * Writes the page at once. The future becomes ready when the write would have completed.
+   */
+  auto WritePageAsync(page_id_t page_id, const char *page_data) -> std::future<void> override;
+
+  /**
+   * Reads the page at once. The future becomes ready when the read would have completed.
+   */
+  auto ReadPageAsync(page_id_t page_id, char *page_data) -> std::future<void> override;
+
+  /**
+   * Drops the tablespace and frees its pages.
+   */
+  void DropTablespace(tablespace_id_t tablespace) override;
+
+  /**
+   * @throw Exception always: the pages are not in a file that could be mapped
+   */
+  auto MapReadOnly() -> const char * override;
+
+  void WriteLog(char *log_data, int size) override;
+  auto ReadLog(char *log_data, int size, int offset) -> bool override;
+
+  /** @return a snapshot of the I/O counters */
+  auto GetStats() -> DiskStats;
+
+  /** Sets the I/O counters back to zero. */
+  void ResetStats();
+
+ private:
+  using Clock = std::chrono::steady_clock;
+
+  /**
+   * Accounts for an I/O and works out when it would complete.
+   * @param write true for a write, false for a read
+   * @param page_id the first page of the I/O, or INVALID_PAGE_ID for the log, which never seeks
+   * @param bytes the number of bytes transferred
+   * @return the time at which the I/O completes
+   */
+  auto Schedule(bool write, page_id_t page_id, size_t bytes) -> Clock::time_point;
+
+  /** Copy a page into the disk. */
+  void Store(page_id_t page_id, const char *page_data);
+  /** Copy a page out of the disk; pages never written read as zeros. */
+  void Load(page_id_t page_id, char *page_data);
+
+  const DiskModel model_;
+  /** The pages written so far, each PAGE_SIZE bytes. */
+  std::unordered_map<page_id_t, char *> pages_;
+  std::mutex pages_latch_;
+  std::vector<char> log_;
+  std::mutex log_latch_;
+
+  /** Guards everything below. */
+  std::mutex model_latch_;
+  std::mt19937_64 rng_;
+  /** The page after the last page I/O. */
+  page_id_t next_sequential_page_id_{INVALID_PAGE_ID};
+  /** When each direction is done with the transfers queued so far. */
+  Clock::time_point read_busy_until_{};
+  Clock::time_point write_busy_until_{};
+  DiskStats stats_;
+};
+
+}  // namespace bustub
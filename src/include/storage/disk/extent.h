@@ -0,0 +1,62 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// extent.h
+//
+// Identification: src/include/storage/disk/extent.h
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <mutex>  // NOLINT
+
+#include "common/config.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/**
+ * Extent hands out the ids of the new pages of one object, such as a table heap or an index, in increasing order.
+ * It reserves EXTENT_SIZE contiguous pages from the disk manager at a time, so the pages an object adds one after the
+ * other lie one after the other in the file, however many objects grow at once, and a scan of the object reads the
+ * file sequentially. Pages of the extent left over when the object is closed stay allocated, unused.
+ */
+class Extent {
+ public:
+  /**
+   * Creates an extent cursor that has no pages reserved yet.
+   * @param tablespace the tablespace to reserve the pages in
+   */
+  explicit Extent(tablespace_id_t tablespace = DEFAULT_TABLESPACE) : tablespace_(tablespace) {}
+
+  /** @return the tablespace the pages are reserved in */
+  auto GetTablespace() const -> tablespace_id_t { return tablespace_; }
+
+  /**
+   * Takes the next page of the extent, reserving a new extent first if the current one is used up.
+   * @param disk_manager the disk manager to reserve extents from
+   * @return the id of the page, which is allocated already
+   * @throw Exception if the tablespace does not exist or is full
+   */
+  auto NextPageId(DiskManager *disk_manager) -> page_id_t {
+    std::scoped_lock scoped_latch(latch_);
+    if (next_page_id_ == end_page_id_) {
+      next_page_id_ = disk_manager->AllocateExtent(tablespace_);
+      end_page_id_ = next_page_id_ + EXTENT_SIZE;
+    }
+    return next_page_id_++;
+  }
+
+ private:
+  const tablespace_id_t tablespace_;
+  /** The next page to hand out, and the end of the extent it is in. */
+  page_id_t next_page_id_{INVALID_PAGE_ID};
+  page_id_t end_page_id_{INVALID_PAGE_ID};
+  std::mutex latch_;
+};
+
+}  // namespace bustub
@@ -15,6 +15,7 @@
 #include <vector>
 
 #include "concurrency/transaction.h"
+#include "storage/disk/extent.h"
 #include "storage/index/index_iterator.h"
 #include "storage/page/b_plus_tree_internal_page.h"
 #include "storage/page/b_plus_tree_leaf_page.h"
@@ -41,8 +42,14 @@ class BPlusTree {
   using LeafPage = BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>;
 
  public:
+  /*
+   * With swizzle_children, internal pages remember the frame each child was last found in, and traversals pin that
+   * frame directly instead of looking the child up in the buffer pool's page table (see Page::GetChildFrames).
+   * The tree creates its pages in the given tablespace; its root is recorded in the header page all the same.
+   */
   explicit BPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
-                     int leaf_max_size = LEAF_PAGE_SIZE, int internal_max_size = INTERNAL_PAGE_SIZE);
+                     int leaf_max_size = LEAF_PAGE_SIZE, int internal_max_size = INTERNAL_PAGE_SIZE,
+                     bool swizzle_children = false, tablespace_id_t tablespace = DEFAULT_TABLESPACE);
 
   // Returns true if this B+ tree has no keys and values.
   auto IsEmpty() const -> bool;
@@ -106,7 +113,10 @@ class BPlusTree {
 
   void ToString(BPlusTreePage *page, BufferPoolManager *bpm) const;
 
+  auto OptimisticFindLeafPage(const KeyType &key, bool leftMost, uint64_t *version) -> Page *;
+
   void UnlockPage(Transaction *transaction, OP_MODE op_mode, bool is_dirty);
+  auto FetchChild(Page *page, int index) -> Page *;
   bool IsSafe(OP_MODE op_mode, BPlusTreePage *node);
 
   // member variable
@@ -116,6 +126,10 @@ class BPlusTree {
   KeyComparator comparator_;
   int leaf_max_size_;
   int internal_max_size_;
+  bool swizzle_children_;
+  /** Where new leaf and internal pages are taken from, apart, so that a scan reads the leaves in file order. */
+  Extent leaf_extent_;
+  Extent internal_extent_;
   ReaderWriterLatch rwlatch_;
 };
 
@@ -13,22 +13,47 @@
  * For range scan of b+ tree
  */
 #pragma once
+#include <vector>
+
+#include "buffer/read_ahead.h"
 #include "storage/page/b_plus_tree_leaf_page.h"
 
 namespace bustub {
 
 #define INDEXITERATOR_TYPE IndexIterator<KeyType, ValueType, KeyComparator>
 
+/**
+ * The iterator keeps its current leaf pinned but not latched. It works on a copy of the leaf's entries, taken with an
+ * optimistic read, so that writers are never held up by a scan. The copy is retaken whenever the leaf turns out to
+ * have changed by the time the scan moves on to the next leaf, and the entries up to the last one returned are skipped,
+ * in the leaves after it too, where a split may have moved them. Keys that a concurrent merge moves into leaves the
+ * scan has already passed are missed.
+ */
 INDEX_TEMPLATE_ARGUMENTS
 class IndexIterator {
  public:
   // you may define your own constructor based on your member variables
-  IndexIterator();
-  IndexIterator(Page *page, int site, BufferPoolManager *buffer_pool_manager);
+  IndexIterator() = default;
+  /**
+   * @param page the pinned leaf to start from, whose pin the iterator takes over, or nullptr for the end
+   * @param version the version the descent found the leaf at; if the leaf has changed since, the iterator is stale
+   * @param key the key to start from, nullptr to start from the first entry
+   * @param comparator the comparator of the tree, which must outlive the iterator
+   * @param buffer_pool_manager the buffer pool of the tree
+   */
+  IndexIterator(Page *page, uint64_t version, const KeyType *key, const KeyComparator *comparator,
+                BufferPoolManager *buffer_pool_manager);
   ~IndexIterator();  // NOLINT
 
+  IndexIterator(IndexIterator &&other) noexcept;
+  auto operator=(IndexIterator &&other) noexcept -> IndexIterator &;
+  DISALLOW_COPY(IndexIterator);
+
   auto IsEnd() -> bool;
 
+  /** @return true if the leaf changed after the descent that found it, in which case the descent must be redone */
+  auto IsStale() const -> bool { return is_stale_; }
+
   auto operator*() -> const MappingType &;
 
   auto operator++() -> IndexIterator &;
@@ -42,13 +67,34 @@ class IndexIterator {
   }
 
  private:
-  // add your own private member variables here
-   page_id_t cur_page_id_;
-   int cur_site_;
-   Page *cur_page_;
-   BufferPoolManager *buffer_pool_manager_;
-   B_PLUS_TREE_LEAF_PAGE_TYPE *leaf_;
-   bool is_end_;
+  // Copy the entries of the current leaf, retrying until the copy is consistent.
+  void ReadLeaf();
+  // Move cur_site_ to the first entry after key, or at key if inclusive.
+  void SkipTo(const KeyType &key, bool inclusive);
+  // Move cur_site_ to the first entry of the current leaf past resume_key_, or to its first entry without a resume key.
+  void SkipResumed();
+  // Move on to the following leaves while cur_site_ is past the entries of the current one.
+  void SkipExhaustedLeaves();
+  // Unpin the current leaf and become the end iterator.
+  void Finish();
+
+  page_id_t cur_page_id_{INVALID_PAGE_ID};
+  int cur_site_{0};
+  Page *cur_page_{nullptr};
+  const KeyComparator *comparator_{nullptr};
+  BufferPoolManager *buffer_pool_manager_{nullptr};
+  // the entries of the current leaf, its next page id and the version they were read at
+  std::vector<MappingType> items_;
+  page_id_t next_page_id_{INVALID_PAGE_ID};
+  uint64_t version_{0};
+  bool is_end_{true};
+  bool is_stale_{false};
+  // the key to start from, or the last key returned before the current leaf changed, while entries before it may still
+  // lie ahead; the start key itself is included
+  KeyType resume_key_{};
+  bool resume_inclusive_{false};
+  bool has_resume_key_{false};
+  ReadAheadWindow read_ahead_;
 };
 
 }  // namespace bustub
@@ -44,6 +44,7 @@ class BPlusTreeInternalPage : public BPlusTreePage {
   auto ValueAt(int index) const -> ValueType;
 
   auto Lookup(const KeyType &key, const KeyComparator &comparator) const -> ValueType;
+  auto LookupIndex(const KeyType &key, const KeyComparator &comparator) const -> int;
   void PopulateNewRoot(const ValueType &old_value, const KeyType &new_key, const ValueType &new_value);
   auto InsertNodeAfter(const ValueType &old_value, const KeyType &new_key, const ValueType &new_value) -> int;
   void Remove(int index);
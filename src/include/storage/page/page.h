@@ -12,10 +12,15 @@
 
 #pragma once
 
+#include <algorithm>
+#include <atomic>
 #include <cstring>
 #include <iostream>
+#include <string>
+#include <thread>  // NOLINT
 
 #include "common/config.h"
+#include "common/exception.h"
 #include "common/rwlatch.h"
 
 namespace bustub {
@@ -28,13 +33,14 @@ namespace bustub {
 class Page {
   // There is book-keeping information inside the page that should only be relevant to the buffer pool manager.
   friend class BufferPoolManagerInstance;
+  friend class MmapBufferPoolManager;
 
  public:
-  /** Constructor. Zeros out the page data. */
-  Page() { ResetMemory(); }
+  /** Constructor. The page has no data until the buffer pool points it at a frame. */
+  Page() = default;
 
-  /** Default destructor. */
-  ~Page() = default;
+  /** Destructor. Frees the child frame hints, if any. */
+  ~Page() { ReleaseChildFrames(); }
 
   /** @return the actual data contained within this page */
   inline auto GetData() -> char * { return data_; }
@@ -43,16 +49,29 @@ class Page {
   inline auto GetPageId() -> page_id_t { return page_id_; }
 
   /** @return the pin count of this page */
-  inline auto GetPinCount() -> int { return pin_count_; }
+  inline auto GetPinCount() -> int { return std::max(pin_count_.load(), 0); }
 
   /** @return true if the page in memory has been modified from the page on disk, false otherwise */
   inline auto IsDirty() -> bool { return is_dirty_; }
 
-  /** Acquire the page write latch. */
-  inline void WLatch() { rwlatch_.WLock(); }
+  /**
+   * Acquire the page write latch.
+   * @throw Exception if the page is read-only: whoever write-latches a page is about to change it
+   */
+  inline void WLatch() {
+    if (read_only_) {
+      throw Exception("page " + std::to_string(page_id_.load()) + " is read-only");
+    }
+    rwlatch_.WLock();
+    version_.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+  }
 
   /** Release the page write latch. */
-  inline void WUnlatch() { rwlatch_.WUnlock(); }
+  inline void WUnlatch() {
+    version_.fetch_add(1, std::memory_order_release);
+    rwlatch_.WUnlock();
+  }
 
   /** Acquire the page read latch. */
   inline void RLatch() { rwlatch_.RLock(); }
@@ -60,12 +79,64 @@ class Page {
   /** Release the page read latch. */
   inline void RUnlatch() { rwlatch_.RUnlock(); }
 
+  /**
+   * Read-mostly pages can be read without the read latch, which every reader would otherwise write to: take the
+   * version, read the page, and start over unless ValidateVersion still accepts the version. Writers take the write
+   * latch as usual, which keeps the version odd while they hold it. Until the read is validated it may see a page that
+   * a writer is halfway through changing, so nothing read may be acted upon before then. The caller must hold a pin on
+   * the page.
+   * @return the version of the page, once no writer holds the write latch
+   */
+  inline auto ReadVersion() -> uint64_t {
+    uint64_t version = version_.load(std::memory_order_acquire);
+    while ((version & 1) != 0) {
+      std::this_thread::yield();
+      version = version_.load(std::memory_order_acquire);
+    }
+    return version;
+  }
+
+  /** @return true if no writer has latched the page since ReadVersion returned the given version */
+  inline auto ValidateVersion(uint64_t version) -> bool {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return version_.load(std::memory_order_relaxed) == version;
+  }
+
   /** @return the page LSN. */
   inline auto GetLSN() -> lsn_t { return *reinterpret_cast<lsn_t *>(GetData() + OFFSET_LSN); }
 
   /** Sets the page LSN. */
   inline void SetLSN(lsn_t lsn) { memcpy(GetData() + OFFSET_LSN, &lsn, sizeof(lsn_t)); }
 
+  /**
+   * Index pages can remember, per child slot, the frame each child was last found in, so that the next traversal can
+   * try that frame before going through the page table. The hints are dropped whenever the frame gets another page,
+   * and are only guesses otherwise: whoever uses one must check that the frame still holds the child.
+   * The caller must hold a pin on this page.
+   * @param num_slots the number of slots the hints must cover, allocated on first use
+   * @return the hints, all -1 initially, or nullptr if they were allocated for fewer slots
+   */
+  inline auto GetChildFrames(size_t num_slots) -> std::atomic<frame_id_t> * {
+    std::atomic<frame_id_t> *child_frames = child_frames_.load(std::memory_order_acquire);
+    if (child_frames == nullptr) {
+      auto *allocated = new std::atomic<frame_id_t>[num_slots + 1];
+      allocated[0].store(static_cast<frame_id_t>(num_slots), std::memory_order_relaxed);
+      for (size_t i = 1; i <= num_slots; ++i) {
+        allocated[i].store(-1, std::memory_order_relaxed);
+      }
+      if (child_frames_.compare_exchange_strong(child_frames, allocated, std::memory_order_acq_rel)) {
+        child_frames = allocated;
+      } else {
+        delete[] allocated;
+      }
+    }
+    // The first element holds the number of slots.
+    if (static_cast<size_t>(child_frames[0].load(std::memory_order_relaxed)) < num_slots) {
+      return nullptr;
+    }
+    return child_frames + 1;
+  }
+
  protected:
   static_assert(sizeof(page_id_t) == 4);
   static_assert(sizeof(lsn_t) == 4);
@@ -78,16 +149,35 @@ class Page {
   /** Zeroes out the data that is held within the page. */
   inline void ResetMemory() { memset(data_, OFFSET_PAGE_START, PAGE_SIZE); }
 
-  /** The actual data that is stored within a page. */
-  char data_[PAGE_SIZE]{};
+  /** Frees the child frame hints. Nobody may hold a pin on the page. */
+  inline void ReleaseChildFrames() { delete[] child_frames_.exchange(nullptr, std::memory_order_acq_rel); }
+
+  /** The actual data that is stored within a page: PAGE_SIZE bytes of the buffer pool's frame arena. */
+  char *data_{nullptr};
+  /**
+   * True while the data is known to be all zeros, so that a new page need not clear it. Protected by the pool latch.
+   */
+  bool is_zeroed_{false};
+  /** True if the data is in read-only memory, see MmapBufferPoolManager. */
+  bool read_only_{false};
+  /**
+   * The buffer pool pins pages without its latch, and checks these fields afterwards to validate the pin. They are
+   * atomic for that reason.
+   */
   /** The ID of this page. */
-  page_id_t page_id_ = INVALID_PAGE_ID;
-  /** The pin count of this page. */
-  int pin_count_ = 0;
+  std::atomic<page_id_t> page_id_{INVALID_PAGE_ID};
+  /** The pin count of this page, -1 while the frame is free or is being taken over by another page. */
+  std::atomic<int> pin_count_{-1};
   /** True if the page is dirty, i.e. it is different from its corresponding page on disk. */
-  bool is_dirty_ = false;
+  std::atomic<bool> is_dirty_{false};
+  /** True while the buffer pool is reading this frame in or writing its previous page back. */
+  std::atomic<bool> io_in_progress_{false};
   /** Page latch. */
   ReaderWriterLatch rwlatch_;
+  /** Bumped when the write latch is taken and again when it is released, see ReadVersion. */
+  std::atomic<uint64_t> version_{0};
+  /** The child frame hints handed out by GetChildFrames, preceded by their number, or nullptr. */
+  std::atomic<std::atomic<frame_id_t> *> child_frames_{nullptr};
 };
 
 }  // namespace bustub
@@ -12,8 +12,13 @@
 
 #pragma once
 
+#include <atomic>
+
+#include "buffer/buffer_access_strategy.h"
 #include "buffer/buffer_pool_manager.h"
+#include "buffer/pin_cache.h"
 #include "recovery/log_manager.h"
+#include "storage/disk/extent.h"
 #include "storage/page/table_page.h"
 #include "storage/table/table_iterator.h"
 #include "storage/table/tuple.h"
@@ -46,18 +51,22 @@ class TableHeap {
    * @param lock_manager the lock manager
    * @param log_manager the log manager
    * @param txn the creating transaction
+   * @param tablespace the tablespace to create the pages of the table in
    */
   TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager,
-            Transaction *txn);
+            Transaction *txn, tablespace_id_t tablespace = DEFAULT_TABLESPACE);
 
   /**
    * Insert a tuple into the table. If the tuple is too large (>= page_size), return false.
+   * A bulk insert, i.e. one with an access strategy, appends to the last page instead of looking for free space from
+   * the first page on, and reads and creates pages through the strategy's ring.
    * @param tuple tuple to insert
    * @param[out] rid the rid of the inserted tuple
    * @param txn the transaction performing the insert
+   * @param strategy the access strategy of a bulk insert, nullptr otherwise
    * @return true iff the insert is successful
    */
-  auto InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) -> bool;
+  auto InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn, BufferAccessStrategy *strategy = nullptr) -> bool;
 
   /**
    * Mark the tuple as deleted. The actual delete will occur when ApplyDelete is called.
@@ -95,12 +104,19 @@ class TableHeap {
    * @param rid rid of the tuple to read
    * @param tuple output variable for the tuple
    * @param txn transaction performing the read
+   * @param pin_cache the pin cache to fetch the page through, nullptr to pin and unpin it here
    * @return true if the read was successful (i.e. the tuple exists)
    */
-  auto GetTuple(const RID &rid, Tuple *tuple, Transaction *txn) -> bool;
+  auto GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, PinCache *pin_cache = nullptr) -> bool;
 
-  /** @return the begin iterator of this table */
-  auto Begin(Transaction *txn) -> TableIterator;
+  /**
+   * @param txn the transaction performing the scan
+   * @param strategy the access strategy of a bulk scan, nullptr to scan through the shared buffer pool
+   * @param pin_cache the pin cache that keeps the scanned pages pinned, nullptr to pin them once per tuple
+   * @return the begin iterator of this table
+   */
+  auto Begin(Transaction *txn, BufferAccessStrategy *strategy = nullptr, PinCache *pin_cache = nullptr)
+      -> TableIterator;
 
   /** @return the end iterator of this table */
   auto End() -> TableIterator;
@@ -108,11 +124,18 @@ class TableHeap {
   /** @return the id of the first page of this table */
   inline auto GetFirstPageId() const -> page_id_t { return first_page_id_; }
 
+  /** @return the tablespace the pages of this table are in */
+  inline auto GetTablespace() const -> tablespace_id_t { return extent_.GetTablespace(); }
+
  private:
   BufferPoolManager *buffer_pool_manager_;
   LockManager *lock_manager_;
   LogManager *log_manager_;
   page_id_t first_page_id_{};
+  /** Where new pages of the table are taken from, so that the table's pages follow each other in the file. */
+  Extent extent_;
+  /** The last page of the table, as far as inserts have seen. Bulk inserts start looking for space there. */
+  std::atomic<page_id_t> last_page_id_{INVALID_PAGE_ID};
 };
 
 }  // namespace bustub
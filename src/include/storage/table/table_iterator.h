@@ -14,6 +14,9 @@
 
 #include <cassert>
 
+#include "buffer/buffer_access_strategy.h"
+#include "buffer/pin_cache.h"
+#include "buffer/read_ahead.h"
 #include "common/rid.h"
 #include "concurrency/transaction.h"
 #include "storage/table/tuple.h"
@@ -29,10 +32,16 @@ class TableIterator {
   friend class Cursor;
 
  public:
-  TableIterator(TableHeap *table_heap, RID rid, Transaction *txn);
+  TableIterator(TableHeap *table_heap, RID rid, Transaction *txn, BufferAccessStrategy *strategy = nullptr,
+                PinCache *pin_cache = nullptr);
 
   TableIterator(const TableIterator &other)
-      : table_heap_(other.table_heap_), tuple_(new Tuple(*other.tuple_)), txn_(other.txn_) {}
+      : table_heap_(other.table_heap_),
+        tuple_(new Tuple(*other.tuple_)),
+        txn_(other.txn_),
+        strategy_(other.strategy_),
+        pin_cache_(other.pin_cache_),
+        read_ahead_(other.read_ahead_) {}
 
   ~TableIterator() { delete tuple_; }
 
@@ -54,6 +63,9 @@ class TableIterator {
     table_heap_ = other.table_heap_;
     *tuple_ = *other.tuple_;
     txn_ = other.txn_;
+    strategy_ = other.strategy_;
+    pin_cache_ = other.pin_cache_;
+    read_ahead_ = other.read_ahead_;
     return *this;
   }
 
@@ -61,6 +73,11 @@ class TableIterator {
   TableHeap *table_heap_;
   Tuple *tuple_;
   Transaction *txn_;
+  /** The access strategy of a bulk scan, nullptr to scan through the shared buffer pool. */
+  BufferAccessStrategy *strategy_;
+  /** The pin cache that keeps the scanned pages pinned between tuples, nullptr to pin them once per tuple. */
+  PinCache *pin_cache_;
+  ReadAheadWindow read_ahead_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,310 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// async_io.cpp
+//
+// Identification: src/storage/disk/async_io.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/async_io.h"
+
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>  // NOLINT
+#include <cstring>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#define BUSTUB_HAVE_IO_URING 1
+#endif
+
+#include "common/logger.h"
+
+namespace bustub {
+
+auto AsyncIo::Create(size_t queue_depth, size_t num_threads) -> AsyncIo * {
+  AsyncIo *io = IoUring::Create(queue_depth);
+  if (io == nullptr) {
+    io = new IoThreadPool(num_threads);
+  }
+  LOG_DEBUG("asynchronous I/O through %s", io->GetName());
+  return io;
+}
+
+/*
+ * IoThreadPool
+ */
+
+IoThreadPool::IoThreadPool(size_t num_threads) {
+  for (size_t i = 0; i < std::max<size_t>(num_threads, 1); ++i) {
+    threads_.emplace_back(&IoThreadPool::Work, this);
+  }
+}
+
+IoThreadPool::~IoThreadPool() {
+  {
+    std::scoped_lock guard(latch_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  for (auto &thread : threads_) {
+    thread.join();
+  }
+}
+
+void IoThreadPool::SubmitRead(int fd, char *buf, size_t size, int64_t offset, Callback callback) {
+  {
+    std::scoped_lock guard(latch_);
+    requests_.emplace_back([=, callback = std::move(callback)] {
+      ssize_t count = pread(fd, buf, size, offset);
+      callback(count < 0 ? -errno : count);
+    });
+  }
+  cv_.notify_one();
+}
+
+void IoThreadPool::SubmitWrite(int fd, const char *buf, size_t size, int64_t offset, Callback callback) {
+  {
+    std::scoped_lock guard(latch_);
+    requests_.emplace_back([=, callback = std::move(callback)] {
+      ssize_t count = pwrite(fd, buf, size, offset);
+      callback(count < 0 ? -errno : count);
+    });
+  }
+  cv_.notify_one();
+}
+
+void IoThreadPool::Work() {
+  std::unique_lock guard(latch_);
+  while (true) {
+    cv_.wait(guard, [&] { return stop_ || !requests_.empty(); });
+    // Finish what was submitted before stopping.
+    if (requests_.empty()) {
+      return;
+    }
+    auto request = std::move(requests_.front());
+    requests_.pop_front();
+    guard.unlock();
+    request();
+    guard.lock();
+  }
+}
+
+/*
+ * IoUring
+ */
+
+#ifdef BUSTUB_HAVE_IO_URING
+
+namespace {
+
+/** A request in flight; its address is the user data of its submission. */
+struct IoRequest {
+  struct iovec iov_;
+  AsyncIo::Callback callback_;
+};
+
+auto SysIoUringSetup(unsigned entries, struct io_uring_params *params) -> int {
+  return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+auto SysIoUringEnter(int ring_fd, unsigned to_submit, unsigned min_complete, unsigned flags) -> int {
+  return static_cast<int>(syscall(__NR_io_uring_enter, ring_fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+/** Ring indexes are shared with the kernel, which reads and writes them concurrently. */
+auto LoadAcquire(const unsigned *p) -> unsigned { return __atomic_load_n(p, __ATOMIC_ACQUIRE); }
+void StoreRelease(unsigned *p, unsigned value) { __atomic_store_n(p, value, __ATOMIC_RELEASE); }
+
+}  // namespace
+
+auto IoUring::Create(size_t queue_depth) -> IoUring * {
+  struct io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  int ring_fd = SysIoUringSetup(static_cast<unsigned>(std::max<size_t>(queue_depth, 1)), &params);
+  if (ring_fd < 0) {
+    // Old kernels, and sandboxes that forbid io_uring, end up here.
+    return nullptr;
+  }
+  auto *ring = new IoUring();
+  ring->ring_fd_ = ring_fd;
+  ring->queue_depth_ = params.sq_entries;
+  ring->sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  ring->cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+  ring->sqes_size_ = params.sq_entries * sizeof(struct io_uring_sqe);
+  if (!ring->MapRings()) {
+    delete ring;
+    return nullptr;
+  }
+  auto *sq = static_cast<char *>(ring->sq_ring_);
+  auto *cq = static_cast<char *>(ring->cq_ring_);
+  ring->sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+  ring->sq_mask_ = reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+  ring->sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+  ring->cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+  ring->cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+  ring->cq_mask_ = reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+  ring->cqes_ = cq + params.cq_off.cqes;
+  ring->reaper_ = std::thread(&IoUring::Reap, ring);
+  return ring;
+}
+
+auto IoUring::MapRings() -> bool {
+  sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_,
+                  IORING_OFF_SQ_RING);
+  if (sq_ring_ == MAP_FAILED) {
+    sq_ring_ = nullptr;
+    return false;
+  }
+  cq_ring_ = mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_,
+                  IORING_OFF_CQ_RING);
+  if (cq_ring_ == MAP_FAILED) {
+    cq_ring_ = nullptr;
+    return false;
+  }
+  sqes_ = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES);
+  if (sqes_ == MAP_FAILED) {
+    sqes_ = nullptr;
+    return false;
+  }
+  return true;
+}
+
+IoUring::~IoUring() {
+  if (reaper_.joinable()) {
+    {
+      std::unique_lock guard(latch_);
+      cv_.wait(guard, [&] { return in_flight_ == 0; });
+    }
+    // A no-op without a request tells the reaper to stop. stop_ does too, should the no-op not get through.
+    stop_ = true;
+    Submit(IORING_OP_NOP, -1, nullptr, 0, 0, nullptr);
+    reaper_.join();
+  }
+  if (sqes_ != nullptr) {
+    munmap(sqes_, sqes_size_);
+  }
+  if (cq_ring_ != nullptr) {
+    munmap(cq_ring_, cq_ring_size_);
+  }
+  if (sq_ring_ != nullptr) {
+    munmap(sq_ring_, sq_ring_size_);
+  }
+  if (ring_fd_ >= 0) {
+    close(ring_fd_);
+  }
+}
+
+void IoUring::SubmitRead(int fd, char *buf, size_t size, int64_t offset, Callback callback) {
+  Submit(IORING_OP_READV, fd, buf, size, offset, std::move(callback));
+}
+
+void IoUring::SubmitWrite(int fd, const char *buf, size_t size, int64_t offset, Callback callback) {
+  Submit(IORING_OP_WRITEV, fd, buf, size, offset, std::move(callback));
+}
+
+void IoUring::Submit(uint8_t opcode, int fd, const char *buf, size_t size, int64_t offset, Callback callback) {
+  IoRequest *request = nullptr;
+  if (callback) {
+    request = new IoRequest{{const_cast<char *>(buf), size}, std::move(callback)};
+  }
+  std::unique_lock guard(latch_);
+  // Never have more requests in flight than the completion queue can hold.
+  cv_.wait(guard, [&] { return in_flight_ < queue_depth_; });
+  if (request != nullptr) {
+    in_flight_++;
+  }
+  unsigned tail = *sq_tail_;
+  unsigned index = tail & *sq_mask_;
+  auto *sqe = static_cast<struct io_uring_sqe *>(sqes_) + index;
+  memset(sqe, 0, sizeof(*sqe));
+  sqe->opcode = opcode;
+  sqe->fd = fd;
+  if (request != nullptr) {
+    sqe->addr = reinterpret_cast<uint64_t>(&request->iov_);
+    sqe->len = 1;
+    sqe->off = offset;
+  }
+  sqe->user_data = reinterpret_cast<uint64_t>(request);
+  sq_array_[index] = index;
+  StoreRelease(sq_tail_, tail + 1);
+  while (SysIoUringEnter(ring_fd_, 1, 0, 0) < 0) {
+    if (errno == EINTR || errno == EAGAIN || errno == EBUSY) {
+      continue;
+    }
+    // The kernel did not take the submission, so it would never complete. Take it back and fail the request, so that
+    // the caller falls back to synchronous I/O instead of waiting forever.
+    int error = errno;
+    LOG_DEBUG("io_uring_enter failed: %s", strerror(error));
+    StoreRelease(sq_tail_, tail);
+    if (request == nullptr) {
+      return;
+    }
+    in_flight_--;
+    guard.unlock();
+    cv_.notify_all();
+    request->callback_(-error);
+    delete request;
+    return;
+  }
+}
+
+void IoUring::Reap() {
+  while (true) {
+    if (SysIoUringEnter(ring_fd_, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR) {
+      LOG_DEBUG("io_uring_enter failed: %s", strerror(errno));
+      // Completions still show up in the ring without waiting for them, but do not spin on a ring that keeps failing.
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    unsigned head = *cq_head_;
+    unsigned tail = LoadAcquire(cq_tail_);
+    size_t completed = 0;
+    bool stop = false;
+    while (head != tail) {
+      auto *cqe = static_cast<struct io_uring_cqe *>(cqes_) + (head & *cq_mask_);
+      auto *request = reinterpret_cast<IoRequest *>(cqe->user_data);
+      int result = cqe->res;
+      StoreRelease(cq_head_, ++head);
+      if (request == nullptr) {
+        stop = true;
+        continue;
+      }
+      request->callback_(result);
+      delete request;
+      completed++;
+    }
+    if (completed > 0) {
+      {
+        std::scoped_lock guard(latch_);
+        in_flight_ -= completed;
+      }
+      cv_.notify_all();
+    }
+    if (stop || stop_) {
+      return;
+    }
+  }
+}
+
+#else
+
+auto IoUring::Create(size_t queue_depth) -> IoUring * { return nullptr; }
+
+IoUring::~IoUring() = default;
+
+void IoUring::SubmitRead(int fd, char *buf, size_t size, int64_t offset, Callback callback) {}
+
+void IoUring::SubmitWrite(int fd, const char *buf, size_t size, int64_t offset, Callback callback) {}
+
+#endif
+
+}  // namespace bustub
@@ -10,10 +10,19 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
 #include <cassert>
+#include <cstdio>
 #include <cstring>
 #include <iostream>
+#include <memory>
 #include <mutex>  // NOLINT
 #include <string>
 #include <thread>  // NOLINT
@@ -26,12 +35,47 @@ namespace bustub {
 
 static char *buffer_used;
 
+/** Marks a free page map file, so that a file of some other format is not mistaken for one. */
+static constexpr uint32_t FREE_PAGE_MAP_MAGIC = 0x42465053;
+/** Marks a warm-up file. */
+static constexpr uint32_t WARM_UP_LIST_MAGIC = 0x4d524157;
+/** Number of pages a single bitmap page of the free page map covers. */
+static constexpr page_id_t PAGES_PER_MAP_PAGE = PAGE_SIZE * 8;
+/** Most pages a single preadv or pwritev transfers. */
+static constexpr size_t MAX_PAGES_PER_RUN = 256;
+
+/**
+ * @return the end of the run of pages with consecutive ids that starts at begin, in pages sorted by id. Runs end at
+ * the end of a tablespace. With split_unaligned, runs also end before the first buffer that is not page-aligned.
+ */
+template <class Buffer>
+static auto RunEnd(const std::vector<std::pair<page_id_t, Buffer>> &pages, size_t begin, bool split_unaligned)
+    -> size_t {
+  size_t end = begin + 1;
+  while (end < pages.size() && end - begin < MAX_PAGES_PER_RUN &&
+         pages[end].first == pages[begin].first + static_cast<page_id_t>(end - begin) &&
+         DiskManager::TablespaceOf(pages[end].first) == DiskManager::TablespaceOf(pages[begin].first) &&
+         !(split_unaligned && reinterpret_cast<uintptr_t>(pages[end].second) % PAGE_SIZE != 0)) {
+    ++end;
+  }
+  return end;
+}
+
+/** @return a page-aligned buffer of the calling thread, for pages whose own buffer O_DIRECT cannot use */
+static auto BounceBuffer() -> char * {
+  struct alignas(PAGE_SIZE) Buffer {
+    char data_[PAGE_SIZE];
+  };
+  static thread_local Buffer buffer;
+  return buffer.data_;
+}
+
 /**
  * Constructor: open/create a single database file & log file
  * @input db_file: database file name
  */
-DiskManager::DiskManager(const std::string &db_file)
-    : file_name_(db_file), num_flushes_(0), num_writes_(0), flush_log_(false), flush_log_f_(nullptr) {
+DiskManager::DiskManager(const std::string &db_file, bool direct_io)
+    : num_flushes_(0), num_writes_(0), flush_log_(false), flush_log_f_(nullptr), file_name_(db_file) {
   std::string::size_type n = file_name_.rfind('.');
   if (n == std::string::npos) {
     LOG_DEBUG("wrong file format");
@@ -53,30 +97,125 @@ DiskManager::DiskManager(const std::string &db_file)
     }
   }
 
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
+#ifdef O_DIRECT
+  direct_io_ = direct_io;
+#endif
   // directory or file does not exist
-  if (!db_io_.is_open()) {
-    db_io_.clear();
-    // create a new file
-    db_io_.open(db_file, std::ios::binary | std::ios::trunc | std::ios::out);
-    db_io_.close();
-    // reopen with original mode
-    db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-    if (!db_io_.is_open()) {
-      throw Exception("can't open db file");
+  bool fresh = OpenTablespace(DEFAULT_TABLESPACE, db_file, false) == nullptr;
+  if (fresh && OpenTablespace(DEFAULT_TABLESPACE, db_file, true) == nullptr) {
+    throw Exception("can't open db file");
+  }
+  // The tablespaces of a new db file start out empty as well, whatever stale files of the same names hold.
+  tablespace_prefix_ = file_name_.substr(0, n) + ".ts";
+  for (tablespace_id_t tablespace = DEFAULT_TABLESPACE + 1; tablespace < MAX_TABLESPACES; ++tablespace) {
+    if (fresh) {
+      remove(TablespaceFileName(tablespace).c_str());
+    } else {
+      OpenTablespace(tablespace, TablespaceFileName(tablespace), false);
     }
   }
+
+  // A new db file gets a new free page map, whatever a stale map file of the same name says.
+  fpm_name_ = file_name_.substr(0, n) + ".fpm";
+  warm_up_name_ = file_name_.substr(0, n) + ".warm";
+  fpm_fd_ = open(fpm_name_.c_str(), O_RDWR | O_CREAT | O_CLOEXEC | (fresh ? O_TRUNC : 0), 0644);
+  if (fpm_fd_ < 0) {
+    throw Exception("can't open free page map file");
+  }
+  LoadFreePageMap(fresh);
   buffer_used = nullptr;
 }
 
+/**
+ * Constructor without files: the db tablespace keeps only its allocation state
+ */
+DiskManager::DiskManager() : num_flushes_(0), num_writes_(0), flush_log_(false), flush_log_f_(nullptr) {
+  OpenTablespace(DEFAULT_TABLESPACE, "", true);
+  LoadFreePageMap(true);
+}
+
+DiskManager::~DiskManager() {
+  delete async_io_;
+  if (fpm_fd_ >= 0) {
+    close(fpm_fd_);
+  }
+  if (mapping_ != nullptr) {
+    munmap(mapping_, mapping_size_);
+  }
+  for (auto &slot : tablespaces_) {
+    Tablespace *space = slot.load();
+    if (space != nullptr && space->fd_ >= 0) {
+      close(space->fd_);
+    }
+    delete space;
+  }
+  for (Tablespace *space : dropped_tablespaces_) {
+    delete space;
+  }
+}
+
+/**
+ * Open the file of a tablespace. Its pages up to the end of the file count as allocated
+ */
+auto DiskManager::OpenTablespace(tablespace_id_t tablespace, const std::string &file_name, bool create)
+    -> Tablespace * {
+  // A disk manager without a db file has no files for its tablespaces either.
+  int fd = -1;
+  if (!file_name_.empty()) {
+    fd = create ? open(file_name.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644)
+                : open(file_name.c_str(), O_RDWR | O_CLOEXEC);
+    if (fd < 0) {
+      return nullptr;
+    }
+  }
+  auto *space = new Tablespace();
+  space->file_name_ = file_name;
+  space->fd_ = fd;
+  struct stat stat_buf;
+  int64_t file_size = fd >= 0 && fstat(fd, &stat_buf) == 0 ? stat_buf.st_size : 0;
+  space->file_size_ = file_size;
+  int64_t file_pages = std::min<int64_t>((file_size + PAGE_SIZE - 1) / PAGE_SIZE, 1 << TABLESPACE_PAGE_BITS);
+  space->next_page_id_ = (tablespace << TABLESPACE_PAGE_BITS) + static_cast<page_id_t>(file_pages);
+#ifdef O_DIRECT
+  // tmpfs, among others, refuses O_DIRECT; such files stay buffered.
+  if (direct_io_ && fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_DIRECT) != 0) {
+    LOG_DEBUG("O_DIRECT is not supported for %s, using buffered I/O", file_name.c_str());
+    // Pages go through bounce buffers as long as the db file has O_DIRECT; the other files can do without.
+    if (tablespace == DEFAULT_TABLESPACE) {
+      direct_io_ = false;
+    }
+  }
+#endif
+  tablespaces_[tablespace] = space;
+  return space;
+}
+
 /**
  * Close all file streams
  */
 void DiskManager::ShutDown() {
+  FlushFreePageMap();
+  {
+    std::scoped_lock scoped_free_page_map_latch(free_page_map_latch_);
+    if (fpm_fd_ >= 0) {
+      close(fpm_fd_);
+      fpm_fd_ = -1;
+    }
+  }
+  // Wait for the asynchronous I/O in flight. Page I/O from now on is an error, as the files are about to be closed.
   {
-    std::scoped_lock scoped_db_io_latch(db_io_latch_);
-    db_io_.close();
+    std::unique_lock async_io_guard(async_io_latch_);
+    shut_down_ = true;
+    delete async_io_;
+    async_io_ = nullptr;
+  }
+  Sync();
+  for (auto &slot : tablespaces_) {
+    Tablespace *space = slot.load();
+    if (space != nullptr && space->fd_ >= 0) {
+      close(space->fd_);
+      space->fd_ = -1;
+    }
   }
   log_io_.close();
 }
@@ -85,48 +224,565 @@ void DiskManager::ShutDown() {
  * Write the contents of the specified page into disk file
  */
 void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  size_t offset = static_cast<size_t>(page_id) * PAGE_SIZE;
-  // set write cursor to offset
+  CheckNotShutDown();
   num_writes_ += 1;
-  db_io_.seekp(offset);
-  db_io_.write(page_data, PAGE_SIZE);
-  // check for I/O error
-  if (db_io_.bad()) {
-    LOG_DEBUG("I/O error while writing");
+  if (NeedsBounce(page_data)) {
+    char *bounce = BounceBuffer();
+    memcpy(bounce, page_data, PAGE_SIZE);
+    page_data = bounce;
+  }
+  WritePageFrom(page_id, page_data, 0);
+}
+
+void DiskManager::WritePageFrom(page_id_t page_id, const char *page_data, size_t written) {
+  Tablespace *space = SpaceOf(page_id);
+  if (space == nullptr) {
+    LOG_DEBUG("I/O error writing page %d, which is in no tablespace", page_id);
     return;
   }
-  // needs to flush to keep disk file in sync
-  db_io_.flush();
+  int64_t offset = OffsetOf(page_id);
+  while (written < static_cast<size_t>(PAGE_SIZE)) {
+    ssize_t count = pwrite(space->fd_, page_data + written, PAGE_SIZE - written, offset + written);
+    // check for I/O error
+    if (count < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      LOG_DEBUG("I/O error while writing");
+      return;
+    }
+    written += count;
+  }
+  // Grow the cached file size only once the page is there, so that a read that sees the new size finds the page.
+  GrowFileSize(space, offset + PAGE_SIZE);
+}
+
+void DiskManager::GrowFileSize(Tablespace *space, int64_t size) {
+  space->unsynced_ = true;
+  int64_t file_size = space->file_size_.load();
+  while (file_size < size && !space->file_size_.compare_exchange_weak(file_size, size)) {
+  }
 }
 
 /**
  * Read the contents of the specified page into the given memory area
  */
 void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
-  std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  int offset = page_id * PAGE_SIZE;
+  CheckNotShutDown();
+  Tablespace *space = SpaceOf(page_id);
   // check if read beyond file length
-  if (offset > GetFileSize(file_name_)) {
+  if (space == nullptr || OffsetOf(page_id) >= space->file_size_.load()) {
     LOG_DEBUG("I/O error reading past end of file");
     // std::cerr << "I/O error while reading" << std::endl;
-  } else {
-    // set read cursor to offset
-    db_io_.seekp(offset);
-    db_io_.read(page_data, PAGE_SIZE);
-    if (db_io_.bad()) {
+    memset(page_data, 0, PAGE_SIZE);
+    return;
+  }
+  if (NeedsBounce(page_data)) {
+    char *bounce = BounceBuffer();
+    ReadPageFrom(page_id, bounce, 0);
+    memcpy(page_data, bounce, PAGE_SIZE);
+    return;
+  }
+  ReadPageFrom(page_id, page_data, 0);
+}
+
+void DiskManager::ReadPageFrom(page_id_t page_id, char *page_data, size_t read_count) {
+  Tablespace *space = SpaceOf(page_id);
+  int64_t offset = OffsetOf(page_id);
+  while (space != nullptr && read_count < static_cast<size_t>(PAGE_SIZE)) {
+    ssize_t count = pread(space->fd_, page_data + read_count, PAGE_SIZE - read_count, offset + read_count);
+    if (count < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
       LOG_DEBUG("I/O error while reading");
       return;
     }
-    // if file ends before reading PAGE_SIZE
-    int read_count = db_io_.gcount();
-    if (read_count < PAGE_SIZE) {
-      LOG_DEBUG("Read less than a page");
-      db_io_.clear();
-      // std::cerr << "Read less than a page" << std::endl;
-      memset(page_data + read_count, 0, PAGE_SIZE - read_count);
+    if (count == 0) {
+      break;
+    }
+    read_count += count;
+  }
+  // if file ends before reading PAGE_SIZE
+  if (read_count < static_cast<size_t>(PAGE_SIZE)) {
+    LOG_DEBUG("Read less than a page");
+    memset(page_data + read_count, 0, PAGE_SIZE - read_count);
+  }
+}
+
+void DiskManager::WritePages(std::vector<std::pair<page_id_t, const char *>> pages) {
+  CheckNotShutDown();
+  // The sort is stable so that, of a page listed twice, the later data is written last.
+  std::stable_sort(pages.begin(), pages.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+  num_writes_ += static_cast<int>(pages.size());
+  std::vector<iovec> iov;
+  for (size_t begin = 0; begin < pages.size();) {
+    if (NeedsBounce(pages[begin].second)) {
+      char *bounce = BounceBuffer();
+      memcpy(bounce, pages[begin].second, PAGE_SIZE);
+      WritePageFrom(pages[begin].first, bounce, 0);
+      begin++;
+      continue;
+    }
+    size_t end = RunEnd(pages, begin, direct_io_);
+    iov.clear();
+    for (size_t i = begin; i < end; ++i) {
+      iov.push_back({const_cast<char *>(pages[i].second), static_cast<size_t>(PAGE_SIZE)});
+    }
+    Tablespace *space = SpaceOf(pages[begin].first);
+    int64_t offset = OffsetOf(pages[begin].first);
+    ssize_t count = -1;
+    if (space != nullptr) {
+      do {
+        count = pwritev(space->fd_, iov.data(), static_cast<int>(iov.size()), offset);
+      } while (count < 0 && errno == EINTR);
+    }
+    if (count > 0) {
+      GrowFileSize(space, offset + count / PAGE_SIZE * PAGE_SIZE);
+    }
+    // Whatever the one call did not write is finished, or retried, page by page.
+    size_t done = std::max<ssize_t>(count, 0);
+    for (size_t i = begin; i < end; ++i) {
+      size_t page_done = std::min<size_t>(done, PAGE_SIZE);
+      done -= page_done;
+      if (page_done < static_cast<size_t>(PAGE_SIZE)) {
+        WritePageFrom(pages[i].first, pages[i].second, page_done);
+      }
+    }
+    begin = end;
+  }
+  Sync();
+}
+
+void DiskManager::ReadPages(std::vector<std::pair<page_id_t, char *>> pages) {
+  CheckNotShutDown();
+  std::sort(pages.begin(), pages.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+  std::vector<iovec> iov;
+  for (size_t begin = 0; begin < pages.size();) {
+    if (NeedsBounce(pages[begin].second)) {
+      char *bounce = BounceBuffer();
+      ReadPageFrom(pages[begin].first, bounce, 0);
+      memcpy(pages[begin].second, bounce, PAGE_SIZE);
+      begin++;
+      continue;
+    }
+    size_t end = RunEnd(pages, begin, direct_io_);
+    iov.clear();
+    for (size_t i = begin; i < end; ++i) {
+      iov.push_back({pages[i].second, static_cast<size_t>(PAGE_SIZE)});
+    }
+    Tablespace *space = SpaceOf(pages[begin].first);
+    int64_t offset = OffsetOf(pages[begin].first);
+    ssize_t count = -1;
+    if (space != nullptr) {
+      do {
+        count = preadv(space->fd_, iov.data(), static_cast<int>(iov.size()), offset);
+      } while (count < 0 && errno == EINTR);
+    }
+    // A short read ends at the end of the file or was cut short; ReadPageFrom tells the two apart.
+    size_t done = std::max<ssize_t>(count, 0);
+    for (size_t i = begin; i < end; ++i) {
+      size_t page_done = std::min<size_t>(done, PAGE_SIZE);
+      done -= page_done;
+      if (page_done < static_cast<size_t>(PAGE_SIZE)) {
+        ReadPageFrom(pages[i].first, pages[i].second, page_done);
+      }
+    }
+    begin = end;
+  }
+}
+
+auto DiskManager::WritePageAsync(page_id_t page_id, const char *page_data) -> std::future<void> {
+  auto done = std::make_shared<std::promise<void>>();
+  std::future<void> future = done->get_future();
+  Tablespace *space = SpaceOf(page_id);
+  if (space == nullptr || NeedsBounce(page_data)) {
+    WritePage(page_id, page_data);
+    done->set_value();
+    return future;
+  }
+  // ShutDown must not stop the backend while the request is being submitted.
+  std::shared_lock async_io_guard(async_io_latch_);
+  CheckNotShutDown();
+  num_writes_ += 1;
+  GetAsyncIo()->SubmitWrite(space->fd_, page_data, PAGE_SIZE, OffsetOf(page_id),
+                            [this, page_id, page_data, done](ssize_t count) {
+                              // Short and failed writes are finished, or retried, the synchronous way.
+                              WritePageFrom(page_id, page_data, std::max<ssize_t>(count, 0));
+                              done->set_value();
+                            });
+  return future;
+}
+
+auto DiskManager::ReadPageAsync(page_id_t page_id, char *page_data) -> std::future<void> {
+  auto done = std::make_shared<std::promise<void>>();
+  std::future<void> future = done->get_future();
+  Tablespace *space = SpaceOf(page_id);
+  int64_t offset = OffsetOf(page_id);
+  if (space == nullptr || offset >= space->file_size_.load() || NeedsBounce(page_data)) {
+    ReadPage(page_id, page_data);
+    done->set_value();
+    return future;
+  }
+  std::shared_lock async_io_guard(async_io_latch_);
+  CheckNotShutDown();
+  GetAsyncIo()->SubmitRead(space->fd_, page_data, PAGE_SIZE, offset, [this, page_id, page_data, done](ssize_t count) {
+    // Short and failed reads are finished, or retried, the synchronous way.
+    if (count < PAGE_SIZE) {
+      ReadPageFrom(page_id, page_data, std::max<ssize_t>(count, 0));
+    }
+    done->set_value();
+  });
+  return future;
+}
+
+auto DiskManager::MapReadOnly() -> const char * {
+  std::scoped_lock scoped_mapping_latch(mapping_latch_);
+  Tablespace *db = tablespaces_[DEFAULT_TABLESPACE].load();
+  if (mapping_ == nullptr && db != nullptr && db->file_size_.load() > 0) {
+    size_t size = db->file_size_.load();
+    void *mapping = mmap(nullptr, size, PROT_READ, MAP_SHARED, db->fd_, 0);
+    if (mapping == MAP_FAILED) {
+      throw Exception("can't map db file");
+    }
+    mapping_ = mapping;
+    mapping_size_ = size;
+  }
+  return static_cast<const char *>(mapping_);
+}
+
+auto DiskManager::GetAsyncIo() -> AsyncIo * {
+  std::call_once(async_io_started_, [&] { async_io_ = AsyncIo::Create(IO_QUEUE_DEPTH, IO_THREAD_POOL_SIZE); });
+  return async_io_;
+}
+
+void DiskManager::CheckNotShutDown() const {
+  if (shut_down_) {
+    throw Exception("page I/O after the disk manager was shut down");
+  }
+}
+
+void DiskManager::Sync() {
+  for (auto &slot : tablespaces_) {
+    Tablespace *space = slot.load();
+    if (space != nullptr && space->fd_ >= 0 && space->unsynced_.exchange(false) && fdatasync(space->fd_) != 0) {
+      LOG_DEBUG("I/O error while syncing");
+    }
+  }
+}
+
+auto DiskManager::CreateTablespace() -> tablespace_id_t {
+  std::scoped_lock scoped_free_page_map_latch(free_page_map_latch_);
+  for (tablespace_id_t tablespace = DEFAULT_TABLESPACE + 1; tablespace < MAX_TABLESPACES; ++tablespace) {
+    if (tablespaces_[tablespace].load() != nullptr) {
+      continue;
+    }
+    if (OpenTablespace(tablespace, TablespaceFileName(tablespace), true) == nullptr) {
+      throw Exception("can't create tablespace file");
+    }
+    return tablespace;
+  }
+  throw Exception("can't create more than " + std::to_string(MAX_TABLESPACES) + " tablespaces");
+}
+
+void DiskManager::DropTablespace(tablespace_id_t tablespace) {
+  std::scoped_lock scoped_free_page_map_latch(free_page_map_latch_);
+  if (tablespace == DEFAULT_TABLESPACE || !HasTablespace(tablespace)) {
+    throw Exception("can't drop tablespace " + std::to_string(tablespace));
+  }
+  Tablespace *space = tablespaces_[tablespace].exchange(nullptr);
+  if (space->fd_ >= 0) {
+    close(space->fd_);
+    space->fd_ = -1;
+    remove(space->file_name_.c_str());
+  }
+  dropped_tablespaces_.push_back(space);
+}
+
+auto DiskManager::HasTablespace(tablespace_id_t tablespace) const -> bool {
+  return tablespace >= 0 && tablespace < MAX_TABLESPACES && tablespaces_[tablespace].load() != nullptr;
+}
+
+/**
+ * Allocate a page, preferring the lowest free page of the calling instance
+ */
+auto DiskManager::AllocatePage(uint32_t num_instances, uint32_t instance_index, tablespace_id_t tablespace)
+    -> page_id_t {
+  std::scoped_lock scoped_free_page_map_latch(free_page_map_latch_);
+  if (!HasTablespace(tablespace)) {
+    throw Exception("can't allocate a page in tablespace " + std::to_string(tablespace) + ", which does not exist");
+  }
+  Tablespace *space = tablespaces_[tablespace].load();
+  for (auto it = space->free_pages_.begin(); it != space->free_pages_.end(); ++it) {
+    page_id_t page_id = *it;
+    if (static_cast<uint32_t>(page_id) % num_instances != instance_index) {
+      continue;
+    }
+    space->free_pages_.erase(it);
+    if (tablespace == DEFAULT_TABLESPACE) {
+      free_bits_[page_id / 8] &= ~(1 << (page_id % 8));
+      // The page may be written as soon as it is handed out, so the map must not call it free after a crash.
+      WriteFreePageMapPage(page_id / PAGES_PER_MAP_PAGE);
+      SyncFreePageMap();
+    }
+    return page_id;
+  }
+
+  // Every instance hands out its own ids above everything allocated so far, like a counter.
+  std::vector<page_id_t> &next_instance_page_ids = space->next_instance_page_ids_;
+  if (next_instance_page_ids.size() != num_instances) {
+    next_instance_page_ids.resize(num_instances);
+    for (uint32_t i = 0; i < num_instances; ++i) {
+      next_instance_page_ids[i] =
+          space->next_page_id_ + (i + num_instances - space->next_page_id_ % num_instances) % num_instances;
+    }
+  }
+  page_id_t page_id = next_instance_page_ids[instance_index];
+  if (TablespaceOf(page_id) != tablespace) {
+    throw Exception("tablespace " + std::to_string(tablespace) + " is full");
+  }
+  next_instance_page_ids[instance_index] += num_instances;
+  RaiseNextPageId(space, page_id + 1);
+  return page_id;
+}
+
+/**
+ * Allocate an aligned run of pages above the high-water mark; the instances continue above it
+ */
+auto DiskManager::AllocateExtent(tablespace_id_t tablespace) -> page_id_t {
+  std::scoped_lock scoped_free_page_map_latch(free_page_map_latch_);
+  if (!HasTablespace(tablespace)) {
+    throw Exception("can't allocate an extent in tablespace " + std::to_string(tablespace) + ", which does not exist");
+  }
+  Tablespace *space = tablespaces_[tablespace].load();
+  // Tablespaces start at a multiple of EXTENT_SIZE, so aligning the page id aligns the offset in the file too.
+  int64_t first = (static_cast<int64_t>(space->next_page_id_) + EXTENT_SIZE - 1) / EXTENT_SIZE * EXTENT_SIZE;
+  if (first + EXTENT_SIZE > (static_cast<int64_t>(tablespace) + 1) << TABLESPACE_PAGE_BITS) {
+    throw Exception("tablespace " + std::to_string(tablespace) + " is full");
+  }
+  auto first_page_id = static_cast<page_id_t>(first);
+  page_id_t end_page_id = first_page_id + EXTENT_SIZE;
+  page_id_t old_next_page_id = space->next_page_id_;
+  RaiseNextPageId(space, end_page_id);
+  ExtendFile(space, OffsetOf(end_page_id - 1) + PAGE_SIZE);
+
+  // The pages skipped to align the extent, and those the instances had yet to reach below it, are free.
+  std::vector<page_id_t> &next_instance_page_ids = space->next_instance_page_ids_;
+  if (next_instance_page_ids.empty()) {
+    for (page_id_t page_id = old_next_page_id; page_id < first_page_id; ++page_id) {
+      MarkFreeLocked(space, page_id);
+    }
+  }
+  for (page_id_t &next_instance_page_id : next_instance_page_ids) {
+    for (; next_instance_page_id < end_page_id;
+         next_instance_page_id += static_cast<page_id_t>(next_instance_page_ids.size())) {
+      if (next_instance_page_id < first_page_id) {
+        MarkFreeLocked(space, next_instance_page_id);
+      }
+    }
+  }
+  return first_page_id;
+}
+
+void DiskManager::RaiseNextPageId(Tablespace *space, page_id_t next_page_id) {
+  if (next_page_id <= space->next_page_id_) {
+    return;
+  }
+  space->next_page_id_ = next_page_id;
+  if (TablespaceOf(next_page_id - 1) == DEFAULT_TABLESPACE) {
+    map_header_dirty_ = true;
+    size_t map_pages = (next_page_id + PAGES_PER_MAP_PAGE - 1) / PAGES_PER_MAP_PAGE;
+    free_bits_.resize(map_pages * PAGE_SIZE, 0);
+    dirty_map_pages_.resize(map_pages, false);
+  } else {
+    // The other tablespaces have no free page map: their file size is their high-water mark.
+    ExtendFile(space, OffsetOf(next_page_id - 1) + PAGE_SIZE);
+  }
+}
+
+void DiskManager::ExtendFile(Tablespace *space, int64_t size) {
+  int64_t file_size = space->file_size_.load();
+  if (size <= file_size) {
+    return;
+  }
+  // fallocate leaves what is in the file alone. Without it, the file gets a hole, unless it is longer already.
+  if (space->fd_ >= 0 && fallocate(space->fd_, 0, file_size, size - file_size) != 0) {
+    struct stat stat_buf;
+    if (fstat(space->fd_, &stat_buf) != 0 || (stat_buf.st_size < size && ftruncate(space->fd_, size) != 0)) {
+      LOG_DEBUG("I/O error while growing %s", space->file_name_.c_str());
+      return;
+    }
+  }
+  GrowFileSize(space, size);
+}
+
+void DiskManager::MarkFreeLocked(Tablespace *space, page_id_t page_id) {
+  space->free_pages_.insert(page_id);
+  if (TablespaceOf(page_id) == DEFAULT_TABLESPACE) {
+    free_bits_[page_id / 8] |= 1 << (page_id % 8);
+    dirty_map_pages_[page_id / PAGES_PER_MAP_PAGE] = true;
+  }
+}
+
+/**
+ * Return a page to the free page map; pages that are not allocated are ignored
+ */
+void DiskManager::DeallocatePage(page_id_t page_id) {
+  std::scoped_lock scoped_free_page_map_latch(free_page_map_latch_);
+  if (!IsAllocatedLocked(page_id)) {
+    return;
+  }
+  MarkFreeLocked(SpaceOf(page_id), page_id);
+}
+
+auto DiskManager::IsAllocated(page_id_t page_id) -> bool {
+  std::scoped_lock scoped_free_page_map_latch(free_page_map_latch_);
+  return IsAllocatedLocked(page_id);
+}
+
+auto DiskManager::IsAllocatedLocked(page_id_t page_id) const -> bool {
+  Tablespace *space = SpaceOf(page_id);
+  if (space == nullptr || page_id >= space->next_page_id_ || space->free_pages_.count(page_id) != 0) {
+    return false;
+  }
+  // Below the high-water mark, an instance may not have reached this id yet.
+  const std::vector<page_id_t> &next_instance_page_ids = space->next_instance_page_ids_;
+  return next_instance_page_ids.empty() ||
+         page_id < next_instance_page_ids[static_cast<uint32_t>(page_id) % next_instance_page_ids.size()];
+}
+
+/**
+ * Write the dirty bitmap pages and the high-water mark of the free page map, and sync the map file
+ */
+void DiskManager::FlushFreePageMap() {
+  std::scoped_lock scoped_free_page_map_latch(free_page_map_latch_);
+  if (fpm_fd_ < 0) {
+    return;
+  }
+  bool written = false;
+  for (size_t map_page = 0; map_page < dirty_map_pages_.size(); ++map_page) {
+    if (dirty_map_pages_[map_page]) {
+      WriteFreePageMapPage(map_page);
+      written = true;
+    }
+  }
+  if (map_header_dirty_) {
+    char header[PAGE_SIZE] = {0};
+    memcpy(header, &FREE_PAGE_MAP_MAGIC, sizeof(uint32_t));
+    memcpy(header + sizeof(uint32_t), &tablespaces_[DEFAULT_TABLESPACE].load()->next_page_id_, sizeof(page_id_t));
+    if (pwrite(fpm_fd_, header, PAGE_SIZE, 0) != PAGE_SIZE) {
+      LOG_DEBUG("I/O error while writing free page map");
     }
+    map_header_dirty_ = false;
+    written = true;
+  }
+  if (written) {
+    SyncFreePageMap();
+  }
+}
+
+/**
+ * Write one bitmap page of the free page map, which follows the header page in the file
+ */
+void DiskManager::WriteFreePageMapPage(size_t map_page) {
+  dirty_map_pages_[map_page] = false;
+  if (fpm_fd_ < 0) {
+    return;
+  }
+  if (pwrite(fpm_fd_, free_bits_.data() + map_page * PAGE_SIZE, PAGE_SIZE, (map_page + 1) * PAGE_SIZE) != PAGE_SIZE) {
+    LOG_DEBUG("I/O error while writing free page map");
+  }
+}
+
+/**
+ * Make the writes to the free page map file durable
+ */
+void DiskManager::SyncFreePageMap() {
+  if (fpm_fd_ >= 0 && fdatasync(fpm_fd_) != 0) {
+    LOG_DEBUG("I/O error while syncing free page map");
+  }
+}
+
+/**
+ * Read the free page map file. Pages written to the db file after the map was last flushed count as allocated
+ */
+void DiskManager::LoadFreePageMap(bool fresh) {
+  page_id_t stored_next_page_id = 0;
+  if (!fresh && GetFileSize(fpm_name_) >= PAGE_SIZE) {
+    char header[PAGE_SIZE];
+    if (pread(fpm_fd_, header, PAGE_SIZE, 0) != PAGE_SIZE) {
+      memset(header, 0, PAGE_SIZE);
+    }
+    uint32_t magic;
+    memcpy(&magic, header, sizeof(uint32_t));
+    if (magic == FREE_PAGE_MAP_MAGIC) {
+      memcpy(&stored_next_page_id, header + sizeof(uint32_t), sizeof(page_id_t));
+    }
+  }
+
+  // Opening the db file counted the pages in it as allocated already.
+  Tablespace *db = tablespaces_[DEFAULT_TABLESPACE].load();
+  db->next_page_id_ = std::max(stored_next_page_id, db->next_page_id_);
+  map_header_dirty_ = db->next_page_id_ != stored_next_page_id;
+  size_t map_pages = (db->next_page_id_ + PAGES_PER_MAP_PAGE - 1) / PAGES_PER_MAP_PAGE;
+  free_bits_.assign(map_pages * PAGE_SIZE, 0);
+  dirty_map_pages_.assign(map_pages, false);
+
+  size_t stored_map_pages = (stored_next_page_id + PAGES_PER_MAP_PAGE - 1) / PAGES_PER_MAP_PAGE;
+  if (stored_map_pages > 0) {
+    // A missing tail of the bitmap reads as zeros, i.e. allocated: at worst some free pages leak.
+    if (pread(fpm_fd_, free_bits_.data(), stored_map_pages * PAGE_SIZE, PAGE_SIZE) < 0) {
+      LOG_DEBUG("I/O error while reading free page map");
+    }
+  }
+  for (page_id_t page_id = 0; page_id < stored_next_page_id; ++page_id) {
+    if ((free_bits_[page_id / 8] & (1 << (page_id % 8))) != 0) {
+      db->free_pages_.insert(db->free_pages_.end(), page_id);
+    }
+  }
+}
+
+/**
+ * Write the warm-up list to a temporary file and move it over the old one
+ */
+void DiskManager::WriteWarmUpList(const std::vector<page_id_t> &page_ids) {
+  if (warm_up_name_.empty()) {
+    return;
+  }
+  std::string tmp_name = warm_up_name_ + ".tmp";
+  std::ofstream out(tmp_name, std::ios::binary | std::ios::trunc);
+  auto count = static_cast<uint32_t>(page_ids.size());
+  out.write(reinterpret_cast<const char *>(&WARM_UP_LIST_MAGIC), sizeof(uint32_t));
+  out.write(reinterpret_cast<const char *>(&count), sizeof(uint32_t));
+  out.write(reinterpret_cast<const char *>(page_ids.data()), count * sizeof(page_id_t));
+  out.close();
+  if (out.fail()) {
+    LOG_DEBUG("I/O error while writing warm-up list");
+    remove(tmp_name.c_str());
+    return;
+  }
+  rename(tmp_name.c_str(), warm_up_name_.c_str());
+}
+
+/**
+ * Read the warm-up list; a missing or truncated file reads as an empty list
+ */
+auto DiskManager::ReadWarmUpList() -> std::vector<page_id_t> {
+  std::ifstream in(warm_up_name_, std::ios::binary);
+  uint32_t magic = 0;
+  uint32_t count = 0;
+  in.read(reinterpret_cast<char *>(&magic), sizeof(uint32_t));
+  in.read(reinterpret_cast<char *>(&count), sizeof(uint32_t));
+  if (!in || magic != WARM_UP_LIST_MAGIC ||
+      GetFileSize(warm_up_name_) != static_cast<int>((2 + static_cast<size_t>(count)) * sizeof(uint32_t))) {
+    return {};
+  }
+  std::vector<page_id_t> page_ids(count);
+  in.read(reinterpret_cast<char *>(page_ids.data()), count * sizeof(page_id_t));
+  if (!in) {
+    return {};
   }
+  return page_ids;
 }
 
 /**
@@ -0,0 +1,244 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_memory.cpp
+//
+// Identification: src/storage/disk/disk_manager_memory.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_manager_memory.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <thread>  // NOLINT
+
+#include "common/exception.h"
+
+namespace bustub {
+
+auto DiskModel::Ssd() -> DiskModel {
+  DiskModel model;
+  model.read_latency_ = std::chrono::microseconds(80);
+  model.write_latency_ = std::chrono::microseconds(20);
+  model.read_bandwidth_ = 3000000000;
+  model.write_bandwidth_ = 1500000000;
+  model.jitter_ = 0.1;
+  return model;
+}
+
+auto DiskModel::Hdd() -> DiskModel {
+  DiskModel model;
+  model.read_latency_ = std::chrono::microseconds(100);
+  model.write_latency_ = std::chrono::microseconds(100);
+  model.seek_latency_ = std::chrono::milliseconds(8);
+  model.read_bandwidth_ = 150000000;
+  model.write_bandwidth_ = 150000000;
+  model.jitter_ = 0.2;
+  return model;
+}
+
+DiskManagerMemory::DiskManagerMemory(const DiskModel &model) : model_(model), rng_(model.seed_) {}
+
+DiskManagerMemory::~DiskManagerMemory() {
+  for (auto &[page_id, data] : pages_) {
+    delete[] data;
+  }
+}
+
+void DiskManagerMemory::Store(page_id_t page_id, const char *page_data) {
+  std::scoped_lock scoped_pages_latch(pages_latch_);
+  char *&data = pages_[page_id];
+  if (data == nullptr) {
+    data = new char[PAGE_SIZE];
+  }
+  memcpy(data, page_data, PAGE_SIZE);
+}
+
+void DiskManagerMemory::Load(page_id_t page_id, char *page_data) {
+  std::scoped_lock scoped_pages_latch(pages_latch_);
+  auto it = pages_.find(page_id);
+  if (it == pages_.end()) {
+    memset(page_data, 0, PAGE_SIZE);
+    return;
+  }
+  memcpy(page_data, it->second, PAGE_SIZE);
+}
+
+/**
+ * Queue the transfer behind those of the same direction, then add the latency, jittered
+ */
+auto DiskManagerMemory::Schedule(bool write, page_id_t page_id, size_t bytes) -> Clock::time_point {
+  std::scoped_lock scoped_model_latch(model_latch_);
+  Clock::time_point now = Clock::now();
+  std::chrono::nanoseconds latency = write ? model_.write_latency_ : model_.read_latency_;
+  if (page_id != INVALID_PAGE_ID) {
+    if (page_id != next_sequential_page_id_) {
+      latency += model_.seek_latency_;
+      stats_.seeks_++;
+    }
+    auto num_pages = static_cast<page_id_t>(bytes / PAGE_SIZE);
+    next_sequential_page_id_ = page_id + num_pages;
+    (write ? stats_.writes_ : stats_.reads_)++;
+    (write ? stats_.pages_written_ : stats_.pages_read_) += num_pages;
+  } else if (write) {
+    stats_.log_writes_++;
+    stats_.log_bytes_written_ += bytes;
+  }
+  if (model_.jitter_ > 0) {
+    std::uniform_real_distribution<double> factor(1 - model_.jitter_, 1 + model_.jitter_);
+    latency = std::chrono::nanoseconds(static_cast<int64_t>(static_cast<double>(latency.count()) * factor(rng_)));
+  }
+
+  Clock::time_point done = now;
+  uint64_t bandwidth = write ? model_.write_bandwidth_ : model_.read_bandwidth_;
+  if (bandwidth != 0) {
+    Clock::time_point &busy_until = write ? write_busy_until_ : read_busy_until_;
+    auto transfer = std::chrono::nanoseconds(static_cast<int64_t>(bytes * 1000000000.0 / bandwidth));
+    busy_until = std::max(busy_until, now) + transfer;
+    done = busy_until;
+  }
+  done += latency;
+  (write ? stats_.write_ns_ : stats_.read_ns_) +=
+      std::chrono::duration_cast<std::chrono::nanoseconds>(done - now).count();
+  return done;
+}
+
+void DiskManagerMemory::WritePage(page_id_t page_id, const char *page_data) {
+  num_writes_ += 1;
+  Store(page_id, page_data);
+  std::this_thread::sleep_until(Schedule(true, page_id, PAGE_SIZE));
+}
+
+void DiskManagerMemory::ReadPage(page_id_t page_id, char *page_data) {
+  Load(page_id, page_data);
+  std::this_thread::sleep_until(Schedule(false, page_id, PAGE_SIZE));
+}
+
+/**
+ * Write the pages with one I/O per run of adjacent pages, all in flight at once
+ */
+void DiskManagerMemory::WritePages(std::vector<std::pair<page_id_t, const char *>> pages) {
+  // The sort is stable so that, of a page listed twice, the later data is written last.
+  std::stable_sort(pages.begin(), pages.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+  num_writes_ += static_cast<int>(pages.size());
+  Clock::time_point done = Clock::now();
+  for (size_t begin = 0; begin < pages.size();) {
+    size_t end = begin + 1;
+    while (end < pages.size() && pages[end].first <= pages[end - 1].first + 1) {
+      ++end;
+    }
+    for (size_t i = begin; i < end; ++i) {
+      Store(pages[i].first, pages[i].second);
+    }
+    auto num_pages = static_cast<size_t>(pages[end - 1].first - pages[begin].first + 1);
+    done = std::max(done, Schedule(true, pages[begin].first, num_pages * PAGE_SIZE));
+    begin = end;
+  }
+  std::this_thread::sleep_until(done);
+}
+
+void DiskManagerMemory::ReadPages(std::vector<std::pair<page_id_t, char *>> pages) {
+  std::sort(pages.begin(), pages.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+  Clock::time_point done = Clock::now();
+  for (size_t begin = 0; begin < pages.size();) {
+    size_t end = begin + 1;
+    while (end < pages.size() && pages[end].first <= pages[end - 1].first + 1) {
+      ++end;
+    }
+    for (size_t i = begin; i < end; ++i) {
+      Load(pages[i].first, pages[i].second);
+    }
+    auto num_pages = static_cast<size_t>(pages[end - 1].first - pages[begin].first + 1);
+    done = std::max(done, Schedule(false, pages[begin].first, num_pages * PAGE_SIZE));
+    begin = end;
+  }
+  std::this_thread::sleep_until(done);
+}
+
+auto DiskManagerMemory::WritePageAsync(page_id_t page_id, const char *page_data) -> std::future<void> {
+  num_writes_ += 1;
+  Store(page_id, page_data);
+  Clock::time_point done = Schedule(true, page_id, PAGE_SIZE);
+  // Waiting for the future sleeps out the rest of the write in the waiting thread.
+  return std::async(std::launch::deferred, [done] { std::this_thread::sleep_until(done); });
+}
+
+auto DiskManagerMemory::ReadPageAsync(page_id_t page_id, char *page_data) -> std::future<void> {
+  Load(page_id, page_data);
+  Clock::time_point done = Schedule(false, page_id, PAGE_SIZE);
+  return std::async(std::launch::deferred, [done] { std::this_thread::sleep_until(done); });
+}
+
+void DiskManagerMemory::DropTablespace(tablespace_id_t tablespace) {
+  DiskManager::DropTablespace(tablespace);
+  std::scoped_lock scoped_pages_latch(pages_latch_);
+  for (auto it = pages_.begin(); it != pages_.end();) {
+    if (TablespaceOf(it->first) == tablespace) {
+      delete[] it->second;
+      it = pages_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+auto DiskManagerMemory::MapReadOnly() -> const char * {
+  throw Exception("an in-memory disk can't be mapped");
+}
+
+/**
+ * Append to the log, taking the time of a sequential write
+ */
+void DiskManagerMemory::WriteLog(char *log_data, int size) {
+  if (size == 0) {  // no effect on num_flushes_ if log buffer is empty
+    return;
+  }
+
+  flush_log_ = true;
+
+  if (flush_log_f_ != nullptr) {
+    // used for checking non-blocking flushing
+    assert(flush_log_f_->wait_for(std::chrono::seconds(10)) == std::future_status::ready);
+  }
+
+  num_flushes_ += 1;
+  {
+    std::scoped_lock scoped_log_latch(log_latch_);
+    log_.insert(log_.end(), log_data, log_data + size);
+  }
+  std::this_thread::sleep_until(Schedule(true, INVALID_PAGE_ID, size));
+  flush_log_ = false;
+}
+
+auto DiskManagerMemory::ReadLog(char *log_data, int size, int offset) -> bool {
+  size_t read_count;
+  {
+    std::scoped_lock scoped_log_latch(log_latch_);
+    if (offset < 0 || static_cast<size_t>(offset) >= log_.size()) {
+      return false;
+    }
+    read_count = std::min(static_cast<size_t>(size), log_.size() - offset);
+    memcpy(log_data, log_.data() + offset, read_count);
+  }
+  // if log ends before reading "size"
+  memset(log_data + read_count, 0, size - read_count);
+  std::this_thread::sleep_until(Schedule(false, INVALID_PAGE_ID, read_count));
+  return true;
+}
+
+auto DiskManagerMemory::GetStats() -> DiskStats {
+  std::scoped_lock scoped_model_latch(model_latch_);
+  return stats_;
+}
+
+void DiskManagerMemory::ResetStats() {
+  std::scoped_lock scoped_model_latch(model_latch_);
+  stats_ = DiskStats();
+}
+
+}  // namespace bustub
@@ -9,7 +9,9 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
 #include <string>
+#include <utility>
 
 #include "common/exception.h"
 #include "common/logger.h"
@@ -20,13 +22,18 @@
 namespace bustub {
 INDEX_TEMPLATE_ARGUMENTS
 BPLUSTREE_TYPE::BPlusTree(std::string name, BufferPoolManager *buffer_pool_manager, const KeyComparator &comparator,
-                          int leaf_max_size, int internal_max_size)
+                          int leaf_max_size, int internal_max_size, bool swizzle_children, tablespace_id_t tablespace)
     : index_name_(std::move(name)),
       root_page_id_(INVALID_PAGE_ID),
       buffer_pool_manager_(buffer_pool_manager),
       comparator_(comparator),
-      leaf_max_size_(leaf_max_size),
-      internal_max_size_(internal_max_size) {}
+      // Insert puts an entry into a full node before it splits it, so a node must have room for one over its max size.
+      leaf_max_size_(std::min<int>(leaf_max_size, LEAF_PAGE_SIZE - 1)),
+      internal_max_size_(std::min<int>(
+          internal_max_size, (PAGE_SIZE - INTERNAL_PAGE_HEADER_SIZE) / sizeof(std::pair<KeyType, page_id_t>) - 1)),
+      swizzle_children_(swizzle_children),
+      leaf_extent_(tablespace),
+      internal_extent_(tablespace) {}
 
 /*
  * Helper function to decide whether current b+tree is empty
@@ -39,39 +46,33 @@ auto BPLUSTREE_TYPE::IsEmpty() const -> bool { return root_page_id_ == INVALID_P
 /*
  * Return the only value that associated with input key
  * This method is used for point query
+ * No page is latched: the lookup starts over if a writer changed the leaf
+ * while it was being read
  * @return : true means key exists
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction) -> bool {
-  rwlatch_.RLock();
-
-  if (IsEmpty()) {
-    rwlatch_.RUnlock();
-    return false;
-  }
-
-  Page *page = nullptr;
-  if (transaction == nullptr) {
-    page = FindLeafPage(key, false);
-  } else {
-    page = FindLeafPage(key, OP_MODE::READ, transaction, false);
-  }
-
-  auto node = reinterpret_cast<BPlusTreeLeafPage<KeyType, RID, KeyComparator> *>(page->GetData());
-  ValueType value = ValueType{};
-  bool isExist = node->Lookup(key, &value, comparator_);
-  if (isExist) {
-    result->push_back(value);
-  }
+  while (true) {
+    uint64_t version;
+    Page *page = OptimisticFindLeafPage(key, false, &version);
+    if (page == nullptr) {
+      return false;
+    }
 
-  if (transaction != nullptr) {
-    UnlockPage(transaction, OP_MODE::READ, false);
-  } else {
-    page->RUnlatch();
+    auto node = reinterpret_cast<LeafPage *>(page->GetData());
+    ValueType value = ValueType{};
+    // Until the leaf is validated its size may be anything; searching it must not leave the page.
+    bool isExist =
+        node->GetSize() >= 0 && node->GetSize() <= leaf_max_size_ + 1 && node->Lookup(key, &value, comparator_);
+    bool valid = page->ValidateVersion(version);
     buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+    if (valid) {
+      if (isExist) {
+        result->push_back(value);
+      }
+      return isExist;
+    }
   }
-
-  return isExist;
 }
 
 INDEX_TEMPLATE_ARGUMENTS
@@ -143,7 +144,7 @@ auto BPLUSTREE_TYPE::Insert(const KeyType &key, const ValueType &value, Transact
  */
 INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::StartNewTree(const KeyType &key, const ValueType &value) {
-  Page *page = buffer_pool_manager_->NewPage(&root_page_id_);
+  Page *page = buffer_pool_manager_->NewPageInExtent(&root_page_id_, &leaf_extent_);
   if (page == nullptr) {
     throw Exception(ExceptionType::OUT_OF_MEMORY, "can't find a new page for the tree");
   }
@@ -199,26 +200,24 @@ INDEX_TEMPLATE_ARGUMENTS
 template <typename N>
 auto BPLUSTREE_TYPE::Split(N *node) -> N * {
   page_id_t page_id;
-  Page *page = buffer_pool_manager_->NewPage(&page_id);
+  Page *page = buffer_pool_manager_->NewPageInExtent(&page_id, node->IsLeafPage() ? &leaf_extent_ : &internal_extent_);
   if (page == nullptr) {
     throw Exception(ExceptionType::OUT_OF_MEMORY, "can't find a new page for the tree");
     return nullptr;
   }
 
+  // The frame of a new page is not necessarily zeroed, so every header field must be set.
   N *new_node = reinterpret_cast<N *>(page->GetData());
-  new_node->SetPageId(page_id);
+  new_node->SetLSN();
   if (node->IsLeafPage()) {
     auto *leaf = reinterpret_cast<BPlusTreeLeafPage<KeyType, RID, KeyComparator> *>(node);
-    new_node->SetMaxSize(leaf_max_size_);
     auto *new_leaf = reinterpret_cast<BPlusTreeLeafPage<KeyType, RID, KeyComparator> *>(new_node);
-    new_leaf->SetPageType(IndexPageType::LEAF_PAGE);
-    new_leaf->SetNextPageId(INVALID_PAGE_ID);
+    new_leaf->Init(page_id, node->GetParentPageId(), leaf_max_size_);
     leaf->MoveHalfTo(new_leaf);
   } else {
     auto *internal = reinterpret_cast<BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> *>(node);
-    new_node->SetMaxSize(internal_max_size_);
     auto *new_internal = reinterpret_cast<BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> *>(new_node);
-    new_internal->SetPageType(IndexPageType::INTERNAL_PAGE);
+    new_internal->Init(page_id, node->GetParentPageId(), internal_max_size_);
     internal->MoveHalfTo(new_internal, buffer_pool_manager_);
   }
 
@@ -238,7 +237,7 @@ INDEX_TEMPLATE_ARGUMENTS
 void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &key, BPlusTreePage *new_node,
                                       Transaction *transaction) {
   if (old_node->GetParentPageId() == INVALID_PAGE_ID) {
-    Page *new_root = buffer_pool_manager_->NewPage(&root_page_id_);
+    Page *new_root = buffer_pool_manager_->NewPageInExtent(&root_page_id_, &internal_extent_);
     if (new_root == nullptr) {
       throw Exception(ExceptionType::OUT_OF_MEMORY, "can't find a new page for the tree");
     }
@@ -258,9 +257,9 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &ke
 
   Page *page = buffer_pool_manager_->FetchPage(old_node->GetParentPageId());
   auto parent = reinterpret_cast<BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> *>(page->GetData());
+  // The caller keeps its pins on old_node and new_node: old_node is still latched through the transaction, and a page
+  // that is unpinned early may be evicted while it is being written to.
   new_node->SetParentPageId(parent->GetPageId());
-  buffer_pool_manager_->UnpinPage(new_node->GetPageId(), true);
-  buffer_pool_manager_->UnpinPage(old_node->GetPageId(), true);
   if (parent->GetSize() < parent->GetMaxSize()) {
     parent->InsertNodeAfter(old_node->GetPageId(), key, new_node->GetPageId());
     buffer_pool_manager_->UnpinPage(parent->GetPageId(), true);
@@ -268,6 +267,7 @@ void BPLUSTREE_TYPE::InsertIntoParent(BPlusTreePage *old_node, const KeyType &ke
     parent->InsertNodeAfter(old_node->GetPageId(), key, new_node->GetPageId());
     auto new_p_node = Split(parent);
     InsertIntoParent(parent, new_p_node->KeyAt(0), new_p_node, transaction);
+    buffer_pool_manager_->UnpinPage(new_p_node->GetPageId(), true);
     buffer_pool_manager_->UnpinPage(parent->GetPageId(), true);
   }
 }
@@ -349,21 +349,26 @@ auto BPLUSTREE_TYPE::CoalesceOrRedistribute(N *node, Transaction *transaction) -
     sibling_id = parent->ValueAt(index - 1);
   }
 
+  // The sibling is not on the latched path, but optimistic readers only notice changes made under the write latch.
   Page *s_page = buffer_pool_manager_->FetchPage(sibling_id);
+  s_page->WLatch();
   N *sibling = reinterpret_cast<N *>(s_page->GetData());
   if (sibling->GetSize() + node->GetSize() > node->GetMaxSize()) {
     Redistribute(sibling, node, index);
+    s_page->WUnlatch();
     buffer_pool_manager_->UnpinPage(s_page->GetPageId(), true);
     buffer_pool_manager_->UnpinPage(p_page->GetPageId(), true);
     return false;
   }
   if (index == 0) {
     Coalesce(&node, &sibling, &parent, 1, transaction);
+    s_page->WUnlatch();
     buffer_pool_manager_->UnpinPage(p_page->GetPageId(), true);
     buffer_pool_manager_->UnpinPage(s_page->GetPageId(), false);
     return true;
   }
   Coalesce(&sibling, &node, &parent, index, transaction);
+  s_page->WUnlatch();
   buffer_pool_manager_->UnpinPage(p_page->GetPageId(), true);
   buffer_pool_manager_->UnpinPage(s_page->GetPageId(), true);
   return true;
@@ -483,14 +488,14 @@ auto BPLUSTREE_TYPE::AdjustRoot(BPlusTreePage *old_root_node) -> bool {
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::Begin() -> INDEXITERATOR_TYPE {
-  rwlatch_.RLock();
-  if (IsEmpty()) {
-    rwlatch_.RUnlock();
-    return INDEXITERATOR_TYPE();
+  while (true) {
+    uint64_t version;
+    Page *page = OptimisticFindLeafPage(KeyType{}, true, &version);
+    INDEXITERATOR_TYPE iterator(page, version, nullptr, &comparator_, buffer_pool_manager_);
+    if (!iterator.IsStale()) {
+      return iterator;
+    }
   }
-
-  Page *page = FindLeafPage(KeyType{}, true);
-  return INDEXITERATOR_TYPE(page, 0, buffer_pool_manager_);
 }
 
 /*
@@ -500,16 +505,16 @@ auto BPLUSTREE_TYPE::Begin() -> INDEXITERATOR_TYPE {
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE {
-  rwlatch_.RLock();
-  if (IsEmpty()) {
-    rwlatch_.RUnlock();
-    return INDEXITERATOR_TYPE();
+  // A leaf that split after the descent may have moved the key to a sibling; the scan must then not start from the
+  // leaf found, but from a new descent.
+  while (true) {
+    uint64_t version;
+    Page *page = OptimisticFindLeafPage(key, false, &version);
+    INDEXITERATOR_TYPE iterator(page, version, &key, &comparator_, buffer_pool_manager_);
+    if (!iterator.IsStale()) {
+      return iterator;
+    }
   }
-
-  Page *page = FindLeafPage(key, false);
-  auto node = reinterpret_cast<BPlusTreeLeafPage<KeyType, RID, KeyComparator> *>(page->GetData());
-  int index = node->KeyIndex(key, comparator_);
-  return INDEXITERATOR_TYPE(page, index, buffer_pool_manager_);
 }
 
 /*
@@ -518,7 +523,7 @@ auto BPLUSTREE_TYPE::Begin(const KeyType &key) -> INDEXITERATOR_TYPE {
  * @return : index iterator
  */
 INDEX_TEMPLATE_ARGUMENTS
-auto BPLUSTREE_TYPE::End() -> INDEXITERATOR_TYPE { return INDEXITERATOR_TYPE(nullptr, 0, buffer_pool_manager_); }
+auto BPLUSTREE_TYPE::End() -> INDEXITERATOR_TYPE { return INDEXITERATOR_TYPE(); }
 
 /*****************************************************************************
  * UTILITIES AND DEBUG
@@ -529,11 +534,9 @@ auto BPLUSTREE_TYPE::End() -> INDEXITERATOR_TYPE { return INDEXITERATOR_TYPE(nul
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, bool leftMost) -> Page * {
-  page_id_t page_id = root_page_id_;
+  Page *page = buffer_pool_manager_->FetchPage(root_page_id_);
   Page *pre_page = nullptr;
   while (true) {
-    Page *page = buffer_pool_manager_->FetchPage(page_id);
-
     page->RLatch();
 
     auto node = reinterpret_cast<BPlusTreePage *>(page->GetData());
@@ -549,22 +552,16 @@ auto BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, bool leftMost) -> Page * {
     if (node->IsLeafPage()) {
       return page;
     }
-    auto internal = reinterpret_cast<BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> *>(node);
-    if (leftMost) {
-      page_id = internal->ValueAt(0);
-    } else {
-      page_id = internal->Lookup(key, comparator_);
-    }
+    auto internal = reinterpret_cast<InternalPage *>(node);
+    page = FetchChild(page, leftMost ? 0 : internal->LookupIndex(key, comparator_));
   }
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 Page *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, OP_MODE op_mode, Transaction *transaction, bool leftMost) {
-  page_id_t page_id = root_page_id_;
+  Page *page = buffer_pool_manager_->FetchPage(root_page_id_);
   Page *pre_page = nullptr;
   while (true) {
-    Page *page = buffer_pool_manager_->FetchPage(page_id);
-
     if (op_mode == OP_MODE::READ) {
       page->RLatch();
     } else {
@@ -590,15 +587,94 @@ Page *BPLUSTREE_TYPE::FindLeafPage(const KeyType &key, OP_MODE op_mode, Transact
     if (node->IsLeafPage()) {
       return page;
     }
-    auto internal = reinterpret_cast<BPlusTreeInternalPage<KeyType, page_id_t, KeyComparator> *>(node);
-    if (leftMost) {
-      page_id = internal->ValueAt(0);
-    } else {
-      page_id = internal->Lookup(key, comparator_);
+    auto internal = reinterpret_cast<InternalPage *>(node);
+    page = FetchChild(page, leftMost ? 0 : internal->LookupIndex(key, comparator_));
+  }
+}
+
+/*
+ * Find the leaf page containing key (or the left most leaf page) without
+ * latching any page. Each internal page is read optimistically, and the child
+ * is pinned before the page is validated, so that a child reached through a
+ * link that changed meanwhile is never read. The descent starts over whenever
+ * a validation fails.
+ * @return: the pinned leaf page, or nullptr if the tree is empty. The caller
+ * must check *version against the leaf before trusting what it read from it
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::OptimisticFindLeafPage(const KeyType &key, bool leftMost, uint64_t *version) -> Page * {
+  while (true) {
+    // root_page_id_ is still protected by the tree latch.
+    rwlatch_.RLock();
+    if (IsEmpty()) {
+      rwlatch_.RUnlock();
+      return nullptr;
+    }
+    Page *page = buffer_pool_manager_->FetchPage(root_page_id_);
+    uint64_t page_version = page->ReadVersion();
+    rwlatch_.RUnlock();
+    // A writer lets go of the tree latch once it holds the root, before it splits it. The page it held may have stopped
+    // being the root by the time ReadVersion returns; the version validates that it still is below.
+    if (!reinterpret_cast<BPlusTreePage *>(page->GetData())->IsRootPage()) {
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      continue;
     }
+
+    while (true) {
+      auto node = reinterpret_cast<BPlusTreePage *>(page->GetData());
+      if (node->IsLeafPage()) {
+        *version = page_version;
+        return page;
+      }
+      // A page that is being changed may show any size; searching it must not leave the page.
+      auto internal = reinterpret_cast<InternalPage *>(node);
+      if (internal->GetSize() < 1 || internal->GetSize() > internal_max_size_ + 1) {
+        break;
+      }
+      int index = leftMost ? 0 : internal->LookupIndex(key, comparator_);
+      if (!page->ValidateVersion(page_version)) {
+        break;
+      }
+      // Until the parent is validated the child id may be garbage, which need not lead to any page.
+      Page *child = FetchChild(page, index);
+      uint64_t child_version = child != nullptr ? child->ReadVersion() : 0;
+      if (!page->ValidateVersion(page_version)) {
+        if (child != nullptr) {
+          buffer_pool_manager_->UnpinPage(child->GetPageId(), false);
+        }
+        break;
+      }
+      if (child == nullptr) {
+        buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+        throw Exception(ExceptionType::OUT_OF_MEMORY, "can't fetch a page of the tree");
+      }
+      buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
+      page = child;
+      page_version = child_version;
+    }
+    buffer_pool_manager_->UnpinPage(page->GetPageId(), false);
   }
 }
 
+/*
+ * Fetch the child at the given index of a pinned internal page.
+ * In swizzled mode the frame the child was last found in is tried first, and
+ * the frame it is found in now is remembered for the next traversal.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto BPLUSTREE_TYPE::FetchChild(Page *page, int index) -> Page * {
+  page_id_t child_id = reinterpret_cast<InternalPage *>(page->GetData())->ValueAt(index);
+  // An internal page holds one entry too many for a moment before it splits.
+  std::atomic<frame_id_t> *child_frames = swizzle_children_ ? page->GetChildFrames(internal_max_size_ + 1) : nullptr;
+  if (child_frames == nullptr) {
+    return buffer_pool_manager_->FetchPage(child_id);
+  }
+  frame_id_t frame_id = child_frames[index].load(std::memory_order_relaxed);
+  Page *child = buffer_pool_manager_->FetchPageWithHint(child_id, &frame_id);
+  child_frames[index].store(frame_id, std::memory_order_relaxed);
+  return child;
+}
+
 /*
  * Update/Insert root page id in header page(where page_id = 0, header_page is
  * defined under include/page/header_page.h)
@@ -1,7 +1,9 @@
 /**
  * index_iterator.cpp
  */
+#include <algorithm>
 #include <cassert>
+#include <utility>
 
 #include "storage/index/index_iterator.h"
 
@@ -12,64 +14,167 @@ namespace bustub {
  * set your own input parameters
  */
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE::IndexIterator() : cur_page_id_(INVALID_PAGE_ID), leaf_(nullptr) {}
-
-INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE::IndexIterator(Page *page, int site, BufferPoolManager *buffer_pool_manager) {
-  cur_site_ = site;
-  buffer_pool_manager_ = buffer_pool_manager;
+INDEXITERATOR_TYPE::IndexIterator(Page *page, uint64_t version, const KeyType *key, const KeyComparator *comparator,
+                                  BufferPoolManager *buffer_pool_manager)
+    : cur_page_(page),
+      comparator_(comparator),
+      buffer_pool_manager_(buffer_pool_manager),
+      read_ahead_(buffer_pool_manager) {
   if (page == nullptr) {
-    cur_page_id_ = INVALID_PAGE_ID;
-    is_end_ = true;
     return;
   }
-
-  leaf_ = reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(page->GetData());
-  cur_page_id_ = leaf_->GetPageId();
-  cur_page_ = page;
+  cur_page_id_ = page->GetPageId();
   is_end_ = false;
+  ReadLeaf();
+  if (version_ != version) {
+    is_stale_ = true;
+    Finish();
+    return;
+  }
+  if (key != nullptr) {
+    resume_key_ = *key;
+    resume_inclusive_ = true;
+    has_resume_key_ = true;
+  }
+  SkipResumed();
+  SkipExhaustedLeaves();
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+INDEXITERATOR_TYPE::~IndexIterator() {  // NOLINT
+  if (!is_end_) {
+    buffer_pool_manager_->UnpinPage(cur_page_id_, false);
+  }
 }
 
 INDEX_TEMPLATE_ARGUMENTS
-INDEXITERATOR_TYPE::~IndexIterator() = default;  // NOLINT
+INDEXITERATOR_TYPE::IndexIterator(IndexIterator &&other) noexcept { *this = std::move(other); }
+
+INDEX_TEMPLATE_ARGUMENTS
+auto INDEXITERATOR_TYPE::operator=(IndexIterator &&other) noexcept -> INDEXITERATOR_TYPE & {
+  if (this != &other) {
+    if (!is_end_) {
+      buffer_pool_manager_->UnpinPage(cur_page_id_, false);
+    }
+    cur_page_id_ = other.cur_page_id_;
+    cur_site_ = other.cur_site_;
+    cur_page_ = other.cur_page_;
+    comparator_ = other.comparator_;
+    buffer_pool_manager_ = other.buffer_pool_manager_;
+    items_ = std::move(other.items_);
+    next_page_id_ = other.next_page_id_;
+    version_ = other.version_;
+    is_end_ = other.is_end_;
+    is_stale_ = other.is_stale_;
+    resume_key_ = other.resume_key_;
+    resume_inclusive_ = other.resume_inclusive_;
+    has_resume_key_ = other.has_resume_key_;
+    read_ahead_ = other.read_ahead_;
+    // The pin on the current leaf moves along.
+    other.is_end_ = true;
+  }
+  return *this;
+}
 
 INDEX_TEMPLATE_ARGUMENTS
 auto INDEXITERATOR_TYPE::IsEnd() -> bool { return is_end_; }
 
 INDEX_TEMPLATE_ARGUMENTS
 auto INDEXITERATOR_TYPE::operator*() -> const MappingType & {
-  assert(leaf_ != nullptr);
   if (is_end_) {
     throw Exception(ExceptionType::OUT_OF_RANGE, "Already get the last iterator, the iterator is out of range");
   }
-  return leaf_->GetItem(cur_site_);
+  return items_[cur_site_];
 }
 
 INDEX_TEMPLATE_ARGUMENTS
 auto INDEXITERATOR_TYPE::operator++() -> INDEXITERATOR_TYPE & {
-  assert(leaf_ != nullptr);
   if (is_end_) {
     throw Exception(ExceptionType::OUT_OF_RANGE, "Already get the last iterator, the iterator is out of range");
   }
-  if (cur_site_ < leaf_->GetSize() - 1) {
+  cur_site_++;
+  SkipExhaustedLeaves();
+  return *this;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::ReadLeaf() {
+  auto leaf = reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(cur_page_->GetData());
+  do {
+    version_ = cur_page_->ReadVersion();
+    // The size is not validated yet, so it must not take the copy past the end of the page.
+    int size = std::clamp<int>(leaf->GetSize(), 0, LEAF_PAGE_SIZE);
+    items_.assign(&leaf->GetItem(0), &leaf->GetItem(0) + size);
+    next_page_id_ = leaf->GetNextPageId();
+  } while (!cur_page_->ValidateVersion(version_));
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::SkipTo(const KeyType &key, bool inclusive) {
+  cur_site_ = 0;
+  while (static_cast<size_t>(cur_site_) < items_.size()) {
+    int cmp = (*comparator_)(items_[cur_site_].first, key);
+    if (cmp > 0 || (inclusive && cmp == 0)) {
+      break;
+    }
     cur_site_++;
-  } else if (leaf_->GetNextPageId() != INVALID_PAGE_ID) {
-    cur_site_ = 0;
-    cur_page_id_ = leaf_->GetNextPageId();
-    cur_page_->RUnlatch();
-    buffer_pool_manager_->UnpinPage(cur_page_->GetPageId(), false);
-
-    cur_page_ = buffer_pool_manager_->FetchPage(cur_page_id_);
-    cur_page_->RLatch();
-    leaf_ = reinterpret_cast<B_PLUS_TREE_LEAF_PAGE_TYPE *>(cur_page_->GetData());
-  } else {
-    cur_page_->RUnlatch();
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::SkipExhaustedLeaves() {
+  while (static_cast<size_t>(cur_site_) >= items_.size()) {
+    if (next_page_id_ == INVALID_PAGE_ID) {
+      Finish();
+      return;
+    }
+    read_ahead_.Advance(cur_page_id_, next_page_id_);
+    Page *next_page = buffer_pool_manager_->FetchPage(next_page_id_);
+    // A leaf is only deleted once its entries have been moved into its left neighbour, which changes the neighbour.
+    // While the current leaf is unchanged, the link just followed still leads to a live leaf.
+    if (!cur_page_->ValidateVersion(version_)) {
+      if (next_page != nullptr) {
+        buffer_pool_manager_->UnpinPage(next_page_id_, false);
+      }
+      // The entries up to the last one returned may have moved on to a new right sibling, so keep skipping them there
+      // too. While a resume key is still set, none of the current leaf's entries have been returned.
+      if (!has_resume_key_ && !items_.empty()) {
+        resume_key_ = items_.back().first;
+        resume_inclusive_ = false;
+        has_resume_key_ = true;
+      }
+      ReadLeaf();
+      SkipResumed();
+      continue;
+    }
+    if (next_page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "can't fetch the next leaf");
+    }
     buffer_pool_manager_->UnpinPage(cur_page_id_, false);
-    cur_page_id_ = INVALID_PAGE_ID;
-    cur_site_ = 0;
-    is_end_ = true;
+    cur_page_ = next_page;
+    cur_page_id_ = next_page_id_;
+    ReadLeaf();
+    SkipResumed();
   }
-  return *this;
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::SkipResumed() {
+  cur_site_ = 0;
+  if (has_resume_key_) {
+    SkipTo(resume_key_, resume_inclusive_);
+    has_resume_key_ = static_cast<size_t>(cur_site_) >= items_.size();
+  }
+}
+
+INDEX_TEMPLATE_ARGUMENTS
+void INDEXITERATOR_TYPE::Finish() {
+  buffer_pool_manager_->UnpinPage(cur_page_id_, false);
+  cur_page_ = nullptr;
+  cur_page_id_ = INVALID_PAGE_ID;
+  cur_site_ = 0;
+  items_.clear();
+  is_end_ = true;
 }
 
 template class IndexIterator<GenericKey<4>, RID, GenericComparator<4>>;
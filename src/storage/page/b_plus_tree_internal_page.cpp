@@ -90,20 +90,28 @@ auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::ValueAt(int index) const -> ValueType {
  */
 INDEX_TEMPLATE_ARGUMENTS
 auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::Lookup(const KeyType &key, const KeyComparator &comparator) const -> ValueType {
+  return array_[LookupIndex(key, comparator)].second;
+}
+
+/*
+ * Same as Lookup, but return the index of the child pointer instead
+ */
+INDEX_TEMPLATE_ARGUMENTS
+auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::LookupIndex(const KeyType &key, const KeyComparator &comparator) const -> int {
   int s = 1;
   int e = GetSize() - 1;
   if (comparator(key, array_[s].first) < 0) {
-    return array_[0].second;
+    return 0;
   }
   if (comparator(key, array_[e].first) >= 0) {
-    return array_[e].second;
+    return e;
   }
 
   while (s <= e) {
     int mid = (s + e) / 2;
     int c = comparator(key, array_[mid].first);
     if (c == 0) {
-      return array_[mid].second;
+      return mid;
     }
     if (c < 0) {
       e = mid - 1;
@@ -112,7 +120,7 @@ auto B_PLUS_TREE_INTERNAL_PAGE_TYPE::Lookup(const KeyType &key, const KeyCompara
     }
   }
 
-  return array_[s - 1].second;
+  return s - 1;
 }
 
 /*****************************************************************************
@@ -265,7 +273,7 @@ void B_PLUS_TREE_INTERNAL_PAGE_TYPE::CopyLastFrom(const MappingType &pair, Buffe
   if (page == nullptr) {
     throw Exception("all page are pinned while CopyLastFrom");
   }
-  auto child = reinterpret_cast<BPlusTreePage *>(page);
+  auto child = reinterpret_cast<BPlusTreePage *>(page->GetData());
 
   child->SetParentPageId(GetPageId());
   buffer_pool_manager->UnpinPage(pair.second, true);
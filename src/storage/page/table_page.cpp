@@ -295,6 +295,10 @@ auto TablePage::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, LockMan
 
   // At this point, we have at least a shared lock on the RID. Copy the tuple data into our result.
   uint32_t tuple_offset = GetTupleOffsetAtSlot(slot_num);
+  // An optimistic reader may see a slot that a writer is halfway through changing. It will read the tuple again.
+  if (tuple_offset > PAGE_SIZE || tuple_size > PAGE_SIZE - tuple_offset) {
+    return false;
+  }
   tuple->size_ = tuple_size;
   if (tuple->allocated_) {
     delete[] tuple->data_;
@@ -16,10 +16,16 @@
 
 namespace bustub {
 
-TableIterator::TableIterator(TableHeap *table_heap, RID rid, Transaction *txn)
-    : table_heap_(table_heap), tuple_(new Tuple(rid)), txn_(txn) {
+TableIterator::TableIterator(TableHeap *table_heap, RID rid, Transaction *txn, BufferAccessStrategy *strategy,
+                             PinCache *pin_cache)
+    : table_heap_(table_heap),
+      tuple_(new Tuple(rid)),
+      txn_(txn),
+      strategy_(strategy),
+      pin_cache_(pin_cache),
+      read_ahead_(table_heap != nullptr ? table_heap->buffer_pool_manager_ : nullptr, strategy) {
   if (rid.GetPageId() != INVALID_PAGE_ID) {
-    table_heap_->GetTuple(tuple_->rid_, tuple_, txn_);
+    table_heap_->GetTuple(tuple_->rid_, tuple_, txn_, pin_cache_);
   }
 }
 
@@ -35,7 +41,18 @@ auto TableIterator::operator->() -> Tuple * {
 
 auto TableIterator::operator++() -> TableIterator & {
   BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
-  auto cur_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(tuple_->rid_.GetPageId()));
+  // With a pin cache, the page stays pinned from one tuple to the next and is only fetched from the pool once.
+  auto fetch = [&](page_id_t page_id) {
+    Page *page = pin_cache_ != nullptr ? pin_cache_->FetchPage(page_id, strategy_)
+                                       : buffer_pool_manager->FetchPageWithStrategy(page_id, strategy_);
+    return static_cast<TablePage *>(page);
+  };
+  auto unpin = [&](TablePage *page) {
+    if (pin_cache_ == nullptr) {
+      buffer_pool_manager->UnpinPage(page->GetTablePageId(), false);
+    }
+  };
+  auto cur_page = fetch(tuple_->rid_.GetPageId());
   cur_page->RLatch();
   assert(cur_page != nullptr);  // all pages are pinned
 
@@ -43,9 +60,10 @@ auto TableIterator::operator++() -> TableIterator & {
   if (!cur_page->GetNextTupleRid(tuple_->rid_,
                                  &next_tuple_rid)) {  // end of this page
     while (cur_page->GetNextPageId() != INVALID_PAGE_ID) {
-      auto next_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(cur_page->GetNextPageId()));
+      read_ahead_.Advance(cur_page->GetTablePageId(), cur_page->GetNextPageId());
+      auto next_page = fetch(cur_page->GetNextPageId());
       cur_page->RUnlatch();
-      buffer_pool_manager->UnpinPage(cur_page->GetTablePageId(), false);
+      unpin(cur_page);
       cur_page = next_page;
       cur_page->RLatch();
       if (cur_page->GetFirstTupleRid(&next_tuple_rid)) {
@@ -56,11 +74,11 @@ auto TableIterator::operator++() -> TableIterator & {
   tuple_->rid_ = next_tuple_rid;
 
   if (*this != table_heap_->End()) {
-    table_heap_->GetTuple(tuple_->rid_, tuple_, txn_);
+    table_heap_->GetTuple(tuple_->rid_, tuple_, txn_, pin_cache_);
   }
   // release until copy the tuple
   cur_page->RUnlatch();
-  buffer_pool_manager->UnpinPage(cur_page->GetTablePageId(), false);
+  unpin(cur_page);
   return *this;
 }
 
@@ -11,9 +11,19 @@
 //===----------------------------------------------------------------------===//
 
 #include "buffer/buffer_pool_manager_instance.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
 #include <cstdio>
+#include <cstring>
+#include <future>  // NOLINT
+#include <iostream>
+#include <memory>
+#include <mutex>  // NOLINT
 #include <random>
 #include <string>
+#include <thread>  // NOLINT
+#include <vector>
 #include "buffer/buffer_pool_manager.h"
 #include "gtest/gtest.h"
 
@@ -80,6 +90,7 @@ TEST(BufferPoolManagerInstanceTest, BinaryDataTest) {
   // Shutdown the disk manager and remove the temporary file we created.
   disk_manager->ShutDown();
   remove("test.db");
+  remove("test.fpm");
 
   delete bpm;
   delete disk_manager;
@@ -136,6 +147,955 @@ TEST(BufferPoolManagerInstanceTest, SampleTest) {
   // Shutdown the disk manager and remove the temporary file we created.
   disk_manager->ShutDown();
   remove("test.db");
+  remove("test.fpm");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerInstanceTest, ConcurrentFetchTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 8;
+  const int num_pages = 64;
+  const int num_threads = 8;
+  const int rounds = 200;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Scenario: create more pages than fit in the pool, each stamped with its own id.
+  for (int i = 0; i < num_pages; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(i, page_id);
+    snprintf(page->GetData(), PAGE_SIZE, "page-%d", page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+
+  // Scenario: threads fetch overlapping pages, so misses, dirty write-backs and hits on pages that are still being
+  // read in all race with each other. Every fetch must see the contents of the page it asked for.
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&, t] {
+      char expected[PAGE_SIZE];
+      for (int i = 0; i < rounds; ++i) {
+        page_id_t page_id = (t * 7 + i * 3) % num_pages;
+        Page *page = bpm->FetchPage(page_id);
+        if (page == nullptr) {
+          continue;
+        }
+        snprintf(expected, PAGE_SIZE, "page-%d", page_id);
+        page->RLatch();
+        EXPECT_EQ(0, strcmp(page->GetData(), expected));
+        page->RUnlatch();
+        EXPECT_TRUE(bpm->UnpinPage(page_id, i % 2 == 0));
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.fpm");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+// Check that deleted pages are handed out again, also after a restart, instead of growing the file.
+TEST(BufferPoolManagerInstanceTest, DeletedPageReuseTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  page_id_t page_id;
+  for (int i = 0; i < 5; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_EQ(i, page_id);
+  }
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(true, bpm->UnpinPage(i, true));
+  }
+
+  // Scenario: a pinned page cannot be deleted, so its id stays in use.
+  EXPECT_EQ(false, bpm->DeletePage(4));
+  EXPECT_EQ(true, bpm->DeletePage(2));
+  EXPECT_EQ(true, bpm->DeletePage(1));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_EQ(1, page_id);
+
+  // Scenario: the free page map survives a restart.
+  EXPECT_EQ(true, bpm->UnpinPage(1, false));
+  EXPECT_EQ(true, bpm->UnpinPage(4, false));
+  bpm->FlushAllPages();
+  delete bpm;
+  disk_manager->ShutDown();
+  delete disk_manager;
+
+  disk_manager = new DiskManager(db_name);
+  bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_EQ(2, page_id);
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_EQ(5, page_id);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.fpm");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+// Check that GetStats counts hits, misses, evictions and failures as they happen.
+TEST(BufferPoolManagerInstanceTest, StatsTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  page_id_t page_id;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  }
+  for (page_id_t i = 0; i < static_cast<page_id_t>(buffer_pool_size); ++i) {
+    EXPECT_EQ(true, bpm->UnpinPage(i, true));
+  }
+  BufferPoolStats stats = bpm->GetStats();
+  EXPECT_EQ(0, stats.hits_);
+  EXPECT_EQ(0, stats.misses_);
+  EXPECT_EQ(0, stats.evictions_);
+
+  // Scenario: a hit on page 0 leaves page 1 least recently used, so it is evicted for the new page 4, and page 2 for
+  // reading page 1 back in. Both were dirty.
+  ASSERT_NE(nullptr, bpm->FetchPage(0));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_EQ(4, page_id);
+  ASSERT_NE(nullptr, bpm->FetchPage(1));
+  stats = bpm->GetStats();
+  EXPECT_EQ(1, stats.hits_);
+  EXPECT_EQ(1, stats.misses_);
+  EXPECT_EQ(2, stats.evictions_);
+  EXPECT_EQ(2, stats.dirty_write_backs_);
+  EXPECT_EQ(2, stats.replacer_victims_);
+
+  // Scenario: with pages {0, 1, 3, 4} pinned, page 2 cannot come back in.
+  ASSERT_NE(nullptr, bpm->FetchPage(3));
+  EXPECT_EQ(nullptr, bpm->FetchPage(2));
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id));
+  stats = bpm->GetStats();
+  EXPECT_EQ(2, stats.hits_);
+  EXPECT_EQ(2, stats.no_free_frame_failures_);
+  EXPECT_EQ(0, stats.latch_wait_ns_);
+  EXPECT_DOUBLE_EQ(2.0 / 3.0, stats.HitRatio());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.fpm");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+// Check that the pool grows without evicting anything, and that shrinking writes back the pages it evicts.
+TEST(BufferPoolManagerInstanceTest, ResizeTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, nullptr, ReplacerType::LRU,
+                                            LRUK_REPLACER_K, 4 * buffer_pool_size);
+  EXPECT_EQ(4 * buffer_pool_size, bpm->GetMaxPoolSize());
+
+  page_id_t page_id;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+  }
+
+  // Scenario: growing makes room for more pages while the first ones stay pinned.
+  EXPECT_TRUE(bpm->Resize(2 * buffer_pool_size));
+  EXPECT_EQ(2 * buffer_pool_size, bpm->GetPoolSize());
+  for (size_t i = buffer_pool_size; i < 2 * buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id));
+  EXPECT_EQ(0, bpm->GetStats().evictions_);
+
+  // Scenario: shrinking fails while the frames to be removed hold pinned pages.
+  for (page_id_t i = 0; i < static_cast<page_id_t>(2 * buffer_pool_size); ++i) {
+    EXPECT_EQ(true, bpm->UnpinPage(i, i != 7));
+  }
+  ASSERT_NE(nullptr, bpm->FetchPage(7));
+  EXPECT_FALSE(bpm->Resize(buffer_pool_size));
+  EXPECT_EQ(2 * buffer_pool_size, bpm->GetPoolSize());
+  EXPECT_EQ(true, bpm->UnpinPage(7, true));
+
+  // Scenario: once they are unpinned, their pages are written back and the pool shrinks.
+  EXPECT_TRUE(bpm->Resize(buffer_pool_size));
+  EXPECT_EQ(buffer_pool_size, bpm->GetPoolSize());
+  EXPECT_EQ(buffer_pool_size, bpm->GetStats().evictions_);
+  EXPECT_FALSE(bpm->Resize(0));
+  EXPECT_FALSE(bpm->Resize(4 * buffer_pool_size + 1));
+  for (page_id_t i = 0; i < static_cast<page_id_t>(2 * buffer_pool_size); ++i) {
+    auto *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page " + std::to_string(i), std::string(page->GetData()));
+    EXPECT_EQ(true, bpm->UnpinPage(i, false));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.fpm");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+// Check that fetches keep seeing the right pages while the pool is grown and shrunk under them.
+TEST(BufferPoolManagerInstanceTest, ConcurrentResizeTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 16;
+  const int num_pages = 64;
+  const int num_threads = 4;
+
+  for (auto replacer_type : {ReplacerType::LRU, ReplacerType::CLOCK}) {
+    auto *disk_manager = new DiskManager(db_name);
+    auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, nullptr, replacer_type);
+    for (int i = 0; i < num_pages; ++i) {
+      page_id_t page_id;
+      auto *page = bpm->NewPage(&page_id);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+      EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+    }
+
+    std::atomic<bool> done{false};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < num_threads; ++t) {
+      threads.emplace_back([&, t] {
+        for (int i = 0; !done; ++i) {
+          page_id_t page_id = (t * 13 + i * 7) % num_pages;
+          Page *page = bpm->FetchPage(page_id);
+          if (page == nullptr) {
+            continue;
+          }
+          page->RLatch();
+          EXPECT_EQ("page " + std::to_string(page_id), std::string(page->GetData()));
+          page->RUnlatch();
+          EXPECT_TRUE(bpm->UnpinPage(page_id, i % 3 == 0));
+        }
+      });
+    }
+    int shrinks = 0;
+    for (int round = 0; round < 200; ++round) {
+      EXPECT_TRUE(bpm->Resize(buffer_pool_size * 4));
+      if (bpm->Resize(buffer_pool_size)) {
+        shrinks++;
+      }
+    }
+    done = true;
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    EXPECT_GT(shrinks, 0);
+
+    disk_manager->ShutDown();
+    remove("test.db");
+    remove("test.fpm");
+    delete bpm;
+    delete disk_manager;
+  }
+}
+
+// NOLINTNEXTLINE
+// Check that the resident pages and their eviction order come back after a restart.
+TEST(BufferPoolManagerInstanceTest, WarmUpTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 8;
+  const int num_pages = 16;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  page_id_t page_id;
+  for (int i = 0; i < num_pages; ++i) {
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  // Pages 8 to 15 are resident. Touch them from the highest down, so that page 15 becomes the next victim.
+  for (page_id_t i = num_pages - 1; i >= static_cast<page_id_t>(buffer_pool_size); --i) {
+    ASSERT_NE(nullptr, bpm->FetchPage(i));
+    EXPECT_TRUE(bpm->UnpinPage(i, false));
+  }
+  std::vector<page_id_t> resident = bpm->GetResidentPages();
+  ASSERT_EQ(buffer_pool_size, resident.size());
+  EXPECT_EQ(num_pages - 1, resident.front());
+  EXPECT_EQ(static_cast<page_id_t>(buffer_pool_size), resident.back());
+  bpm->FlushAllPages();
+  bpm->DumpResidentSet();
+  delete bpm;
+  disk_manager->ShutDown();
+  delete disk_manager;
+
+  // Scenario: after a restart, the same pages are resident again and fetching them never misses.
+  disk_manager = new DiskManager(db_name);
+  bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  EXPECT_EQ(buffer_pool_size, bpm->LoadResidentSet());
+  EXPECT_EQ(resident, bpm->GetResidentPages());
+  for (page_id_t i : resident) {
+    auto *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page " + std::to_string(i), std::string(page->GetData()));
+    EXPECT_TRUE(bpm->UnpinPage(i, false));
+  }
+  EXPECT_EQ(0, bpm->GetStats().misses_);
+
+  // Scenario: a warm-up list from another db file is ignored.
+  delete bpm;
+  disk_manager->ShutDown();
+  delete disk_manager;
+  remove("test.db");
+  disk_manager = new DiskManager(db_name);
+  bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  EXPECT_EQ(0, bpm->LoadResidentSet());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.warm");
+  remove("test.fpm");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+// Check that the background flusher cleans the frames closest to eviction, so that misses do not write
+TEST(BufferPoolManagerInstanceTest, BackgroundFlusherTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const size_t clean_window = buffer_pool_size / 2;
+
+  // Only let the flusher run when a miss asks for it.
+  auto saved_interval = background_flush_interval;
+  background_flush_interval = std::chrono::hours(1);
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  bpm->StartBackgroundFlusher(0.5);
+
+  // Scenario: fill the pool with dirty, unpinned pages.
+  page_id_t page_id;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+  EXPECT_EQ(0, disk_manager->GetNumWrites());
+
+  // Scenario: the first miss has to write back page 0 itself, and wakes up the flusher, which writes back the pages
+  // that are next in line for eviction.
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  auto flusher_done = [&] {
+    for (size_t i = 0; i < buffer_pool_size; ++i) {
+      if (bpm->GetPages()[i].GetPinCount() != 0) {
+        return false;
+      }
+    }
+    return disk_manager->GetNumWrites() == static_cast<int>(1 + clean_window);
+  };
+  for (int i = 0; i < 1000 && !flusher_done(); ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  ASSERT_TRUE(flusher_done());
+
+  // Scenario: the next misses find clean victims and only have to read.
+  for (size_t i = 0; i < clean_window; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(static_cast<int>(1 + clean_window), disk_manager->GetNumWrites());
+
+  // Scenario: the evicted pages were persisted.
+  bpm->StopBackgroundFlusher();
+  for (page_id_t evicted = 0; evicted <= static_cast<page_id_t>(clean_window); ++evicted) {
+    auto *page = bpm->FetchPage(evicted);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page " + std::to_string(evicted), std::string(page->GetData()));
+    EXPECT_EQ(true, bpm->UnpinPage(evicted, false));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.fpm");
+
+  delete bpm;
+  delete disk_manager;
+  background_flush_interval = saved_interval;
+}
+
+// NOLINTNEXTLINE
+// Check that FlushAllPages writes only the dirty pages and leaves the pins as they were
+TEST(BufferPoolManagerInstanceTest, FlushAllPagesTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  page_id_t page_id;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+  bpm->FlushAllPages();
+  int writes = disk_manager->GetNumWrites();
+
+  // Scenario: three pages are changed again, one of which stays pinned. Only those three are written.
+  auto *pinned = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, pinned);
+  for (page_id_t i = 0; i < 3; ++i) {
+    auto *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", i);
+    EXPECT_EQ(true, bpm->UnpinPage(i, true));
+  }
+  bpm->FlushAllPages();
+  EXPECT_EQ(writes + 3, disk_manager->GetNumWrites());
+  EXPECT_EQ(1, pinned->GetPinCount());
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_EQ(0, bpm->GetPages()[i].GetPinCount());
+    EXPECT_FALSE(bpm->GetPages()[i].IsDirty());
+  }
+
+  // Scenario: nothing is dirty anymore, so nothing is written.
+  bpm->FlushAllPages();
+  EXPECT_EQ(writes + 3, disk_manager->GetNumWrites());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.fpm");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+/** A disk manager whose asynchronous writes land on disk only after a delay. */
+class SlowWriteDiskManager : public DiskManager {
+ public:
+  explicit SlowWriteDiskManager(const std::string &db_file) : DiskManager(db_file) {}
+
+  auto WritePageAsync(page_id_t page_id, const char *page_data) -> std::future<void> override {
+    auto image = std::make_shared<std::string>(page_data, PAGE_SIZE);
+    {
+      std::scoped_lock lock(mutex_);
+      async_writes_.push_back(page_id);
+    }
+    return std::async(std::launch::async, [this, page_id, image] {
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+      WritePage(page_id, image->data());
+    });
+  }
+
+  auto AsyncWrites() -> std::vector<page_id_t> {
+    std::scoped_lock lock(mutex_);
+    return async_writes_;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::vector<page_id_t> async_writes_;
+};
+
+// NOLINTNEXTLINE
+// Check that an older image the background flusher is still writing does not overwrite a newer flush of the page
+TEST(BufferPoolManagerInstanceTest, BackgroundFlusherOrderTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const size_t clean_window = buffer_pool_size / 2;
+
+  auto saved_interval = background_flush_interval;
+  background_flush_interval = std::chrono::hours(1);
+
+  auto *disk_manager = new SlowWriteDiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  bpm->StartBackgroundFlusher(0.5);
+
+  page_id_t page_id;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "old %d", page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+
+  // Scenario: a miss wakes up the flusher, which starts writing the old images of the pages next in line for eviction.
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+  EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  for (int i = 0; i < 1000 && disk_manager->AsyncWrites().size() < clean_window; ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  auto flushed = disk_manager->AsyncWrites();
+  ASSERT_EQ(clean_window, flushed.size());
+
+  // Scenario: while those writes are in flight, two of the pages are changed and flushed, one by FlushPage and one by
+  // FlushAllPages. Both flushes have to wait for the old images, instead of being overwritten by them.
+  for (size_t i = 0; i < 2; ++i) {
+    auto *page = bpm->FetchPage(flushed[i]);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "new %d", flushed[i]);
+    EXPECT_EQ(true, bpm->UnpinPage(flushed[i], true));
+    if (i == 0) {
+      EXPECT_EQ(true, bpm->FlushPage(flushed[i]));
+    } else {
+      bpm->FlushAllPages();
+    }
+  }
+  bpm->StopBackgroundFlusher();
+
+  char data[PAGE_SIZE];
+  for (size_t i = 0; i < 2; ++i) {
+    disk_manager->ReadPage(flushed[i], data);
+    EXPECT_EQ("new " + std::to_string(flushed[i]), std::string(data));
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.fpm");
+
+  delete bpm;
+  delete disk_manager;
+  background_flush_interval = saved_interval;
+}
+
+// NOLINTNEXTLINE
+// Check that bulk operations with an access strategy stay within their ring and leave the working set alone
+TEST(BufferPoolManagerInstanceTest, BufferAccessStrategyTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 16;
+  const page_id_t hot_pages = 8;
+  const page_id_t num_pages = 48;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  page_id_t page_id;
+  for (page_id_t i = 0; i < num_pages; ++i) {
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+  auto touch_hot_pages = [&] {
+    for (page_id = 0; page_id < hot_pages; ++page_id) {
+      ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+      EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+    }
+  };
+  auto count_resident_hot_pages = [&] {
+    page_id_t resident = 0;
+    for (size_t i = 0; i < buffer_pool_size; ++i) {
+      resident += bpm->GetPages()[i].GetPageId() < hot_pages ? 1 : 0;
+    }
+    return resident;
+  };
+  touch_hot_pages();
+  ASSERT_EQ(hot_pages, count_resident_hot_pages());
+
+  // Scenario: a bulk read of the other pages recycles the frames of its ring, and the working set survives.
+  BufferAccessStrategy bulk_read(BufferAccessType::BULK_READ, BULK_READ_RING_SIZE);
+  for (page_id = hot_pages; page_id < num_pages; ++page_id) {
+    auto *page = bpm->FetchPageWithStrategy(page_id, &bulk_read);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page " + std::to_string(page_id), std::string(page->GetData()));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(hot_pages, count_resident_hot_pages());
+
+  // Scenario: so does a bulk write, which writes back the pages it evicts from its ring.
+  touch_hot_pages();
+  BufferAccessStrategy bulk_write(BufferAccessType::BULK_WRITE, BULK_WRITE_RING_SIZE);
+  std::vector<page_id_t> written;
+  for (size_t i = 0; i < 2 * buffer_pool_size; ++i) {
+    auto *page = bpm->NewPageWithStrategy(&page_id, &bulk_write);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+    written.push_back(page_id);
+  }
+  EXPECT_EQ(hot_pages, count_resident_hot_pages());
+  for (page_id_t id : written) {
+    auto *page = bpm->FetchPage(id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page " + std::to_string(id), std::string(page->GetData()));
+    EXPECT_EQ(true, bpm->UnpinPage(id, false));
+  }
+
+  // Scenario: the same scan through the shared pool wipes out the working set.
+  touch_hot_pages();
+  for (page_id = hot_pages; page_id < num_pages; ++page_id) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(0, count_resident_hot_pages());
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.fpm");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+// Measures the cost of a FetchPage/UnpinPage pair on a page that is already resident, as threads are added.
+// A benchmark, not a check: run it with --gtest_also_run_disabled_tests.
+TEST(BufferPoolManagerInstanceTest, DISABLED_HitPathBenchmark) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 64;
+  const int total_fetches = 1 << 18;
+
+  for (auto replacer_type : {ReplacerType::LRU, ReplacerType::CLOCK}) {
+    auto *disk_manager = new DiskManager(db_name);
+    auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager, nullptr, replacer_type);
+    for (size_t i = 0; i < buffer_pool_size; ++i) {
+      page_id_t page_id;
+      ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+      EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+    }
+
+    for (int num_threads : {1, 4, 16, 64}) {
+      auto start = std::chrono::steady_clock::now();
+      std::vector<std::thread> threads;
+      for (int t = 0; t < num_threads; ++t) {
+        threads.emplace_back([&, t] {
+          for (int i = 0; i < total_fetches / num_threads; ++i) {
+            page_id_t page_id = (t + i) % buffer_pool_size;
+            Page *page = bpm->FetchPage(page_id);
+            ASSERT_NE(nullptr, page);
+            ASSERT_EQ(page_id, page->GetPageId());
+            bpm->UnpinPage(page_id, false);
+          }
+        });
+      }
+      for (auto &thread : threads) {
+        thread.join();
+      }
+      auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+      std::cout << (replacer_type == ReplacerType::LRU ? "LRU  " : "CLOCK") << " threads=" << num_threads
+                << " ns/fetch=" << elapsed.count() / total_fetches << std::endl;
+    }
+
+    // Every pin was dropped again, so every page can still be deleted.
+    for (size_t i = 0; i < buffer_pool_size; ++i) {
+      EXPECT_TRUE(bpm->DeletePage(i));
+    }
+
+    disk_manager->ShutDown();
+    remove("test.db");
+    remove("test.fpm");
+    delete bpm;
+    delete disk_manager;
+  }
+}
+
+// NOLINTNEXTLINE
+// Compares buffered and direct I/O on a table four times the size of the pool: full scans, and random point lookups.
+// Buffered I/O is served from the kernel page cache, which holds the whole table here; direct I/O pays for every miss.
+// A benchmark, not a check: run it with --gtest_also_run_disabled_tests.
+TEST(BufferPoolManagerInstanceTest, DISABLED_DirectIoBenchmark) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 256;
+  const int num_pages = 4 * buffer_pool_size;
+  const int num_lookups = 1 << 14;
+
+  for (bool direct_io : {false, true}) {
+    auto *disk_manager = new DiskManager(db_name, direct_io);
+    auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+    for (int i = 0; i < num_pages; ++i) {
+      page_id_t page_id;
+      Page *page = bpm->NewPage(&page_id);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+      EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+    }
+    bpm->FlushAllPages();
+
+    auto fetch = [&](page_id_t page_id) {
+      Page *page = bpm->FetchPage(page_id);
+      ASSERT_NE(nullptr, page);
+      ASSERT_EQ(0, strcmp(page->GetData(), ("page " + std::to_string(page_id)).c_str()));
+      bpm->UnpinPage(page_id, false);
+    };
+    auto start = std::chrono::steady_clock::now();
+    for (int round = 0; round < 4; ++round) {
+      for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+        fetch(page_id);
+      }
+    }
+    auto scan = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+
+    std::mt19937 gen(15445);
+    std::uniform_int_distribution<page_id_t> page_dist(0, num_pages - 1);
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_lookups; ++i) {
+      fetch(page_dist(gen));
+    }
+    auto lookups = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+
+    std::cout << (disk_manager->IsDirectIo() ? "direct  " : "buffered") << " scan ns/page="
+              << scan.count() / (4 * num_pages) << " lookup ns/page=" << lookups.count() / num_lookups << std::endl;
+
+    disk_manager->ShutDown();
+    remove("test.db");
+    remove("test.fpm");
+    delete bpm;
+    delete disk_manager;
+  }
+}
+
+// NOLINTNEXTLINE
+// Check that frame hints are used while they are right, and that wrong or stale ones still get the right page.
+TEST(BufferPoolManagerInstanceTest, FetchPageWithHintTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  page_id_t page_id;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+
+  // Scenario: without a hint, the page is looked up and its frame is reported.
+  frame_id_t frame_id = -1;
+  auto *page = bpm->FetchPageWithHint(2, &frame_id);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(2, page->GetPageId());
+  ASSERT_NE(-1, frame_id);
+  EXPECT_EQ(&bpm->GetPages()[frame_id], page);
+  EXPECT_EQ(true, bpm->UnpinPage(2, false));
+
+  // Scenario: the right hint pins the same frame again.
+  frame_id_t hint = frame_id;
+  EXPECT_EQ(page, bpm->FetchPageWithHint(2, &hint));
+  EXPECT_EQ(frame_id, hint);
+  EXPECT_EQ(1, page->GetPinCount());
+  EXPECT_EQ(true, bpm->UnpinPage(2, false));
+
+  // Scenario: a hint pointing at another page's frame, or at no frame at all, is corrected.
+  for (frame_id_t wrong_hint : {(frame_id + 1) % static_cast<frame_id_t>(buffer_pool_size), 1000}) {
+    hint = wrong_hint;
+    EXPECT_EQ(page, bpm->FetchPageWithHint(2, &hint));
+    EXPECT_EQ(frame_id, hint);
+    EXPECT_EQ(true, bpm->UnpinPage(2, false));
+  }
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_EQ(0, bpm->GetPages()[i].GetPinCount());
+  }
+
+  // Scenario: once the page has been evicted and its frame reused, the old hint finds it wherever it is read back.
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  hint = frame_id;
+  page = bpm->FetchPageWithHint(2, &hint);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ("page 2", std::string(page->GetData()));
+  EXPECT_EQ(&bpm->GetPages()[hint], page);
+  EXPECT_EQ(true, bpm->UnpinPage(2, false));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.fpm");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// Frames are only cleared when a new page lands in a frame that held data before.
+TEST(BufferPoolManagerInstanceTest, NewPageZeroedTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 2;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  auto is_zeroed = [](Page *page) {
+    return std::all_of(page->GetData(), page->GetData() + PAGE_SIZE, [](char c) { return c == 0; });
+  };
+
+  // Scenario: frames that were never used start out zeroed.
+  page_id_t page_id;
+  auto *page = bpm->NewPage(&page_id);
+  ASSERT_NE(nullptr, page);
+  EXPECT_TRUE(is_zeroed(page));
+
+  // Scenario: a frame freed by DeletePage is cleared when a new page takes it.
+  memset(page->GetData(), 'x', PAGE_SIZE);
+  EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  EXPECT_EQ(true, bpm->DeletePage(page_id));
+  page = bpm->NewPage(&page_id);
+  ASSERT_NE(nullptr, page);
+  EXPECT_TRUE(is_zeroed(page));
+
+  // Scenario: a frame whose dirty page had to be written back is cleared too.
+  memset(page->GetData(), 'y', PAGE_SIZE);
+  page_id_t dirty_page_id = page_id;
+  EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_TRUE(is_zeroed(page));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+
+  // Scenario: the written-back page reads back intact.
+  page = bpm->FetchPage(dirty_page_id);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(std::string(PAGE_SIZE, 'y'), std::string(page->GetData(), PAGE_SIZE));
+  EXPECT_EQ(true, bpm->UnpinPage(dirty_page_id, false));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.fpm");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+TEST(BufferPoolManagerInstanceTest, BatchFetchUnpinTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  page_id_t page_id;
+  for (size_t i = 0; i < 2 * buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+
+  // Scenario: a batch mixing resident pages, pages on disk and repeated pages pins each appearance once.
+  std::vector<page_id_t> page_ids = {6, 1, 6, 7, 2};
+  std::vector<Page *> pages = bpm->FetchPages(page_ids);
+  ASSERT_EQ(page_ids.size(), pages.size());
+  for (size_t i = 0; i < page_ids.size(); ++i) {
+    ASSERT_NE(nullptr, pages[i]);
+    EXPECT_EQ(page_ids[i], pages[i]->GetPageId());
+    EXPECT_EQ("page " + std::to_string(page_ids[i]), std::string(pages[i]->GetData()));
+  }
+  EXPECT_EQ(pages[0], pages[2]);
+  EXPECT_EQ(2, pages[0]->GetPinCount());
+
+  // Scenario: pages that no frame can be found for come back as nullptr, and the others are still fetched.
+  std::vector<Page *> more = bpm->FetchPages({3, 7});
+  EXPECT_EQ(nullptr, more[0]);
+  ASSERT_NE(nullptr, more[1]);
+  EXPECT_EQ(2, more[1]->GetPinCount());
+
+  // Scenario: a batch unpin drops one pin per appearance, after which the frames can be reused.
+  bpm->UnpinPages({7, 6, 7, 1, 6, 2}, false);
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_EQ(0, bpm->GetPages()[i].GetPinCount());
+  }
+  pages = bpm->FetchPages({0, 3, 4, 5});
+  for (auto *page : pages) {
+    ASSERT_NE(nullptr, page);
+  }
+  bpm->UnpinPages({0, 3, 4, 5}, false);
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.fpm");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// Pages the pool evicted clean come back from the compressed tier, and pages evicted dirty from disk.
+TEST(BufferPoolManagerInstanceTest, CompressedTierTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+  const int num_pages = 16;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+  bpm->EnableCompressedTier(num_pages * PAGE_SIZE / 4);
+
+  page_id_t page_id;
+  for (int i = 0; i < num_pages; ++i) {
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+  // Scenario: the first pass writes the dirty pages back, so nothing has reached the tier yet.
+  for (int i = 0; i < num_pages; ++i) {
+    auto *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page " + std::to_string(i), std::string(page->GetData()));
+    EXPECT_EQ(true, bpm->UnpinPage(i, false));
+  }
+  auto stats = bpm->GetStats();
+  EXPECT_EQ(0, stats.tier_hits_);
+  EXPECT_GT(stats.tier_pages_, 0);
+  EXPECT_GT(stats.TierCompressionRatio(), 10);
+
+  // Scenario: from then on, the pages are evicted clean and every miss is served by the tier.
+  for (int round = 0; round < 3; ++round) {
+    for (int i = 0; i < num_pages; ++i) {
+      auto *page = bpm->FetchPage(i);
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ("page " + std::to_string(i), std::string(page->GetData()));
+      EXPECT_EQ(true, bpm->UnpinPage(i, false));
+    }
+  }
+  auto after = bpm->GetStats();
+  EXPECT_EQ(after.misses_ - stats.misses_, after.tier_hits_);
+  EXPECT_EQ(stats.tier_misses_, after.tier_misses_);
+
+  // Scenario: a page changed in the pool is not served from the stale copy after it was evicted dirty.
+  auto *page = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page);
+  snprintf(page->GetData(), PAGE_SIZE, "changed");
+  EXPECT_EQ(true, bpm->UnpinPage(0, true));
+  for (int i = 1; i <= static_cast<int>(buffer_pool_size); ++i) {
+    ASSERT_NE(nullptr, bpm->FetchPage(i));
+    EXPECT_EQ(true, bpm->UnpinPage(i, false));
+  }
+  page = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ("changed", std::string(page->GetData()));
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.fpm");
 
   delete bpm;
   delete disk_manager;
@@ -19,7 +19,7 @@
 
 namespace bustub {
 
-TEST(ClockReplacerTest, DISABLED_SampleTest) {
+TEST(ClockReplacerTest, SampleTest) {
   ClockReplacer clock_replacer(7);
 
   // Scenario: unpin six elements, i.e. add them to the replacer.
@@ -59,4 +59,48 @@ TEST(ClockReplacerTest, DISABLED_SampleTest) {
   EXPECT_EQ(4, value);
 }
 
+TEST(ClockReplacerTest, ConcurrentPinUnpinTest) {
+  const size_t num_frames = 64;
+  const int num_threads = 4;
+  const int rounds = 10000;
+  ClockReplacer clock_replacer(num_frames);
+
+  // Scenario: each thread owns a disjoint set of frames and keeps pinning and unpinning them while another thread
+  // keeps sweeping and putting its victims straight back.
+  std::atomic<bool> done{false};
+  std::thread sweeper([&] {
+    while (!done) {
+      int frame;
+      if (clock_replacer.Victim(&frame)) {
+        clock_replacer.Unpin(frame);
+      }
+    }
+  });
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&, t] {
+      for (int i = 0; i < rounds; ++i) {
+        int frame = t + num_threads * (i % (num_frames / num_threads));
+        clock_replacer.Pin(frame);
+        clock_replacer.Unpin(frame);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  done = true;
+  sweeper.join();
+
+  // Scenario: every frame was last unpinned, and the lock-free size counter agrees with the evictable flags.
+  EXPECT_EQ(num_frames, clock_replacer.Size());
+  std::vector<bool> seen(num_frames, false);
+  int frame;
+  while (clock_replacer.Victim(&frame)) {
+    EXPECT_FALSE(seen[frame]);
+    seen[frame] = true;
+  }
+  EXPECT_EQ(0, clock_replacer.Size());
+}
+
 }  // namespace bustub
@@ -0,0 +1,133 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compressed_page_cache_test.cpp
+//
+// Identification: test/buffer/compressed_page_cache_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/compressed_page_cache.h"
+
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "common/util/lz_codec.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// Compress and decompress inputs that exercise literal runs, long matches, overlapping runs and incompressible data.
+// NOLINTNEXTLINE
+TEST(CompressedPageCacheTest, CodecTest) {
+  std::mt19937 gen(15445);
+  std::vector<std::string> inputs;
+  inputs.emplace_back();
+  inputs.emplace_back("abc");
+  inputs.emplace_back(PAGE_SIZE, '\0');
+  std::string random(PAGE_SIZE, '\0');
+  for (auto &c : random) {
+    c = static_cast<char>(gen());
+  }
+  inputs.push_back(random);
+  std::string text;
+  while (text.size() < static_cast<size_t>(PAGE_SIZE)) {
+    text += "tuple " + std::to_string(text.size() % 97) + " of table heap page; ";
+  }
+  text.resize(PAGE_SIZE);
+  inputs.push_back(text);
+  // A page with a small header and slotted tuples at the end, like a table page.
+  std::string slotted(PAGE_SIZE, '\0');
+  memcpy(slotted.data(), random.data(), 64);
+  memcpy(slotted.data() + PAGE_SIZE - 1000, text.data(), 1000);
+  inputs.push_back(slotted);
+
+  for (const auto &input : inputs) {
+    std::vector<char> compressed(LZCodec::MaxCompressedSize(input.size()));
+    size_t size = LZCodec::Compress(input.data(), input.size(), compressed.data());
+    ASSERT_LE(size, compressed.size());
+    std::string output(input.size(), 'x');
+    ASSERT_TRUE(LZCodec::Decompress(compressed.data(), size, output.data(), output.size()));
+    EXPECT_EQ(input, output);
+    // An input that decompresses to the wrong size is rejected.
+    std::string longer(input.size() + 1, 'x');
+    EXPECT_FALSE(LZCodec::Decompress(compressed.data(), size, longer.data(), longer.size()));
+  }
+
+  // Scenario: zeroed and repetitive pages shrink a lot, random ones barely grow.
+  std::vector<char> compressed(LZCodec::MaxCompressedSize(PAGE_SIZE));
+  EXPECT_LT(LZCodec::Compress(inputs[2].data(), PAGE_SIZE, compressed.data()), 64);
+  EXPECT_LT(LZCodec::Compress(text.data(), PAGE_SIZE, compressed.data()), PAGE_SIZE / 4);
+  EXPECT_LT(LZCodec::Compress(slotted.data(), PAGE_SIZE, compressed.data()), PAGE_SIZE / 2);
+  EXPECT_LE(LZCodec::Compress(random.data(), PAGE_SIZE, compressed.data()), LZCodec::MaxCompressedSize(PAGE_SIZE));
+}
+
+// NOLINTNEXTLINE
+TEST(CompressedPageCacheTest, SampleTest) {
+  std::string page(PAGE_SIZE, '\0');
+  auto make_page = [&](int i) {
+    std::fill(page.begin(), page.end(), '\0');
+    snprintf(page.data(), PAGE_SIZE, "page %d", i);
+    return page;
+  };
+  std::string out(PAGE_SIZE, 'x');
+
+  // Scenario: a page comes back intact, once; it leaves the cache when it is taken.
+  CompressedPageCache cache(1024);
+  cache.Insert(1, make_page(1).data());
+  ASSERT_TRUE(cache.Take(1, out.data()));
+  EXPECT_EQ(make_page(1), out);
+  EXPECT_FALSE(cache.Take(1, out.data()));
+
+  // Scenario: inserting again replaces the old copy, and erased pages are gone.
+  cache.Insert(2, make_page(2).data());
+  cache.Insert(2, make_page(22).data());
+  cache.Insert(3, make_page(3).data());
+  cache.Erase(3);
+  EXPECT_FALSE(cache.Take(3, out.data()));
+  ASSERT_TRUE(cache.Take(2, out.data()));
+  EXPECT_EQ(make_page(22), out);
+
+  // Scenario: past the capacity, the oldest pages are dropped, and pages that do not compress are not kept at all.
+  for (int i = 0; i < 1000; ++i) {
+    cache.Insert(i, make_page(i).data());
+  }
+  BufferPoolStats stats;
+  cache.CollectStats(&stats);
+  EXPECT_LE(stats.tier_bytes_, 1024);
+  EXPECT_GT(stats.tier_pages_, 10);
+  EXPECT_LT(stats.tier_pages_, 1000);
+  EXPECT_GT(stats.TierCompressionRatio(), 100);
+  EXPECT_TRUE(cache.Take(999, out.data()));
+  EXPECT_FALSE(cache.Take(0, out.data()));
+
+  std::mt19937 gen(15445);
+  for (auto &c : page) {
+    c = static_cast<char>(gen());
+  }
+  CompressedPageCache big_cache(1 << 20);
+  big_cache.Insert(7, page.data());
+  EXPECT_FALSE(big_cache.Take(7, out.data()));
+
+  stats = BufferPoolStats();
+  cache.CollectStats(&stats);
+  EXPECT_EQ(3, stats.tier_hits_);
+  EXPECT_EQ(3, stats.tier_misses_);
+
+  // Scenario: erasing a tablespace drops its pages and no others.
+  const page_id_t other_page_id = (1 << TABLESPACE_PAGE_BITS) + 5;
+  CompressedPageCache tier(1 << 20);
+  tier.Insert(5, make_page(5).data());
+  tier.Insert(other_page_id, make_page(6).data());
+  tier.EraseTablespace(1);
+  EXPECT_FALSE(tier.Take(other_page_id, out.data()));
+  ASSERT_TRUE(tier.Take(5, out.data()));
+  EXPECT_EQ(make_page(5), out);
+}
+
+}  // namespace bustub
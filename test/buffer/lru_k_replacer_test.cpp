@@ -0,0 +1,155 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer_test.cpp
+//
+// Identification: test/buffer/lru_k_replacer_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/lru_k_replacer.h"
+#include "buffer/lru_replacer.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(LRUKReplacerTest, SampleTest) {
+  LRUKReplacer lru_replacer(7, 2);
+
+  // Scenario: add six frames. Frame 1 is accessed twice, all the others once.
+  for (frame_id_t i = 1; i <= 6; ++i) {
+    lru_replacer.Pin(i);
+  }
+  lru_replacer.Pin(1);
+  for (frame_id_t i = 1; i <= 6; ++i) {
+    lru_replacer.Unpin(i);
+  }
+  EXPECT_EQ(6, lru_replacer.Size());
+
+  // Scenario: frames with fewer than k accesses go first, in order of their first access. Frame 1 has a finite
+  // backward k-distance, so it is evicted last even though it was unpinned first.
+  int value;
+  lru_replacer.Victim(&value);
+  EXPECT_EQ(2, value);
+  lru_replacer.Victim(&value);
+  EXPECT_EQ(3, value);
+  lru_replacer.Victim(&value);
+  EXPECT_EQ(4, value);
+  EXPECT_EQ(3, lru_replacer.Size());
+
+  // Scenario: pinning a frame removes it from the replacer and counts as an access.
+  lru_replacer.Pin(5);
+  EXPECT_EQ(2, lru_replacer.Size());
+  lru_replacer.Unpin(5);
+
+  // Scenario: 5 and 1 both have two accesses now; 1's second most recent access is older.
+  lru_replacer.Victim(&value);
+  EXPECT_EQ(6, value);
+  lru_replacer.Victim(&value);
+  EXPECT_EQ(1, value);
+  lru_replacer.Victim(&value);
+  EXPECT_EQ(5, value);
+  EXPECT_FALSE(lru_replacer.Victim(&value));
+}
+
+TEST(LRUKReplacerTest, EvictedHistoryTest) {
+  LRUKReplacer lru_replacer(3, 2);
+
+  // Scenario: page 10 is accessed once in frame 0 and evicted.
+  lru_replacer.SetPageId(0, 10);
+  lru_replacer.Pin(0);
+  lru_replacer.Unpin(0);
+  int value;
+  ASSERT_TRUE(lru_replacer.Victim(&value));
+  EXPECT_EQ(0, value);
+
+  // Scenario: page 20 is loaded into frame 1, then page 10 comes back into frame 2. Page 10's earlier access is
+  // remembered, so it now has two accesses and outlives page 20, which only has one.
+  lru_replacer.SetPageId(1, 20);
+  lru_replacer.Pin(1);
+  lru_replacer.Unpin(1);
+  lru_replacer.SetPageId(2, 10);
+  lru_replacer.Pin(2);
+  lru_replacer.Unpin(2);
+  lru_replacer.Victim(&value);
+  EXPECT_EQ(1, value);
+  lru_replacer.Victim(&value);
+  EXPECT_EQ(2, value);
+}
+
+/** Replays a page trace against a replacer the way the buffer pool drives it and returns the number of hits. */
+static auto ReplayTrace(Replacer *replacer, size_t num_frames, const std::vector<page_id_t> &trace) -> size_t {
+  std::unordered_map<page_id_t, frame_id_t> page_table;
+  std::vector<page_id_t> frame_pages(num_frames, INVALID_PAGE_ID);
+  std::list<frame_id_t> free_list;
+  for (size_t i = 0; i < num_frames; ++i) {
+    free_list.push_back(static_cast<frame_id_t>(i));
+  }
+
+  size_t hits = 0;
+  for (page_id_t page_id : trace) {
+    auto it = page_table.find(page_id);
+    frame_id_t frame_id;
+    if (it != page_table.end()) {
+      hits++;
+      frame_id = it->second;
+    } else {
+      if (!free_list.empty()) {
+        frame_id = free_list.front();
+        free_list.pop_front();
+      } else {
+        EXPECT_TRUE(replacer->Victim(&frame_id));
+        page_table.erase(frame_pages[frame_id]);
+      }
+      page_table[page_id] = frame_id;
+      frame_pages[frame_id] = page_id;
+      replacer->SetPageId(frame_id, page_id);
+    }
+    replacer->Pin(frame_id);
+    replacer->Unpin(frame_id);
+  }
+  return hits;
+}
+
+TEST(LRUKReplacerTest, ScanResistanceTest) {
+  const size_t num_frames = 32;
+  const page_id_t hot_pages = 16;
+  const page_id_t scan_pages = 200;
+
+  // Scenario: point lookups warm up a small hot set (think index internal pages). Then the lookups continue,
+  // interleaved with repeated full scans of a table that is much larger than the pool.
+  std::vector<page_id_t> trace;
+  for (int round = 0; round < 2; ++round) {
+    for (page_id_t i = 0; i < hot_pages; ++i) {
+      trace.push_back(i);
+    }
+  }
+  for (int round = 0; round < 10; ++round) {
+    for (page_id_t i = 0; i < scan_pages; ++i) {
+      trace.push_back(1000 + i);
+      if (i % 4 == 0) {
+        trace.push_back((i / 4 + round) % hot_pages);
+      }
+    }
+  }
+
+  LRUReplacer lru(num_frames);
+  LRUKReplacer lru_k(num_frames, 2);
+  size_t lru_hits = ReplayTrace(&lru, num_frames, trace);
+  size_t lru_k_hits = ReplayTrace(&lru_k, num_frames, trace);
+  std::cout << "trace=" << trace.size() << " lru_hits=" << lru_hits << " lru_k_hits=" << lru_k_hits << std::endl;
+
+  // The scan flushes the hot set out of a plain LRU pool, but not out of an LRU-K pool.
+  EXPECT_GT(lru_k_hits, lru_hits);
+  EXPECT_GE(lru_k_hits, static_cast<size_t>(hot_pages + 10 * scan_pages / 4));
+}
+
+}  // namespace bustub
@@ -59,4 +59,26 @@ TEST(LRUReplacerTest, SampleTest) {
   EXPECT_EQ(4, value);
 }
 
+TEST(LRUReplacerTest, PreferredVictimTest) {
+  LRUReplacer lru_replacer(7);
+  for (frame_id_t f = 1; f <= 6; ++f) {
+    lru_replacer.Unpin(f);
+  }
+  EXPECT_EQ((std::vector<frame_id_t>{1, 2, 3}), lru_replacer.Candidates(3));
+
+  // Scenario: prefer even frames. The first preferred frame within the window is taken, out of LRU order.
+  auto is_even = [](frame_id_t f) { return f % 2 == 0; };
+  int value;
+  ASSERT_TRUE(lru_replacer.VictimPreferring(&value, is_even, 3));
+  EXPECT_EQ(2, value);
+  ASSERT_TRUE(lru_replacer.VictimPreferring(&value, is_even, 3));
+  EXPECT_EQ(4, value);
+
+  // Scenario: nothing preferred within the window, so the least recently used frame goes.
+  ASSERT_TRUE(lru_replacer.VictimPreferring(&value, is_even, 2));
+  EXPECT_EQ(1, value);
+  EXPECT_EQ((std::vector<frame_id_t>{3, 5, 6}), lru_replacer.Candidates(10));
+  EXPECT_EQ(3, lru_replacer.Size());
+}
+
 }  // namespace bustub
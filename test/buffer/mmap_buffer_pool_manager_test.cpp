@@ -0,0 +1,138 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// mmap_buffer_pool_manager_test.cpp
+//
+// Identification: test/buffer/mmap_buffer_pool_manager_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/mmap_buffer_pool_manager.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "common/exception.h"
+#include "concurrency/lock_manager.h"
+#include "concurrency/transaction.h"
+#include "gtest/gtest.h"
+#include "storage/table/table_heap.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(MmapBufferPoolManagerTest, SampleTest) {
+  const std::string db_name = "test.db";
+  const int num_pages = 30;
+
+  // Write the pages through a buffer pool much smaller than the file.
+  {
+    DiskManager disk_manager(db_name);
+    BufferPoolManagerInstance bpm(10, &disk_manager);
+    for (int i = 0; i < num_pages; ++i) {
+      page_id_t page_id;
+      Page *page = bpm.NewPage(&page_id);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+      bpm.UnpinPage(page_id, true);
+    }
+    bpm.FlushAllPages();
+    disk_manager.ShutDown();
+  }
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new MmapBufferPoolManager(disk_manager);
+  EXPECT_EQ(num_pages, bpm->GetPoolSize());
+
+  // Scenario: every page can be fetched at once, and its data is the file's, in place.
+  std::vector<Page *> pages;
+  for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+    Page *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(page_id, page->GetPageId());
+    EXPECT_EQ("page " + std::to_string(page_id), page->GetData());
+    pages.push_back(page);
+  }
+  for (page_id_t page_id = 1; page_id < num_pages; ++page_id) {
+    EXPECT_EQ(pages[0]->GetData() + page_id * PAGE_SIZE, pages[page_id]->GetData());
+  }
+  EXPECT_EQ(pages[3], bpm->FetchPage(3));
+  EXPECT_EQ(nullptr, bpm->FetchPage(num_pages));
+  EXPECT_EQ(nullptr, bpm->FetchPage(INVALID_PAGE_ID));
+  bpm->PrefetchPages({7, 5, 6, 20, num_pages + 3});
+
+  // Scenario: reading and latching work as usual.
+  pages[5]->RLatch();
+  EXPECT_TRUE(bpm->UnpinPage(5, false));
+  pages[5]->RUnlatch();
+  EXPECT_TRUE(bpm->FlushPage(5));
+  EXPECT_FALSE(bpm->UnpinPage(num_pages, false));
+  bpm->FlushAllPages();
+
+  // Scenario: anything that would write is rejected.
+  page_id_t page_id;
+  EXPECT_THROW(bpm->NewPage(&page_id), Exception);
+  EXPECT_THROW(bpm->DeletePage(5), Exception);
+  EXPECT_THROW(bpm->UnpinPage(5, true), Exception);
+
+  delete bpm;
+  disk_manager->ShutDown();
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+  remove("test.fpm");
+}
+
+// NOLINTNEXTLINE
+TEST(MmapBufferPoolManagerTest, TableScanTest) {
+  const std::string db_name = "test.db";
+  const int num_tuples = 2000;
+  Schema schema({Column{"a", TypeId::INTEGER}, Column{"b", TypeId::VARCHAR, 32}});
+  auto make_tuple = [&](int i) {
+    return Tuple({Value(TypeId::INTEGER, i), Value(TypeId::VARCHAR, "row " + std::to_string(i))}, &schema);
+  };
+
+  LockManager lock_manager;
+  page_id_t first_page_id;
+  {
+    DiskManager disk_manager(db_name);
+    BufferPoolManagerInstance bpm(16, &disk_manager);
+    Transaction txn(0);
+    TableHeap table(&bpm, &lock_manager, nullptr, &txn);
+    for (int i = 0; i < num_tuples; ++i) {
+      RID rid;
+      ASSERT_TRUE(table.InsertTuple(make_tuple(i), &rid, &txn));
+    }
+    first_page_id = table.GetFirstPageId();
+    bpm.FlushAllPages();
+    disk_manager.ShutDown();
+  }
+
+  // Scenario: a replica scans the table straight out of the mapping.
+  DiskManager disk_manager(db_name);
+  MmapBufferPoolManager bpm(&disk_manager);
+  Transaction txn(1);
+  TableHeap table(&bpm, &lock_manager, nullptr, first_page_id);
+  int i = 0;
+  for (auto it = table.Begin(&txn); it != table.End(); ++it, ++i) {
+    EXPECT_EQ(i, it->GetValue(&schema, 0).GetAs<int32_t>());
+    EXPECT_EQ("row " + std::to_string(i), it->GetValue(&schema, 1).ToString());
+  }
+  EXPECT_EQ(num_tuples, i);
+
+  // Scenario: but cannot change it.
+  RID rid;
+  EXPECT_THROW(table.InsertTuple(make_tuple(num_tuples), &rid, &txn), Exception);
+
+  disk_manager.ShutDown();
+  remove("test.db");
+  remove("test.log");
+  remove("test.fpm");
+}
+
+}  // namespace bustub
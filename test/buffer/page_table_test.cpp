@@ -0,0 +1,83 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table_test.cpp
+//
+// Identification: test/buffer/page_table_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <random>
+#include <unordered_map>
+
+#include "buffer/page_table.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(PageTableTest, SampleTest) {
+  PageTable page_table(4);
+  frame_id_t frame_id;
+
+  // Scenario: map a few pages and look them up.
+  page_table.Insert(1, 0);
+  page_table.Insert(9, 1);
+  page_table.Insert(17, 2);
+  EXPECT_TRUE(page_table.Find(1, &frame_id));
+  EXPECT_EQ(0, frame_id);
+  EXPECT_TRUE(page_table.Find(17, &frame_id));
+  EXPECT_EQ(2, frame_id);
+  EXPECT_FALSE(page_table.Find(2, &frame_id));
+
+  // Scenario: remapping a page replaces its entry.
+  page_table.Insert(9, 3);
+  EXPECT_TRUE(page_table.Find(9, &frame_id));
+  EXPECT_EQ(3, frame_id);
+
+  // Scenario: removed pages are gone, the others stay reachable.
+  page_table.Remove(1);
+  page_table.Remove(5);
+  EXPECT_FALSE(page_table.Find(1, &frame_id));
+  EXPECT_TRUE(page_table.Find(9, &frame_id));
+  EXPECT_TRUE(page_table.Find(17, &frame_id));
+}
+
+// Check the table against std::unordered_map through a long random sequence of inserts and removes, which keeps
+// exercising the backward shift of colliding entries.
+TEST(PageTableTest, RandomTest) {
+  const size_t num_frames = 32;
+  PageTable page_table(num_frames);
+  std::unordered_map<page_id_t, frame_id_t> expected;
+  std::mt19937 gen(15445);
+  std::uniform_int_distribution<page_id_t> page_dist(0, 255);
+
+  for (int i = 0; i < 20000; ++i) {
+    page_id_t page_id = page_dist(gen);
+    if (expected.count(page_id) != 0) {
+      page_table.Remove(page_id);
+      expected.erase(page_id);
+    } else if (expected.size() < num_frames) {
+      page_table.Insert(page_id, i % num_frames);
+      expected[page_id] = i % num_frames;
+    }
+
+    frame_id_t frame_id;
+    for (page_id_t p = 0; p < 256; p += 17) {
+      auto it = expected.find(p);
+      ASSERT_EQ(it != expected.end(), page_table.Find(p, &frame_id));
+      if (it != expected.end()) {
+        ASSERT_EQ(it->second, frame_id);
+      }
+    }
+  }
+  for (const auto &[page_id, frame_id] : expected) {
+    frame_id_t found;
+    ASSERT_TRUE(page_table.Find(page_id, &found));
+    EXPECT_EQ(frame_id, found);
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,130 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// pin_cache_test.cpp
+//
+// Identification: test/buffer/pin_cache_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/pin_cache.h"
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+/** Counts the fetches and the unpin batches that reach the buffer pool. */
+class CountingBufferPoolManager : public BufferPoolManagerInstance {
+ public:
+  using BufferPoolManagerInstance::BufferPoolManagerInstance;
+
+  auto FetchPageWithStrategy(page_id_t page_id, BufferAccessStrategy *strategy) -> Page * override {
+    ++fetches_;
+    return BufferPoolManagerInstance::FetchPageWithStrategy(page_id, strategy);
+  }
+
+  void UnpinPages(const std::vector<page_id_t> &page_ids, bool is_dirty) override {
+    unpin_batches_.push_back(page_ids);
+    BufferPoolManagerInstance::UnpinPages(page_ids, is_dirty);
+  }
+
+  size_t fetches_{0};
+  std::vector<std::vector<page_id_t>> unpin_batches_;
+};
+
+// NOLINTNEXTLINE
+TEST(PinCacheTest, SampleTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new CountingBufferPoolManager(10, disk_manager);
+  page_id_t page_id;
+  for (int i = 0; i < 6; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    bpm->UnpinPage(page_id, true);
+  }
+
+  {
+    PinCache pin_cache(bpm, 4);
+
+    // Scenario: repeated fetches of the same page reach the buffer pool once, and hold one pin.
+    for (int i = 0; i < 10; ++i) {
+      Page *page = pin_cache.FetchPage(0);
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ(0, page->GetPageId());
+    }
+    EXPECT_EQ(1, bpm->fetches_);
+    EXPECT_EQ(1, bpm->GetPages()[0].GetPinCount());
+
+    // Scenario: once the cache is full, the older half of its pins go in one batch.
+    for (page_id_t id = 1; id < 4; ++id) {
+      ASSERT_NE(nullptr, pin_cache.FetchPage(id));
+    }
+    EXPECT_EQ(4, pin_cache.Size());
+    EXPECT_TRUE(bpm->unpin_batches_.empty());
+    ASSERT_NE(nullptr, pin_cache.FetchPage(4));
+    ASSERT_EQ(1, bpm->unpin_batches_.size());
+    EXPECT_EQ((std::vector<page_id_t>{0, 1}), bpm->unpin_batches_[0]);
+    EXPECT_EQ(0, bpm->GetPages()[0].GetPinCount());
+    EXPECT_EQ(1, bpm->GetPages()[2].GetPinCount());
+    EXPECT_EQ(3, pin_cache.Size());
+
+    // Scenario: fetching a cached page makes it the most recent, so it outlives older ones.
+    ASSERT_NE(nullptr, pin_cache.FetchPage(2));
+    ASSERT_NE(nullptr, pin_cache.FetchPage(5));
+    ASSERT_NE(nullptr, pin_cache.FetchPage(0));
+    ASSERT_EQ(2, bpm->unpin_batches_.size());
+    EXPECT_EQ((std::vector<page_id_t>{3, 4}), bpm->unpin_batches_[1]);
+    EXPECT_EQ(1, bpm->GetPages()[2].GetPinCount());
+  }
+
+  // Scenario: the cache gives its remaining pins back when it goes away.
+  ASSERT_EQ(3, bpm->unpin_batches_.size());
+  EXPECT_EQ((std::vector<page_id_t>{2, 5, 0}), bpm->unpin_batches_[2]);
+  for (size_t i = 0; i < bpm->GetPoolSize(); ++i) {
+    EXPECT_EQ(0, bpm->GetPages()[i].GetPinCount());
+  }
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.fpm");
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(PinCacheTest, PoolFractionTest) {
+  auto *disk_manager = new DiskManager("test.db");
+
+  // Scenario: a small pool cannot spare the pins, so it gets no cache at all.
+  auto *bpm = new BufferPoolManagerInstance(PIN_CACHE_POOL_FRACTION, disk_manager);
+  EXPECT_EQ(nullptr, PinCache::ForPool(bpm));
+  delete bpm;
+
+  // Scenario: a cache takes only a small part of a mid-sized pool, and no more than PIN_CACHE_SIZE of a large one.
+  bpm = new BufferPoolManagerInstance(4 * PIN_CACHE_POOL_FRACTION, disk_manager);
+  auto pin_cache = PinCache::ForPool(bpm);
+  ASSERT_NE(nullptr, pin_cache);
+  EXPECT_EQ(4, pin_cache->Capacity());
+  pin_cache = nullptr;
+  delete bpm;
+  bpm = new BufferPoolManagerInstance(64 * PIN_CACHE_POOL_FRACTION, disk_manager);
+  pin_cache = PinCache::ForPool(bpm);
+  ASSERT_NE(nullptr, pin_cache);
+  EXPECT_EQ(PIN_CACHE_SIZE, pin_cache->Capacity());
+  pin_cache = nullptr;
+  delete bpm;
+
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.fpm");
+  delete disk_manager;
+}
+
+}  // namespace bustub
@@ -0,0 +1,235 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// read_ahead_test.cpp
+//
+// Identification: test/buffer/read_ahead_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/read_ahead.h"
+
+#include <cstdio>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_access_strategy.h"
+#include "buffer/buffer_pool_manager_instance.h"
+#include "gtest/gtest.h"
+#include "storage/disk/extent.h"
+
+namespace bustub {
+
+/** Records the read-ahead requests instead of reading anything. */
+class RecordingBufferPoolManager : public BufferPoolManagerInstance {
+ public:
+  using BufferPoolManagerInstance::BufferPoolManagerInstance;
+
+  void PrefetchPages(const std::vector<page_id_t> &page_ids, BufferAccessStrategy *strategy = nullptr) override {
+    requests_.push_back(page_ids);
+  }
+
+  std::vector<std::vector<page_id_t>> requests_;
+};
+
+// NOLINTNEXTLINE
+TEST(ReadAheadTest, WindowTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new RecordingBufferPoolManager(128, disk_manager);
+  ReadAheadWindow read_ahead(bpm);
+
+  // Scenario: a sequential scan starts with a small window, and every page ahead of it is requested exactly once.
+  read_ahead.Advance(0, 1);
+  EXPECT_EQ(static_cast<size_t>(READ_AHEAD_MIN_WINDOW), read_ahead.GetWindowSize());
+  ASSERT_EQ(1, bpm->requests_.size());
+  EXPECT_EQ((std::vector<page_id_t>{2, 3, 4, 5}), bpm->requests_[0]);
+
+  for (page_id_t page_id = 1; page_id < 200; ++page_id) {
+    read_ahead.Advance(page_id, page_id + 1);
+  }
+  page_id_t expected = 2;
+  for (const auto &request : bpm->requests_) {
+    for (page_id_t page_id : request) {
+      EXPECT_EQ(expected++, page_id);
+    }
+  }
+  EXPECT_GT(expected, 200);
+
+  // Scenario: the window grows up to a quarter of the pool, so far fewer requests than pages are issued.
+  EXPECT_EQ(32, read_ahead.GetWindowSize());
+  EXPECT_LT(bpm->requests_.size(), 20);
+
+  // Scenario: a jump backwards, or past the window, is not sequential.
+  read_ahead.Advance(200, 10);
+  EXPECT_EQ(0, read_ahead.GetWindowSize());
+  read_ahead.Advance(10, 11);
+  EXPECT_EQ(static_cast<size_t>(READ_AHEAD_MIN_WINDOW), read_ahead.GetWindowSize());
+  read_ahead.Advance(11, 100);
+  EXPECT_EQ(0, read_ahead.GetWindowSize());
+
+  // Scenario: read-ahead is disabled without a buffer pool.
+  ReadAheadWindow disabled;
+  disabled.Advance(0, 1);
+  EXPECT_EQ(0, disabled.GetWindowSize());
+
+  // The pool may still be reading ahead, which it must be done with before the disk manager shuts down.
+  delete bpm;
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.fpm");
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ReadAheadTest, PrefetchTest) {
+  const size_t buffer_pool_size = 10;
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  // Scenario: write twice as many pages as fit, so that the first ones are evicted.
+  page_id_t page_id;
+  for (size_t i = 0; i < 2 * buffer_pool_size; ++i) {
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+
+  // Scenario: prefetching loads the pages in the background without pinning them. Unallocated pages are skipped.
+  bpm->PrefetchPages({0, 1, 2, 1000});
+  auto resident = [&] {
+    size_t found = 0;
+    for (size_t i = 0; i < buffer_pool_size; ++i) {
+      Page &page = bpm->GetPages()[i];
+      if (page.GetPageId() >= 0 && page.GetPageId() <= 2 && page.GetPinCount() == 0) {
+        found++;
+      }
+    }
+    return found == 3;
+  };
+  for (int i = 0; i < 1000 && !resident(); ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  ASSERT_TRUE(resident());
+
+  for (page_id = 0; page_id <= 2; ++page_id) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page " + std::to_string(page_id), std::string(page->GetData()));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+
+  // Scenario: the pages of an extent may be read ahead before they are handed out. The new page then takes over the
+  // frame the page was read into, rather than ending up in two frames.
+  Extent extent;
+  auto *page = bpm->NewPageInExtent(&page_id, &extent);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  page_id_t next_page_id = page_id + 1;
+  bpm->PrefetchPages({next_page_id});
+  auto prefetched = [&] {
+    for (size_t i = 0; i < buffer_pool_size; ++i) {
+      if (bpm->GetPages()[i].GetPageId() == next_page_id && bpm->GetPages()[i].GetPinCount() == 0) {
+        return true;
+      }
+    }
+    return false;
+  };
+  for (int i = 0; i < 1000 && !prefetched(); ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  ASSERT_TRUE(prefetched());
+  page = bpm->NewPageInExtent(&page_id, &extent);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(next_page_id, page_id);
+  snprintf(page->GetData(), PAGE_SIZE, "new page");
+  EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  size_t frames = 0;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    frames += bpm->GetPages()[i].GetPageId() == page_id ? 1 : 0;
+  }
+  EXPECT_EQ(1, frames);
+  bpm->FlushAllPages();
+  page = bpm->FetchPage(page_id);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ("new page", std::string(page->GetData()));
+  EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+
+  // The pool may still be reading ahead, which it must be done with before the disk manager shuts down.
+  delete bpm;
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.fpm");
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ReadAheadTest, StrategyTest) {
+  const size_t buffer_pool_size = 64;
+  const page_id_t hot_pages = 16;
+  const page_id_t num_pages = 256;
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManagerInstance(buffer_pool_size, disk_manager);
+
+  page_id_t page_id;
+  for (page_id_t i = 0; i < num_pages; ++i) {
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "page %d", page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+  for (page_id = 0; page_id < hot_pages; ++page_id) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  auto count_resident_hot_pages = [&] {
+    page_id_t resident = 0;
+    for (size_t i = 0; i < buffer_pool_size; ++i) {
+      resident += bpm->GetPages()[i].GetPageId() < hot_pages ? 1 : 0;
+    }
+    return resident;
+  };
+
+  // Scenario: a bulk read that reads ahead reads into its ring, so the working set survives. Like a scan, it holds on
+  // to each page until it has the next one.
+  BufferAccessStrategy scan(BufferAccessType::BULK_READ, BULK_READ_RING_SIZE);
+  ReadAheadWindow read_ahead(bpm, &scan);
+  uint64_t hits = bpm->GetStats().hits_;
+  ASSERT_NE(nullptr, bpm->FetchPageWithStrategy(hot_pages, &scan));
+  for (page_id = hot_pages + 1; page_id < num_pages; ++page_id) {
+    read_ahead.Advance(page_id - 1, page_id);
+    auto *page = bpm->FetchPageWithStrategy(page_id, &scan);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("page " + std::to_string(page_id), std::string(page->GetData()));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id - 1, false));
+  }
+  EXPECT_EQ(true, bpm->UnpinPage(num_pages - 1, false));
+  EXPECT_LT(0, read_ahead.GetWindowSize());
+  // The scan found the pages read ahead.
+  EXPECT_LT(hits, bpm->GetStats().hits_);
+  EXPECT_EQ(hot_pages, count_resident_hot_pages());
+
+  // Scenario: without the strategy, the pages read ahead go into the shared pool like the others.
+  ReadAheadWindow shared_read_ahead(bpm);
+  ASSERT_NE(nullptr, bpm->FetchPage(hot_pages));
+  for (page_id = hot_pages + 1; page_id < num_pages; ++page_id) {
+    shared_read_ahead.Advance(page_id - 1, page_id);
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id - 1, false));
+  }
+  EXPECT_EQ(true, bpm->UnpinPage(num_pages - 1, false));
+  EXPECT_EQ(0, count_resident_hot_pages());
+
+  // The pool may still be reading ahead, which it must be done with before the disk manager shuts down.
+  delete bpm;
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.fpm");
+  delete disk_manager;
+}
+
+}  // namespace bustub
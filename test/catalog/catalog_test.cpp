@@ -10,6 +10,7 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <fstream>
 #include <string>
 #include <unordered_set>
 #include <vector>
@@ -59,6 +60,7 @@ TEST(CatalogTest, DISABLED_CreateTable1) {
 
   remove("catalog_test.db");
   remove("catalog_test.log");
+  remove("catalog_test.fpm");
 }
 
 TEST(CatalogTest, DISABLED_CreateTable2) {
@@ -87,6 +89,7 @@ TEST(CatalogTest, DISABLED_CreateTable2) {
 
   remove("catalog_test.db");
   remove("catalog_test.log");
+  remove("catalog_test.fpm");
 }
 
 TEST(CatalogTest, DISABLED_CreateTable3) {
@@ -119,6 +122,7 @@ TEST(CatalogTest, DISABLED_CreateTable3) {
 
   remove("catalog_test.db");
   remove("catalog_test.log");
+  remove("catalog_test.fpm");
 }
 
 TEST(CatalogTest, DISABLED_CreateTableTest) {
@@ -215,6 +219,7 @@ TEST(CatalogTest, DISABLED_CreateIndex1) {
 
   remove("catalog_test.db");
   remove("catalog_test.log");
+  remove("catalog_test.fpm");
 }
 
 // Attempts to create an index with duplicate name should fail
@@ -264,6 +269,7 @@ TEST(CatalogTest, DISABLED_CreateIndex2) {
 
   remove("catalog_test.db");
   remove("catalog_test.log");
+  remove("catalog_test.fpm");
 }
 
 TEST(CatalogTest, DISABLED_CreateIndex3) {
@@ -338,6 +344,7 @@ TEST(CatalogTest, DISABLED_QueryIndex1) {
 
   remove("catalog_test.db");
   remove("catalog_test.log");
+  remove("catalog_test.fpm");
 }
 
 // Vanilla index queries by index OID
@@ -388,6 +395,7 @@ TEST(CatalogTest, DISABLED_QueryIndex2) {
 
   remove("catalog_test.db");
   remove("catalog_test.log");
+  remove("catalog_test.fpm");
 }
 
 // Query for nonexistent index on table should fail
@@ -410,6 +418,7 @@ TEST(CatalogTest, DISABLED_FailedQuery1) {
 
   remove("catalog_test.db");
   remove("catalog_test.log");
+  remove("catalog_test.fpm");
 }
 
 // Query for index on nonexistent table should fail
@@ -423,6 +432,7 @@ TEST(CatalogTest, DISABLED_FailedQuery2) {
 
   remove("catalog_test.db");
   remove("catalog_test.log");
+  remove("catalog_test.fpm");
 }
 
 // Query for nonexistent index OID should throw
@@ -437,6 +447,7 @@ TEST(CatalogTest, DISABLED_FailedQuery3) {
 
   remove("catalog_test.db");
   remove("catalog_test.log");
+  remove("catalog_test.fpm");
 }
 
 // Query for all indexes on nonexistent table should give empty collection
@@ -451,6 +462,7 @@ TEST(CatalogTest, DISABLED_FailedQuery4) {
 
   remove("catalog_test.db");
   remove("catalog_test.log");
+  remove("catalog_test.fpm");
 }
 
 // Query for all indexes on existing table with no
@@ -475,6 +487,7 @@ TEST(CatalogTest, DISABLED_FailedQuery5) {
 
   remove("catalog_test.db");
   remove("catalog_test.log");
+  remove("catalog_test.fpm");
 }
 
 // Should be able to create and interact with an index with a single BIGINT key
@@ -527,6 +540,7 @@ TEST(CatalogTest, DISABLED_IndexInteraction0) {
 
   remove("catalog_test.db");
   remove("catalog_test.log");
+  remove("catalog_test.fpm");
 }
 
 // Should be able to create and interact with an index that is keyed by two INTEGER values
@@ -579,6 +593,7 @@ TEST(CatalogTest, DISABLED_IndexInteraction1) {
 
   remove("catalog_test.db");
   remove("catalog_test.log");
+  remove("catalog_test.fpm");
 }
 
 // Should be able to create and interact with an index that is keyed by a single INTEGER column
@@ -631,6 +646,7 @@ TEST(CatalogTest, DISABLED_IndexInteraction2) {
 
   remove("catalog_test.db");
   remove("catalog_test.log");
+  remove("catalog_test.fpm");
 }
 
 TEST(CatalogTest, DISABLED_IndexInteraction3) {
@@ -686,6 +702,86 @@ TEST(CatalogTest, DISABLED_IndexInteraction3) {
 
   remove("catalog_test.db");
   remove("catalog_test.log");
+  remove("catalog_test.fpm");
+}
+
+// Tables and indexes created in tablespaces of their own keep all their pages in their own files
+TEST(CatalogTest, TablespaceTest) {
+  auto disk_manager = std::make_unique<DiskManager>("catalog_test.db");
+  auto bpm = std::make_unique<BufferPoolManagerInstance>(32, disk_manager.get());
+  auto catalog = std::make_unique<Catalog>(bpm.get(), nullptr, nullptr, disk_manager.get());
+  auto txn = std::make_unique<Transaction>(0);
+  auto file_size = [](const char *file_name) { return std::ifstream(file_name, std::ios::ate).tellg(); };
+
+  // The header page, where the index records its root, stays in the db file.
+  page_id_t header_page_id;
+  bpm->NewPage(&header_page_id);
+  bpm->UnpinPage(header_page_id, true);
+
+  std::vector<Column> columns{{"A", TypeId::BIGINT}, {"B", TypeId::VARCHAR, 64}};
+  Schema schema{columns};
+  auto *table_info = catalog->CreateTable(txn.get(), "foobar", schema);
+  ASSERT_NE(Catalog::NULL_TABLE_INFO, table_info);
+  const tablespace_id_t table_space = table_info->table_->GetTablespace();
+  EXPECT_NE(DEFAULT_TABLESPACE, table_space);
+  // Enough tuples for the index to split its leaves several times.
+  const int num_tuples = 2000;
+  for (int i = 0; i < num_tuples; ++i) {
+    std::vector<Value> values{ValueFactory::GetBigIntValue(i), ValueFactory::GetVarcharValue(std::string(50, 'x'))};
+    Tuple tuple{values, &schema};
+    RID rid;
+    ASSERT_TRUE(table_info->table_->InsertTuple(tuple, &rid, txn.get()));
+    EXPECT_EQ(table_space, DiskManager::TablespaceOf(rid.GetPageId()));
+  }
+
+  Schema key_schema{std::vector<Column>{{"A", TypeId::BIGINT}}};
+  auto *index_info = catalog->CreateIndex<BigintKeyType, BigintValueType, BigintComparatorType>(
+      txn.get(), "index1", "foobar", schema, key_schema, {0}, BIGINT_SIZE, BigintHashFunctionType{});
+  ASSERT_NE(Catalog::NULL_INDEX_INFO, index_info);
+  const tablespace_id_t index_space = index_info->tablespace_;
+  EXPECT_NE(DEFAULT_TABLESPACE, index_space);
+  EXPECT_NE(table_space, index_space);
+  for (int i = 0; i < num_tuples; i += 77) {
+    std::vector<RID> results;
+    Tuple key{std::vector<Value>{ValueFactory::GetBigIntValue(i)}, &key_schema};
+    index_info->index_->ScanKey(key, &results, txn.get());
+    ASSERT_EQ(1, results.size());
+    EXPECT_EQ(table_space, DiskManager::TablespaceOf(results[0].GetPageId()));
+  }
+
+  // Nothing but the header page went to the db file.
+  bpm->FlushAllPages();
+  EXPECT_EQ(PAGE_SIZE, file_size("catalog_test.db"));
+  EXPECT_LT(2 * PAGE_SIZE, file_size("catalog_test.ts1"));
+  EXPECT_LT(2 * PAGE_SIZE, file_size("catalog_test.ts2"));
+
+  // A pinned page of the table keeps the table from being dropped, and its index along with it.
+  const page_id_t first_page_id = table_info->table_->GetFirstPageId();
+  ASSERT_NE(nullptr, bpm->FetchPage(first_page_id));
+  EXPECT_FALSE(catalog->DropTable(txn.get(), "foobar"));
+  EXPECT_EQ(index_info, catalog->GetIndex("index1", "foobar"));
+  EXPECT_TRUE(disk_manager->HasTablespace(table_space));
+  EXPECT_TRUE(disk_manager->HasTablespace(index_space));
+  bpm->UnpinPage(first_page_id, false);
+
+  // Dropping the table deletes its file and that of its index, and the pool no longer holds any of their pages.
+  EXPECT_TRUE(catalog->DropTable(txn.get(), "foobar"));
+  EXPECT_EQ(Catalog::NULL_TABLE_INFO, catalog->GetTable("foobar"));
+  EXPECT_FALSE(disk_manager->HasTablespace(table_space));
+  EXPECT_FALSE(disk_manager->HasTablespace(index_space));
+  EXPECT_FALSE(std::ifstream("catalog_test.ts1").good());
+  EXPECT_FALSE(std::ifstream("catalog_test.ts2").good());
+  for (size_t i = 0; i < bpm->GetPoolSize(); ++i) {
+    page_id_t page_id = bpm->GetPages()[i].GetPageId();
+    EXPECT_TRUE(page_id == INVALID_PAGE_ID || DiskManager::TablespaceOf(page_id) == DEFAULT_TABLESPACE);
+  }
+  EXPECT_FALSE(catalog->DropTable(txn.get(), "foobar"));
+
+  bpm.reset();
+  disk_manager->ShutDown();
+  remove("catalog_test.db");
+  remove("catalog_test.log");
+  remove("catalog_test.fpm");
 }
 
 }  // namespace bustub
@@ -52,8 +52,9 @@ TEST(HashTablePageTest, DISABLED_DirectoryPageSampleTest) {
   bpm->UnpinPage(directory_page_id, true, nullptr);
   disk_manager->ShutDown();
   remove("test.db");
-  delete disk_manager;
+  remove("test.fpm");
   delete bpm;
+  delete disk_manager;
 }
 
 // NOLINTNEXTLINE
@@ -110,8 +111,9 @@ TEST(HashTablePageTest, DISABLED_BucketPageSampleTest) {
   bpm->UnpinPage(bucket_page_id, true, nullptr);
   disk_manager->ShutDown();
   remove("test.db");
-  delete disk_manager;
+  remove("test.fpm");
   delete bpm;
+  delete disk_manager;
 }
 
 }  // namespace bustub
@@ -113,8 +113,9 @@ TEST(HashTableTest, DISABLED_SampleTest) {
 
   disk_manager->ShutDown();
   remove("test.db");
-  delete disk_manager;
+  remove("test.fpm");
   delete bpm;
+  delete disk_manager;
 }
 
 }  // namespace bustub
@@ -71,10 +71,16 @@ class ExecutorTest : public ::testing::Test {
     // Commit our transaction
     txn_mgr_->Commit(txn_);
 
-    // Shut down the disk manager and clean up the transaction
+    // Shut down the disk manager and clean up the transaction. The buffer pool may still be reading ahead, so it and
+    // its users go first.
+    exec_ctx_.reset();
+    execution_engine_.reset();
+    catalog_.reset();
+    bpm_.reset();
     disk_manager_->ShutDown();
     remove("executor_test.db");
     remove("executor_test.log");
+    remove("executor_test.fpm");
     delete txn_;
   };
 
@@ -0,0 +1,90 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// async_io_test.cpp
+//
+// Identification: test/storage/async_io_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <future>  // NOLINT
+#include <memory>
+#include <vector>
+
+#include "common/config.h"
+#include "gtest/gtest.h"
+#include "storage/disk/async_io.h"
+
+namespace bustub {
+
+// Write a batch of pages through the backend, all in flight at once, and read them back the same way.
+static void CheckBackend(AsyncIo *io) {
+  const int num_pages = 100;
+  int fd = open("async_io_test.db", O_RDWR | O_CREAT | O_TRUNC, 0644);
+  ASSERT_GE(fd, 0);
+
+  std::vector<char> written(num_pages * PAGE_SIZE);
+  for (size_t i = 0; i < written.size(); ++i) {
+    written[i] = static_cast<char>(i * 7 + i / PAGE_SIZE);
+  }
+  std::vector<std::promise<ssize_t>> results(num_pages);
+  for (int i = 0; i < num_pages; ++i) {
+    io->SubmitWrite(fd, written.data() + i * PAGE_SIZE, PAGE_SIZE, static_cast<int64_t>(i) * PAGE_SIZE,
+                    [&results, i](ssize_t count) { results[i].set_value(count); });
+  }
+  for (auto &result : results) {
+    EXPECT_EQ(PAGE_SIZE, result.get_future().get());
+  }
+
+  std::vector<char> read(num_pages * PAGE_SIZE);
+  results = std::vector<std::promise<ssize_t>>(num_pages);
+  for (int i = num_pages - 1; i >= 0; --i) {
+    io->SubmitRead(fd, read.data() + i * PAGE_SIZE, PAGE_SIZE, static_cast<int64_t>(i) * PAGE_SIZE,
+                   [&results, i](ssize_t count) { results[i].set_value(count); });
+  }
+  for (auto &result : results) {
+    EXPECT_EQ(PAGE_SIZE, result.get_future().get());
+  }
+  EXPECT_EQ(0, memcmp(written.data(), read.data(), written.size()));
+
+  // Scenario: a read at the end of the file reads nothing.
+  std::promise<ssize_t> past_end;
+  io->SubmitRead(fd, read.data(), PAGE_SIZE, static_cast<int64_t>(num_pages) * PAGE_SIZE,
+                 [&past_end](ssize_t count) { past_end.set_value(count); });
+  EXPECT_EQ(0, past_end.get_future().get());
+
+  // Scenario: a request that fails still completes, with the error.
+  std::promise<ssize_t> bad_fd;
+  io->SubmitRead(-1, read.data(), PAGE_SIZE, 0, [&bad_fd](ssize_t count) { bad_fd.set_value(count); });
+  EXPECT_EQ(-EBADF, bad_fd.get_future().get());
+
+  close(fd);
+  remove("async_io_test.db");
+  remove("async_io_test.fpm");
+}
+
+// NOLINTNEXTLINE
+TEST(AsyncIoTest, ThreadPoolTest) {
+  IoThreadPool pool(4);
+  CheckBackend(&pool);
+}
+
+// NOLINTNEXTLINE
+TEST(AsyncIoTest, IoUringTest) {
+  std::unique_ptr<IoUring> ring(IoUring::Create(8));
+  if (ring == nullptr) {
+    GTEST_SKIP() << "io_uring is not available";
+  }
+  // More requests than the queue depth, so that submitters have to wait for room.
+  CheckBackend(ring.get());
+}
+
+}  // namespace bustub
@@ -10,10 +10,14 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>  // NOLINT
 #include <cstdio>
 #include <functional>
+#include <random>
 #include <thread>  // NOLINT
+#include <vector>
 
 #include "buffer/buffer_pool_manager_instance.h"
 #include "gtest/gtest.h"
@@ -146,10 +150,11 @@ TEST(BPlusTreeConcurrentTest, InsertTest1) {
   EXPECT_EQ(current_key, keys.size() + 1);
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
+  remove("test.fpm");
 }
 
 TEST(BPlusTreeConcurrentTest, InsertTest2) {
@@ -197,10 +202,11 @@ TEST(BPlusTreeConcurrentTest, InsertTest2) {
   EXPECT_EQ(current_key, keys.size() + 1);
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
+  remove("test.fpm");
 }
 
 TEST(BPlusTreeConcurrentTest, DeleteTest1) {
@@ -239,10 +245,11 @@ TEST(BPlusTreeConcurrentTest, DeleteTest1) {
   EXPECT_EQ(size, 1);
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
+  remove("test.fpm");
 }
 
 TEST(BPlusTreeConcurrentTest, DeleteTest2) {
@@ -282,10 +289,11 @@ TEST(BPlusTreeConcurrentTest, DeleteTest2) {
   EXPECT_EQ(size, 4);
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
+  remove("test.fpm");
 }
 
 TEST(BPlusTreeConcurrentTest, MixTest) {
@@ -327,10 +335,183 @@ TEST(BPlusTreeConcurrentTest, MixTest) {
   EXPECT_EQ(size, 5);
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+  remove("test.fpm");
+}
+
+// Concurrent lookups on a tree with swizzled child links, in a pool small enough that the hints keep going stale as
+// pages are evicted.
+TEST(BPlusTreeConcurrentTest, SwizzledInsertTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  // create b+ tree
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 4, 4, true);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  // keys to Insert
+  std::vector<int64_t> keys;
+  int64_t scale_factor = 1000;
+  for (int64_t key = 1; key < scale_factor; key++) {
+    keys.push_back(key);
+  }
+  InsertHelper(&tree, keys);
+
+  // Look every key up twice from several threads, the second time through the hints left by the first.
+  auto lookup = [&](uint64_t thread_itr) {
+    std::vector<RID> rids;
+    GenericKey<8> index_key;
+    for (int round = 0; round < 2; round++) {
+      for (auto key : keys) {
+        rids.clear();
+        index_key.SetFromInteger(key);
+        tree.GetValue(index_key, &rids);
+        ASSERT_EQ(rids.size(), 1);
+        EXPECT_EQ(rids[0].GetSlotNum(), key);
+      }
+    }
+  };
+  LaunchParallelTest(4, lookup);
+
+  int64_t current_key = 1;
+  GenericKey<8> index_key;
+  index_key.SetFromInteger(current_key);
+  for (auto iterator = tree.Begin(index_key); iterator != tree.End(); ++iterator) {
+    EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+    current_key = current_key + 1;
+  }
+  EXPECT_EQ(current_key, keys.size() + 1);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
+  delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+  remove("test.fpm");
+}
+
+// One writer keeps splitting pages while readers, which latch nothing, look up and scan the keys inserted so far.
+TEST(BPlusTreeConcurrentTest, OptimisticReadTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  // create b+ tree
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 4, 4);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  const int64_t scale_factor = 2000;
+  std::atomic<int64_t> inserted{0};
+  std::thread writer([&] {
+    for (int64_t key = 1; key <= scale_factor; key++) {
+      InsertHelper(&tree, {key});
+      inserted = key;
+    }
+  });
+
+  auto reader = [&](uint64_t thread_itr) {
+    std::vector<RID> rids;
+    GenericKey<8> index_key;
+    for (int64_t i = 0; inserted < scale_factor; i++) {
+      int64_t high = inserted;
+      if (high == 0) {
+        continue;
+      }
+      int64_t key = (i * 7 + thread_itr) % high + 1;
+      rids.clear();
+      index_key.SetFromInteger(key);
+      ASSERT_TRUE(tree.GetValue(index_key, &rids));
+      ASSERT_EQ(rids.size(), 1);
+      EXPECT_EQ(rids[0].GetSlotNum(), key);
+
+      // Keys only ever get added, so a scan sees every key inserted before it started.
+      int64_t expected = key;
+      for (auto iterator = tree.Begin(index_key); iterator != tree.End() && expected <= high; ++iterator) {
+        ASSERT_EQ((*iterator).second.GetSlotNum(), expected);
+        expected++;
+      }
+      EXPECT_EQ(expected, high + 1);
+    }
+  };
+  LaunchParallelTest(3, reader);
+  writer.join();
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete bpm;
   delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+  remove("test.fpm");
+}
+
+// NOLINTNEXTLINE
+TEST(BPlusTreeConcurrentTest, BeginSplitTest) {
+  // create KeyComparator and index schema
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(50, disk_manager);
+  // create b+ tree, with small leaves so that they split all the time
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 3, 4);
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  const int64_t scale_factor = 2000;
+  std::vector<int64_t> keys;
+  for (int64_t key = 1; key <= scale_factor; key++) {
+    keys.push_back(key);
+  }
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(7));
+  std::atomic<bool> done{false};
+  std::thread writer([&] {
+    for (int64_t key : keys) {
+      InsertHelper(&tree, {key});
+    }
+    done = true;
+  });
+
+  // Scenario: a scan that starts at a key never returns a smaller key, even if the leaf it was found in splits before
+  // the scan reads it.
+  auto reader = [&](uint64_t thread_itr) {
+    std::mt19937 rng(thread_itr);
+    GenericKey<8> index_key;
+    while (!done) {
+      int64_t start = std::uniform_int_distribution<int64_t>(1, scale_factor)(rng);
+      index_key.SetFromInteger(start);
+      int64_t previous = start - 1;
+      int count = 0;
+      for (auto iterator = tree.Begin(index_key); iterator != tree.End() && count < 4; ++iterator, ++count) {
+        int64_t key = (*iterator).second.GetSlotNum();
+        ASSERT_GT(key, previous);
+        previous = key;
+      }
+    }
+  };
+  LaunchParallelTest(3, reader);
+  writer.join();
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
+  remove("test.fpm");
 }
 
 }  // namespace bustub
@@ -92,10 +92,11 @@ TEST(BPlusTreeTests, DeleteTest1) {
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
   delete transaction;
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
+  remove("test.fpm");
 }
 
 TEST(BPlusTreeTests, DeleteTest2) {
@@ -170,9 +171,10 @@ TEST(BPlusTreeTests, DeleteTest2) {
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
   delete transaction;
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
+  remove("test.fpm");
 }
 }  // namespace bustub
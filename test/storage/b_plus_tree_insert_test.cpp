@@ -72,10 +72,11 @@ TEST(BPlusTreeTests, InsertTest1) {
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
   delete transaction;
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
+  remove("test.fpm");
 }
 
 TEST(BPlusTreeTests, InsertTest2) {
@@ -140,9 +141,58 @@ TEST(BPlusTreeTests, InsertTest2) {
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
   delete transaction;
+  delete bpm;
   delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+  remove("test.fpm");
+}
+
+// Full nodes take one entry over their max size before they split; with the default sizes that must still fit a page.
+TEST(BPlusTreeTests, DefaultSizeInsertTest) {
+  auto key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema.get());
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManagerInstance(64, disk_manager);
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator);
+  GenericKey<8> index_key;
+  RID rid;
+  Transaction *transaction = new Transaction(0);
+
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+
+  // Enough keys to split leaves many times and the root internal page at least once.
+  const int64_t num_keys = 100000;
+  for (int64_t key = 0; key < num_keys; ++key) {
+    rid.Set(static_cast<int32_t>(key >> 32), key & 0xFFFFFFFF);
+    index_key.SetFromInteger(key);
+    ASSERT_TRUE(tree.Insert(index_key, rid, transaction));
+  }
+
+  std::vector<RID> rids;
+  for (int64_t key = 0; key < num_keys; ++key) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    ASSERT_TRUE(tree.GetValue(index_key, &rids)) << key;
+    EXPECT_EQ(rids[0].GetSlotNum(), key & 0xFFFFFFFF);
+  }
+  int64_t current_key = 0;
+  for (auto iterator = tree.Begin(); iterator != tree.End(); ++iterator) {
+    EXPECT_EQ((*iterator).second.GetSlotNum(), current_key);
+    current_key = current_key + 1;
+  }
+  EXPECT_EQ(num_keys, current_key);
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete transaction;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
+  remove("test.fpm");
 }
+
 }  // namespace bustub
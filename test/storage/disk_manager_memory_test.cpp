@@ -0,0 +1,184 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_manager_memory_test.cpp
+//
+// Identification: test/storage/disk_manager_memory_test.cpp
+//
+// Copyright (c) 2015-2021, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/disk/disk_manager_memory.h"
+
+#include <chrono>  // NOLINT
+#include <cstring>
+#include <future>  // NOLINT
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/bustub_instance.h"
+#include "common/exception.h"
+#include "gtest/gtest.h"
+#include "storage/table/table_heap.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(DiskManagerMemoryTest, ReadWritePageTest) {
+  char buf[PAGE_SIZE] = {0};
+  char data[PAGE_SIZE] = {0};
+  DiskManagerMemory dm;
+  std::strncpy(data, "A test string.", sizeof(data));
+
+  // Scenario: pages read back what was written, and pages never written read as zeros.
+  dm.ReadPage(0, buf);
+  EXPECT_EQ(0, buf[0]);
+  dm.WritePage(0, data);
+  dm.ReadPage(0, buf);
+  EXPECT_EQ(0, std::memcmp(buf, data, sizeof(buf)));
+  dm.WritePage(5, data);
+  dm.ReadPage(5, buf);
+  EXPECT_EQ(0, std::memcmp(buf, data, sizeof(buf)));
+
+  // Scenario: batched and asynchronous I/O see the same pages.
+  std::vector<std::vector<char>> pages(3, std::vector<char>(PAGE_SIZE));
+  std::vector<std::pair<page_id_t, const char *>> writes;
+  for (size_t i = 0; i < pages.size(); ++i) {
+    std::fill(pages[i].begin(), pages[i].end(), static_cast<char>('a' + i));
+    writes.emplace_back(static_cast<page_id_t>(i + 1), pages[i].data());
+  }
+  dm.WritePages(writes);
+  dm.WritePageAsync(4, pages[0].data()).get();
+  std::vector<std::vector<char>> read(4, std::vector<char>(PAGE_SIZE));
+  dm.ReadPages({{3, read[2].data()}, {1, read[0].data()}, {2, read[1].data()}});
+  dm.ReadPageAsync(4, read[3].data()).get();
+  EXPECT_EQ(pages[0], read[0]);
+  EXPECT_EQ(pages[1], read[1]);
+  EXPECT_EQ(pages[2], read[2]);
+  EXPECT_EQ(pages[0], read[3]);
+  EXPECT_EQ(6, dm.GetNumWrites());
+
+  // Scenario: the pages of a dropped tablespace are gone.
+  tablespace_id_t tablespace = dm.CreateTablespace();
+  page_id_t page_id = dm.AllocatePage(1, 0, tablespace);
+  EXPECT_EQ(tablespace, DiskManager::TablespaceOf(page_id));
+  dm.WritePage(page_id, data);
+  dm.DropTablespace(tablespace);
+  EXPECT_EQ(tablespace, dm.CreateTablespace());
+  dm.ReadPage(page_id, buf);
+  EXPECT_EQ(0, buf[0]);
+
+  // Scenario: the log is kept in memory too.
+  char log[] = "log record";
+  dm.WriteLog(log, sizeof(log));
+  char log_buf[2 * sizeof(log)];
+  EXPECT_TRUE(dm.ReadLog(log_buf, sizeof(log_buf), 0));
+  EXPECT_STREQ(log, log_buf);
+  EXPECT_FALSE(dm.ReadLog(log_buf, sizeof(log_buf), sizeof(log)));
+  EXPECT_EQ(1, dm.GetNumFlushes());
+
+  EXPECT_THROW(dm.MapReadOnly(), Exception);
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST(DiskManagerMemoryTest, ModelTest) {
+  using std::chrono::microseconds;
+  using std::chrono::milliseconds;
+  char data[PAGE_SIZE] = {0};
+  auto elapsed = [](auto &&io) {
+    auto start = std::chrono::steady_clock::now();
+    io();
+    return std::chrono::steady_clock::now() - start;
+  };
+
+  // Scenario: every I/O takes its latency, and a seek on top unless it continues where the previous one ended.
+  DiskModel model;
+  model.read_latency_ = microseconds(500);
+  model.write_latency_ = milliseconds(1);
+  model.seek_latency_ = milliseconds(2);
+  DiskManagerMemory dm(model);
+  EXPECT_LE(milliseconds(3), elapsed([&] { dm.WritePage(10, data); }));
+  EXPECT_LE(milliseconds(1), elapsed([&] { dm.WritePage(11, data); }));
+  EXPECT_LE(microseconds(2500), elapsed([&] { dm.ReadPage(3, data); }));
+  DiskStats stats = dm.GetStats();
+  EXPECT_EQ(2, stats.writes_);
+  EXPECT_EQ(1, stats.reads_);
+  EXPECT_EQ(2, stats.seeks_);
+  EXPECT_EQ(4000000, stats.write_ns_);
+  EXPECT_EQ(2500000, stats.read_ns_);
+
+  // Scenario: a batch of adjacent pages is a single I/O, and asynchronous I/Os are in flight together.
+  dm.ResetStats();
+  std::vector<std::pair<page_id_t, const char *>> writes;
+  for (page_id_t page_id = 20; page_id < 30; ++page_id) {
+    writes.emplace_back(page_id, data);
+  }
+  EXPECT_GT(milliseconds(20), elapsed([&] { dm.WritePages(writes); }));
+  EXPECT_GT(milliseconds(20), elapsed([&] {
+              std::vector<std::future<void>> reads;
+              for (page_id_t page_id = 0; page_id < 10; ++page_id) {
+                reads.push_back(dm.ReadPageAsync(page_id * 2, data));
+              }
+              for (auto &read : reads) {
+                read.wait();
+              }
+            }));
+  stats = dm.GetStats();
+  EXPECT_EQ(1, stats.writes_);
+  EXPECT_EQ(10, stats.pages_written_);
+  EXPECT_EQ(10, stats.reads_);
+  EXPECT_EQ(11, stats.seeks_);
+
+  // Scenario: a bandwidth cap makes transfers queue behind each other.
+  DiskModel capped;
+  capped.write_bandwidth_ = 100 * PAGE_SIZE;
+  DiskManagerMemory slow(capped);
+  EXPECT_LE(milliseconds(50), elapsed([&] {
+              for (page_id_t page_id = 0; page_id < 5; ++page_id) {
+                slow.WritePageAsync(page_id, data).wait();
+              }
+            }));
+  EXPECT_EQ(5, slow.GetStats().writes_);
+
+  // Scenario: jitter varies the latencies, the same way for the same seed.
+  DiskModel jittery;
+  jittery.read_latency_ = microseconds(100);
+  jittery.jitter_ = 0.5;
+  jittery.seed_ = 42;
+  DiskManagerMemory dm1(jittery);
+  DiskManagerMemory dm2(jittery);
+  for (page_id_t page_id = 0; page_id < 20; ++page_id) {
+    dm1.ReadPage(page_id, data);
+    dm2.ReadPage(page_id, data);
+  }
+  EXPECT_EQ(dm1.GetStats().read_ns_, dm2.GetStats().read_ns_);
+  EXPECT_NE(2000000, dm1.GetStats().read_ns_);
+  EXPECT_LE(1000000, dm1.GetStats().read_ns_);
+  EXPECT_GE(3000000, dm1.GetStats().read_ns_);
+}
+
+// NOLINTNEXTLINE
+TEST(DiskManagerMemoryTest, BustubInstanceTest) {
+  Schema schema({Column{"a", TypeId::INTEGER}});
+  auto *dm = new DiskManagerMemory(DiskModel::Ssd());
+  BustubInstance bustub(dm);
+  Transaction txn(0);
+  TableHeap table(bustub.buffer_pool_manager_, bustub.lock_manager_, nullptr, &txn);
+  for (int i = 0; i < 1000; ++i) {
+    RID rid;
+    ASSERT_TRUE(table.InsertTuple(Tuple({Value(TypeId::INTEGER, i)}, &schema), &rid, &txn));
+  }
+  bustub.buffer_pool_manager_->FlushAllPages();
+  EXPECT_LT(0, dm->GetStats().pages_written_);
+  int i = 0;
+  for (auto it = table.Begin(&txn); it != table.End(); ++it, ++i) {
+    EXPECT_EQ(i, it->GetValue(&schema, 0).GetAs<int32_t>());
+  }
+  EXPECT_EQ(1000, i);
+}
+
+}  // namespace bustub
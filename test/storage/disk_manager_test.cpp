@@ -10,7 +10,15 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <cstdlib>
 #include <cstring>
+#include <fstream>
+#include <future>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
 
 #include "common/exception.h"
 #include "gtest/gtest.h"
@@ -24,12 +32,18 @@ class DiskManagerTest : public ::testing::Test {
   void SetUp() override {
     remove("test.db");
     remove("test.log");
+    remove("test.fpm");
+    remove("test.ts1");
+    remove("test.ts2");
   }
 
   // This function is called after every test.
   void TearDown() override {
     remove("test.db");
     remove("test.log");
+    remove("test.fpm");
+    remove("test.ts1");
+    remove("test.ts2");
   };
 };
 
@@ -55,6 +69,52 @@ TEST_F(DiskManagerTest, ReadWritePageTest) {
   dm.ShutDown();
 }
 
+// Threads write and read back their own pages at the same time; none may see another's page or a torn one.
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ConcurrentReadWritePageTest) {
+  const int num_threads = 4;
+  const int pages_per_thread = 64;
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file);
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&, t] {
+      char data[PAGE_SIZE];
+      char buf[PAGE_SIZE];
+      for (int round = 0; round < 4; ++round) {
+        for (int i = 0; i < pages_per_thread; ++i) {
+          page_id_t page_id = i * num_threads + t;
+          std::memset(data, 'a' + (page_id + round) % 26, sizeof(data));
+          dm.WritePage(page_id, data);
+          dm.ReadPage(page_id, buf);
+          ASSERT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  dm.Sync();
+  EXPECT_EQ(num_threads * pages_per_thread * 4, dm.GetNumWrites());
+
+  // Scenario: the pages are still there after a restart, and the ones past the end read as zeros.
+  dm.ShutDown();
+  auto dm2 = DiskManager(db_file);
+  char buf[PAGE_SIZE];
+  for (page_id_t page_id = 0; page_id < num_threads * pages_per_thread; ++page_id) {
+    dm2.ReadPage(page_id, buf);
+    EXPECT_EQ('a' + (page_id + 3) % 26, buf[0]);
+    EXPECT_EQ('a' + (page_id + 3) % 26, buf[PAGE_SIZE - 1]);
+  }
+  std::memset(buf, 'x', sizeof(buf));
+  dm2.ReadPage(num_threads * pages_per_thread, buf);
+  EXPECT_EQ(0, buf[0]);
+  EXPECT_EQ(0, buf[PAGE_SIZE - 1]);
+  dm2.ShutDown();
+}
+
 // NOLINTNEXTLINE
 TEST_F(DiskManagerTest, ReadWriteLogTest) {
   char buf[16] = {0};
@@ -72,6 +132,347 @@ TEST_F(DiskManagerTest, ReadWriteLogTest) {
   dm.ShutDown();
 }
 
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, AllocatePageTest) {
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file);
+
+  // Scenario: fresh pages are handed out in order, and every instance only gets ids that mod back to it.
+  for (page_id_t i = 0; i < 4; ++i) {
+    EXPECT_EQ(i, dm.AllocatePage());
+  }
+  dm.DeallocatePage(1);
+  dm.DeallocatePage(2);
+  dm.DeallocatePage(2);
+  dm.DeallocatePage(100);
+  EXPECT_FALSE(dm.IsAllocated(1));
+  EXPECT_TRUE(dm.IsAllocated(3));
+  EXPECT_FALSE(dm.IsAllocated(100));
+
+  // Scenario: freed pages are reused, lowest first.
+  EXPECT_EQ(1, dm.AllocatePage());
+  EXPECT_EQ(2, dm.AllocatePage());
+  EXPECT_EQ(4, dm.AllocatePage());
+
+  dm.DeallocatePage(2);
+  dm.DeallocatePage(3);
+  EXPECT_EQ(3, dm.AllocatePage(2, 1));
+  EXPECT_EQ(5, dm.AllocatePage(2, 1));
+  EXPECT_EQ(2, dm.AllocatePage(2, 0));
+  EXPECT_EQ(6, dm.AllocatePage(2, 0));
+  EXPECT_EQ(8, dm.AllocatePage(2, 0));
+  // Ids an instance has not reached yet cannot be freed on its behalf.
+  dm.DeallocatePage(7);
+  EXPECT_FALSE(dm.IsAllocated(7));
+  EXPECT_EQ(7, dm.AllocatePage(2, 1));
+  EXPECT_EQ(9, dm.AllocatePage(2, 1));
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, FreePageMapRestartTest) {
+  char data[PAGE_SIZE] = {0};
+  std::string db_file("test.db");
+  {
+    auto dm = DiskManager(db_file);
+    for (page_id_t i = 0; i < 10; ++i) {
+      EXPECT_EQ(i, dm.AllocatePage());
+      dm.WritePage(i, data);
+    }
+    dm.DeallocatePage(3);
+    dm.DeallocatePage(7);
+    dm.ShutDown();
+  }
+
+  // Scenario: the free pages and the high-water mark survive a restart.
+  {
+    auto dm = DiskManager(db_file);
+    EXPECT_TRUE(dm.IsAllocated(9));
+    EXPECT_FALSE(dm.IsAllocated(3));
+    EXPECT_EQ(3, dm.AllocatePage());
+    EXPECT_EQ(7, dm.AllocatePage());
+    EXPECT_EQ(10, dm.AllocatePage());
+    // Pages written past the flushed high-water mark are not handed out again after a crash.
+    dm.WritePage(12, data);
+  }
+  {
+    auto dm = DiskManager(db_file);
+    EXPECT_EQ(13, dm.AllocatePage());
+    dm.ShutDown();
+  }
+
+  // Scenario: a new db file starts with an empty map, whatever the old map file says.
+  remove("test.db");
+  auto dm = DiskManager(db_file);
+  EXPECT_EQ(0, dm.AllocatePage());
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, AsyncReadWritePageTest) {
+  const int num_pages = 32;
+  std::vector<std::vector<char>> pages(num_pages, std::vector<char>(PAGE_SIZE));
+  std::vector<char> buf(PAGE_SIZE);
+  DiskManager dm("test.db");
+
+  std::vector<std::future<void>> ios;
+  for (int i = 0; i < num_pages; ++i) {
+    std::fill(pages[i].begin(), pages[i].end(), static_cast<char>('a' + i));
+    ios.push_back(dm.WritePageAsync(i, pages[i].data()));
+  }
+  for (auto &io : ios) {
+    io.wait();
+  }
+  EXPECT_EQ(num_pages, dm.GetNumWrites());
+
+  // Scenario: async reads see the async writes, and so do plain reads.
+  std::vector<std::vector<char>> read(num_pages, std::vector<char>(PAGE_SIZE));
+  ios.clear();
+  for (int i = 0; i < num_pages; ++i) {
+    ios.push_back(dm.ReadPageAsync(i, read[i].data()));
+  }
+  for (int i = 0; i < num_pages; ++i) {
+    ios[i].wait();
+    EXPECT_EQ(pages[i], read[i]);
+  }
+  dm.ReadPage(num_pages - 1, buf.data());
+  EXPECT_EQ(0, memcmp(buf.data(), pages[num_pages - 1].data(), PAGE_SIZE));
+
+  // Scenario: pages past the end of the file read as zeros.
+  std::fill(buf.begin(), buf.end(), 'x');
+  dm.ReadPageAsync(num_pages + 5, buf.data()).wait();
+  EXPECT_EQ(std::vector<char>(PAGE_SIZE, 0), buf);
+
+  // Scenario: the files are closed after ShutDown, so page I/O is an error instead of being lost.
+  dm.ShutDown();
+  EXPECT_THROW(dm.WritePageAsync(0, pages[0].data()), Exception);
+  EXPECT_THROW(dm.ReadPageAsync(0, buf.data()), Exception);
+  EXPECT_THROW(dm.WritePage(0, pages[0].data()), Exception);
+  EXPECT_THROW(dm.ReadPage(0, buf.data()), Exception);
+  EXPECT_EQ(num_pages, dm.GetNumWrites());
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, BatchReadWritePagesTest) {
+  const int num_pages = 300;
+  std::vector<std::vector<char>> pages(num_pages, std::vector<char>(PAGE_SIZE));
+  DiskManager dm("test.db");
+
+  // Scenario: a shuffled batch with gaps and a repeated page; the later copy of the page wins.
+  std::vector<std::pair<page_id_t, const char *>> writes;
+  for (int i = num_pages - 1; i >= 0; --i) {
+    std::fill(pages[i].begin(), pages[i].end(), static_cast<char>(i));
+    if (i % 50 != 7) {
+      writes.emplace_back(i, pages[i].data());
+    }
+  }
+  std::vector<char> stale(PAGE_SIZE, 'x');
+  writes.insert(writes.begin(), {42, stale.data()});
+  dm.WritePages(writes);
+  EXPECT_EQ(static_cast<int>(writes.size()), dm.GetNumWrites());
+
+  std::vector<std::vector<char>> read(num_pages + 2, std::vector<char>(PAGE_SIZE, 'y'));
+  std::vector<std::pair<page_id_t, char *>> reads;
+  for (int i = 0; i < num_pages + 2; ++i) {
+    reads.emplace_back(i, read[i].data());
+  }
+  dm.ReadPages(reads);
+  for (int i = 0; i < num_pages; ++i) {
+    EXPECT_EQ(i % 50 == 7 ? std::vector<char>(PAGE_SIZE, 0) : pages[i], read[i]) << "page " << i;
+  }
+  // Pages past the end of the file read as zeros.
+  EXPECT_EQ(std::vector<char>(PAGE_SIZE, 0), read[num_pages]);
+  EXPECT_EQ(std::vector<char>(PAGE_SIZE, 0), read[num_pages + 1]);
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, DirectIoTest) {
+  const int num_pages = 8;
+  // One aligned buffer per page, and the same data again in buffers that are not aligned.
+  auto *aligned = static_cast<char *>(std::aligned_alloc(PAGE_SIZE, num_pages * PAGE_SIZE));
+  std::vector<char> unaligned(num_pages * PAGE_SIZE + 1);
+  for (int i = 0; i < num_pages * PAGE_SIZE; ++i) {
+    aligned[i] = static_cast<char>(i % 251);
+    unaligned[i + 1] = static_cast<char>(i % 251);
+  }
+  {
+    DiskManager dm("test.db", true);
+    if (!dm.IsDirectIo()) {
+      std::free(aligned);
+      dm.ShutDown();
+      GTEST_SKIP() << "O_DIRECT is not supported here";
+    }
+
+    // Scenario: every kind of write works from both kinds of buffers.
+    dm.WritePage(0, aligned);
+    dm.WritePage(1, unaligned.data() + 1 + PAGE_SIZE);
+    dm.WritePageAsync(2, aligned + 2 * PAGE_SIZE).wait();
+    dm.WritePageAsync(3, unaligned.data() + 1 + 3 * PAGE_SIZE).wait();
+    dm.WritePages({{4, aligned + 4 * PAGE_SIZE},
+                   {5, unaligned.data() + 1 + 5 * PAGE_SIZE},
+                   {6, aligned + 6 * PAGE_SIZE},
+                   {7, aligned + 7 * PAGE_SIZE}});
+
+    // Scenario: and so does every kind of read.
+    std::vector<char> read(num_pages * PAGE_SIZE + 1);
+    auto *read_aligned = static_cast<char *>(std::aligned_alloc(PAGE_SIZE, num_pages * PAGE_SIZE));
+    dm.ReadPage(0, read.data() + 1);
+    dm.ReadPage(1, read_aligned + PAGE_SIZE);
+    dm.ReadPageAsync(2, read.data() + 1 + 2 * PAGE_SIZE).wait();
+    dm.ReadPageAsync(3, read_aligned + 3 * PAGE_SIZE).wait();
+    dm.ReadPages({{4, read_aligned + 4 * PAGE_SIZE},
+                  {5, read_aligned + 5 * PAGE_SIZE},
+                  {6, read.data() + 1 + 6 * PAGE_SIZE},
+                  {7, read_aligned + 7 * PAGE_SIZE}});
+    for (int i = 0; i < num_pages; ++i) {
+      const char *page = i % 2 == 0 && i != 4 ? read.data() + 1 + i * PAGE_SIZE : read_aligned + i * PAGE_SIZE;
+      EXPECT_EQ(0, memcmp(aligned + i * PAGE_SIZE, page, PAGE_SIZE)) << "page " << i;
+    }
+    std::free(read_aligned);
+    dm.ShutDown();
+  }
+
+  // Scenario: the pages are on disk, for a buffered disk manager to see.
+  DiskManager dm("test.db");
+  std::vector<char> buf(PAGE_SIZE);
+  dm.ReadPage(num_pages - 1, buf.data());
+  EXPECT_EQ(0, memcmp(aligned + (num_pages - 1) * PAGE_SIZE, buf.data(), PAGE_SIZE));
+  std::free(aligned);
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, TablespaceTest) {
+  const page_id_t first_ts1 = 1 << TABLESPACE_PAGE_BITS;
+  const page_id_t first_ts2 = 2 << TABLESPACE_PAGE_BITS;
+  auto file_size = [](const char *file_name) { return std::ifstream(file_name, std::ios::ate).tellg(); };
+  std::string db_file("test.db");
+  char data[PAGE_SIZE] = {0};
+  char buf[PAGE_SIZE] = {0};
+  {
+    DiskManager dm(db_file);
+    EXPECT_EQ(0, dm.AllocatePage());
+    EXPECT_EQ(1, dm.CreateTablespace());
+    EXPECT_EQ(2, dm.CreateTablespace());
+    EXPECT_TRUE(dm.HasTablespace(2));
+    EXPECT_FALSE(dm.HasTablespace(3));
+
+    // Scenario: each tablespace hands out its own pages, from the start of its own file.
+    EXPECT_EQ(first_ts1, dm.AllocatePage(1, 0, 1));
+    EXPECT_EQ(first_ts1 + 1, dm.AllocatePage(1, 0, 1));
+    EXPECT_EQ(first_ts2, dm.AllocatePage(1, 0, 2));
+    EXPECT_EQ(1, dm.AllocatePage());
+    EXPECT_EQ(1, DiskManager::TablespaceOf(first_ts1 + 1));
+    EXPECT_EQ(2 * PAGE_SIZE, file_size("test.ts1"));
+    EXPECT_THROW(dm.AllocatePage(1, 0, 3), Exception);
+
+    // Scenario: pages with the same number in different tablespaces are different pages, in single and batched I/O.
+    std::vector<std::vector<char>> pages(4, std::vector<char>(PAGE_SIZE));
+    const std::vector<page_id_t> page_ids = {1, first_ts1, first_ts1 + 1, first_ts2};
+    std::vector<std::pair<page_id_t, const char *>> writes;
+    for (size_t i = 0; i < page_ids.size(); ++i) {
+      std::fill(pages[i].begin(), pages[i].end(), static_cast<char>('a' + i));
+      writes.emplace_back(page_ids[i], pages[i].data());
+    }
+    dm.WritePages({writes.begin(), writes.begin() + 2});
+    dm.WritePage(page_ids[2], pages[2].data());
+    dm.WritePageAsync(page_ids[3], pages[3].data()).get();
+    std::vector<std::vector<char>> read(4, std::vector<char>(PAGE_SIZE));
+    std::vector<std::pair<page_id_t, char *>> reads;
+    for (size_t i = 0; i < page_ids.size(); ++i) {
+      reads.emplace_back(page_ids[i], read[i].data());
+    }
+    dm.ReadPages(reads);
+    EXPECT_EQ(pages, read);
+    dm.ReadPage(first_ts1 + 1, buf);
+    EXPECT_EQ(0, memcmp(buf, pages[2].data(), PAGE_SIZE));
+    dm.ReadPageAsync(first_ts2, buf).get();
+    EXPECT_EQ(0, memcmp(buf, pages[3].data(), PAGE_SIZE));
+    EXPECT_EQ(2 * PAGE_SIZE, file_size("test.db"));
+    dm.ShutDown();
+  }
+
+  // Scenario: the tablespaces and their pages survive a restart.
+  {
+    DiskManager dm(db_file);
+    EXPECT_TRUE(dm.HasTablespace(1));
+    EXPECT_TRUE(dm.IsAllocated(first_ts1 + 1));
+    EXPECT_FALSE(dm.IsAllocated(first_ts1 + 2));
+    dm.ReadPage(first_ts1, buf);
+    EXPECT_EQ('b', buf[0]);
+    EXPECT_EQ(first_ts1 + 2, dm.AllocatePage(1, 0, 1));
+
+    // Scenario: the instances sharing a tablespace hand out ids congruent to their index, as in the db file.
+    EXPECT_EQ(first_ts2 + 1, dm.AllocatePage(2, 1, 2));
+    EXPECT_EQ(first_ts2 + 2, dm.AllocatePage(2, 0, 2));
+
+    // Scenario: dropping a tablespace deletes its file; the id is reused by the next tablespace, which starts empty.
+    dm.DropTablespace(1);
+    EXPECT_FALSE(dm.HasTablespace(1));
+    EXPECT_EQ(-1, file_size("test.ts1"));
+    EXPECT_FALSE(dm.IsAllocated(first_ts1));
+    dm.ReadPage(first_ts1, buf);
+    EXPECT_EQ(0, memcmp(buf, data, PAGE_SIZE));
+    EXPECT_THROW(dm.DropTablespace(1), Exception);
+    EXPECT_THROW(dm.DropTablespace(DEFAULT_TABLESPACE), Exception);
+    EXPECT_EQ(1, dm.CreateTablespace());
+    EXPECT_EQ(first_ts1, dm.AllocatePage(1, 0, 1));
+    dm.ShutDown();
+  }
+
+  // Scenario: a new db file starts without tablespaces, whatever stale files are next to it.
+  remove("test.db");
+  DiskManager dm(db_file);
+  EXPECT_FALSE(dm.HasTablespace(1));
+  EXPECT_EQ(-1, file_size("test.ts2"));
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, AllocateExtentTest) {
+  const page_id_t first_ts1 = 1 << TABLESPACE_PAGE_BITS;
+  auto file_size = [](const char *file_name) { return std::ifstream(file_name, std::ios::ate).tellg(); };
+  std::string db_file("test.db");
+  {
+    DiskManager dm(db_file);
+    EXPECT_EQ(0, dm.AllocatePage());
+
+    // Scenario: an extent starts at the next multiple of EXTENT_SIZE above every allocated page, and is allocated
+    // whole. The pages skipped to get there are free, and AllocatePage hands them out first.
+    EXPECT_EQ(EXTENT_SIZE, dm.AllocateExtent());
+    EXPECT_TRUE(dm.IsAllocated(2 * EXTENT_SIZE - 1));
+    EXPECT_FALSE(dm.IsAllocated(1));
+    EXPECT_FALSE(dm.IsAllocated(2 * EXTENT_SIZE));
+    EXPECT_EQ(1, dm.AllocatePage());
+    EXPECT_EQ(2 * EXTENT_SIZE, dm.AllocateExtent());
+
+    // Scenario: instances keep handing out ids congruent to their index, around the extents.
+    EXPECT_EQ(2, dm.AllocatePage(2, 0));
+    EXPECT_EQ(3, dm.AllocatePage(2, 1));
+    EXPECT_EQ(3 * EXTENT_SIZE, dm.AllocateExtent());
+    EXPECT_EQ(4, dm.AllocatePage(2, 0));
+    EXPECT_EQ(5, dm.AllocatePage(2, 1));
+
+    // Scenario: in another tablespace, the file grows by the whole extent at once.
+    EXPECT_EQ(1, dm.CreateTablespace());
+    EXPECT_EQ(first_ts1, dm.AllocateExtent(1));
+    EXPECT_EQ(EXTENT_SIZE * PAGE_SIZE, file_size("test.ts1"));
+    EXPECT_EQ(first_ts1 + EXTENT_SIZE, dm.AllocatePage(1, 0, 1));
+    EXPECT_THROW(dm.AllocateExtent(2), Exception);
+    dm.ShutDown();
+  }
+
+  // Scenario: the extents stay allocated across a restart.
+  DiskManager dm(db_file);
+  EXPECT_TRUE(dm.IsAllocated(4 * EXTENT_SIZE - 1));
+  EXPECT_EQ(4 * EXTENT_SIZE, dm.AllocateExtent());
+  EXPECT_EQ(first_ts1 + 2 * EXTENT_SIZE, dm.AllocateExtent(1));
+  dm.ShutDown();
+}
+
 // NOLINTNEXTLINE
 TEST_F(DiskManagerTest, ThrowBadFileTest) { EXPECT_THROW(DiskManager("dev/null\\/foo/bar/baz/test.db"), Exception); }
 
@@ -63,11 +63,13 @@ TEST(TupleTest, DISABLED_TableHeapTest) {
     // std::cout << i++ << std::endl;
     assert(table->MarkDelete(rid, transaction) == 1);
   }
+  // The pool may still be reading ahead, which it must be done with before the disk manager shuts down.
+  delete table;
+  delete buffer_pool_manager;
   disk_manager->ShutDown();
   remove("test.db");  // remove db file
   remove("test.log");
-  delete table;
-  delete buffer_pool_manager;
+  remove("test.fpm");
   delete disk_manager;
 }
 